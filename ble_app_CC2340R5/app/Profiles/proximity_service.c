@@ -11,6 +11,8 @@
 #include "icall_ble_api.h"
 #include "proximity.h"
 #include "proximity_service.h"
+#include "trace.h"
+#include "energy.h"
 #include <ti/bleapp/ble_app_util/inc/bleapputil_api.h>
 
 void ProximityProfile_callback(uint8_t paramID);
@@ -27,6 +29,11 @@ GATT_BT_UUID(proximityProfile_DetectionUUID, PROXIMITYPROFILE_DETECTION_UUID);
 GATT_BT_UUID(proximityProfile_RangeUUID, PROXIMITYPROFILE_RANGE_UUID);
 GATT_BT_UUID(proximityProfile_SensitivityUUID, PROXIMITYPROFILE_SENSITIVITY_UUID);
 GATT_BT_UUID(proximityProfile_TimeoutUUID, PROXIMITYPROFILE_TIMEOUT_UUID);
+GATT_BT_UUID(proximityProfile_DetectorUUID, PROXIMITYPROFILE_DETECTOR_UUID);
+GATT_BT_UUID(proximityProfile_ZonesUUID, PROXIMITYPROFILE_ZONES_UUID);
+GATT_BT_UUID(proximityProfile_MotionUUID, PROXIMITYPROFILE_MOTION_UUID);
+GATT_BT_UUID(proximityProfile_ConfigUUID, PROXIMITYPROFILE_CONFIG_UUID);
+GATT_BT_UUID(proximityProfile_DiagnosticsUUID, PROXIMITYPROFILE_DIAGNOSTICS_UUID);
 
 
 /*********************************************************************
@@ -34,6 +41,9 @@ GATT_BT_UUID(proximityProfile_TimeoutUUID, PROXIMITYPROFILE_TIMEOUT_UUID);
  */
 static ProximityProfile_CBs_t *proximityProfile_appCBs = NULL;
 
+// Number of connected centrals
+static uint8_t proximityProfile_Connections = 0;
+
 /*********************************************************************
  * Profile Attributes - variables
  */
@@ -46,20 +56,41 @@ static uint8_t proximityProfile_DetectionProps = GATT_PROP_NOTIFY | GATT_PROP_RE
 static uint8_t proximityProfile_RangeProps = GATT_PROP_READ | GATT_PROP_WRITE | GATT_PROP_WRITE_NO_RSP;
 static uint8_t proximityProfile_SensitivityProps = GATT_PROP_READ | GATT_PROP_WRITE | GATT_PROP_WRITE_NO_RSP;
 static uint8_t proximityProfile_TimeoutProps = GATT_PROP_READ | GATT_PROP_WRITE | GATT_PROP_WRITE_NO_RSP;
+static uint8_t proximityProfile_DetectorProps = GATT_PROP_READ | GATT_PROP_WRITE | GATT_PROP_WRITE_NO_RSP;
+static uint8_t proximityProfile_ZonesProps = GATT_PROP_NOTIFY | GATT_PROP_READ | GATT_PROP_WRITE;
+static uint8_t proximityProfile_MotionProps = GATT_PROP_NOTIFY | GATT_PROP_READ | GATT_PROP_WRITE;
+static uint8_t proximityProfile_ConfigProps = GATT_PROP_READ | GATT_PROP_WRITE;
+static uint8_t proximityProfile_DiagnosticsProps = GATT_PROP_READ | GATT_PROP_WRITE;
 
 static gattCharCfg_t *proximityProfile_DetectionConfig;
+static gattCharCfg_t *proximityProfile_ZonesConfig;
+static gattCharCfg_t *proximityProfile_MotionConfig;
 
 // Characteristic Values
 static uint8_t proximityProfile_Detection = 0;
 static uint16_t proximityProfile_Range = 0;
 static uint8_t proximityProfile_Sensitivity = 0;
 static uint16_t proximityProfile_Timeout = 0;
+static proximityProfile_Detector_t proximityProfile_Detector;
+static uint8_t proximityProfile_Zones = 0;
+static uint8_t proximityProfile_Motion[MOTION_VALUE_SIZE];
+// Written value until the application applied it
+static proximityProfile_Config_t proximityProfile_Config;
+// Value of the last read at offset 0, served to the rest of a long read
+static proximityProfile_Config_t proximityProfile_ConfigRead;
+// Statistics of the last read at offset 0, served to the rest of a long read
+static proximityProfile_Diagnostics_t proximityProfile_DiagnosticsRead;
 
 // Characteristic User Descriptions
 static uint8_t proximityProfile_DetectionUserDesp[] = "Detection";
 static uint8_t proximityProfile_RangeUserDesp[] = "Range";
 static uint8_t proximityProfile_SensitivityUserDesp[] = "Sensitivity";
 static uint8_t proximityProfile_TimeoutUserDesp[] = "Timeout";
+static uint8_t proximityProfile_DetectorUserDesp[] = "Detector";
+static uint8_t proximityProfile_ZonesUserDesp[] = "Zones";
+static uint8_t proximityProfile_MotionUserDesp[] = "Motion";
+static uint8_t proximityProfile_ConfigUserDesp[] = "Config";
+static uint8_t proximityProfile_DiagnosticsUserDesp[] = "Diagnostics";
 
 /*********************************************************************
  * Profile Attributes - Table
@@ -97,6 +128,43 @@ static gattAttribute_t proximityProfile_attrTbl[] =
     GATT_BT_ATT(proximityProfile_TimeoutUUID, GATT_PERMIT_READ | GATT_PERMIT_WRITE , (uint8_t *)&proximityProfile_Timeout),
     // Timeout Characteristic User Description
     GATT_BT_ATT(charUserDescUUID, GATT_PERMIT_READ, proximityProfile_TimeoutUserDesp),
+
+    // Detector Characteristic Declaration
+    GATT_BT_ATT(characterUUID, GATT_PERMIT_READ, &proximityProfile_DetectorProps),
+    // Detector Characteristic Value
+    GATT_BT_ATT(proximityProfile_DetectorUUID, GATT_PERMIT_READ | GATT_PERMIT_WRITE , proximityProfile_Detector.value),
+    // Detector Characteristic User Description
+    GATT_BT_ATT(charUserDescUUID, GATT_PERMIT_READ, proximityProfile_DetectorUserDesp),
+
+    // Zones Characteristic Declaration
+    GATT_BT_ATT(characterUUID, GATT_PERMIT_READ, &proximityProfile_ZonesProps),
+    // Zones Characteristic Value
+    GATT_BT_ATT(proximityProfile_ZonesUUID, GATT_PERMIT_READ | GATT_PERMIT_WRITE, &proximityProfile_Zones),
+    GATT_BT_ATT( clientCharCfgUUID,            GATT_PERMIT_READ | GATT_PERMIT_WRITE,  (uint8_t *) &proximityProfile_ZonesConfig ),
+    // Zones Characteristic User Description
+    GATT_BT_ATT(charUserDescUUID, GATT_PERMIT_READ, proximityProfile_ZonesUserDesp),
+
+    // Motion Characteristic Declaration
+    GATT_BT_ATT(characterUUID, GATT_PERMIT_READ, &proximityProfile_MotionProps),
+    // Motion Characteristic Value
+    GATT_BT_ATT(proximityProfile_MotionUUID, GATT_PERMIT_READ | GATT_PERMIT_WRITE, proximityProfile_Motion),
+    GATT_BT_ATT( clientCharCfgUUID,            GATT_PERMIT_READ | GATT_PERMIT_WRITE,  (uint8_t *) &proximityProfile_MotionConfig ),
+    // Motion Characteristic User Description
+    GATT_BT_ATT(charUserDescUUID, GATT_PERMIT_READ, proximityProfile_MotionUserDesp),
+
+    // Config Characteristic Declaration
+    GATT_BT_ATT(characterUUID, GATT_PERMIT_READ, &proximityProfile_ConfigProps),
+    // Config Characteristic Value
+    GATT_BT_ATT(proximityProfile_ConfigUUID, GATT_PERMIT_READ | GATT_PERMIT_WRITE , proximityProfile_Config.value),
+    // Config Characteristic User Description
+    GATT_BT_ATT(charUserDescUUID, GATT_PERMIT_READ, proximityProfile_ConfigUserDesp),
+
+    // Diagnostics Characteristic Declaration
+    GATT_BT_ATT(characterUUID, GATT_PERMIT_READ, &proximityProfile_DiagnosticsProps),
+    // Diagnostics Characteristic Value
+    GATT_BT_ATT(proximityProfile_DiagnosticsUUID, GATT_PERMIT_READ | GATT_PERMIT_WRITE, proximityProfile_DiagnosticsRead.value),
+    // Diagnostics Characteristic User Description
+    GATT_BT_ATT(charUserDescUUID, GATT_PERMIT_READ, proximityProfile_DiagnosticsUserDesp),
 };
 
 /*********************************************************************
@@ -143,6 +211,12 @@ bStatus_t ProximityProfile_addService(void)
                                                                    MAX_NUM_BLE_CONNS );
     // Initialize Client Characteristic Configuration attributes
       GATTServApp_InitCharCfg( LINKDB_CONNHANDLE_INVALID, proximityProfile_DetectionConfig );
+    proximityProfile_ZonesConfig = (gattCharCfg_t *)ICall_malloc( sizeof( gattCharCfg_t ) *
+                                                               MAX_NUM_BLE_CONNS );
+      GATTServApp_InitCharCfg( LINKDB_CONNHANDLE_INVALID, proximityProfile_ZonesConfig );
+    proximityProfile_MotionConfig = (gattCharCfg_t *)ICall_malloc( sizeof( gattCharCfg_t ) *
+                                                                MAX_NUM_BLE_CONNS );
+      GATTServApp_InitCharCfg( LINKDB_CONNHANDLE_INVALID, proximityProfile_MotionConfig );
 
     // Register GATT attribute list and CBs with GATT Server App
     status = GATTServApp_RegisterService(proximityProfile_attrTbl,
@@ -193,9 +267,14 @@ bStatus_t ProximityProfile_setParameter(uint8_t param, uint8_t len, void *value)
             {
                 proximityProfile_Detection = *((uint8_t *)value);
                 // See if Notification has been enabled
-                GATTServApp_ProcessCharCfg( proximityProfile_DetectionConfig, &proximityProfile_Detection, FALSE,
-                                            proximityProfile_attrTbl, GATT_NUM_ATTRS( proximityProfile_attrTbl ),
-                                            INVALID_TASK_ID, ProximityProfile_readAttrCB );
+                status = GATTServApp_ProcessCharCfg( proximityProfile_DetectionConfig, &proximityProfile_Detection, FALSE,
+                                                     proximityProfile_attrTbl, GATT_NUM_ATTRS( proximityProfile_attrTbl ),
+                                                     INVALID_TASK_ID, ProximityProfile_readAttrCB );
+                TRACE_RECORD(TRACE_NOTIFY, TRACE_CHAR_DETECTION, status);
+                if (status == SUCCESS)
+                {
+                    energy_add_notification();
+                }
             }
             else
             {
@@ -236,6 +315,58 @@ bStatus_t ProximityProfile_setParameter(uint8_t param, uint8_t len, void *value)
             }
             break;
 
+        case PROXIMITYPROFILE_DETECTOR:
+            if (len <= DETECTOR_VALUE_MAX_SIZE)
+            {
+                VOID memcpy(proximityProfile_Detector.value, value, len);
+                proximityProfile_Detector.len = len;
+            }
+            else
+            {
+                status = bleInvalidRange;
+            }
+            break;
+
+        case PROXIMITYPROFILE_ZONES:
+            if (len == sizeof(uint8_t))
+            {
+                proximityProfile_Zones = *((uint8_t *)value);
+                // See if Notification has been enabled
+                status = GATTServApp_ProcessCharCfg( proximityProfile_ZonesConfig, &proximityProfile_Zones, FALSE,
+                                                     proximityProfile_attrTbl, GATT_NUM_ATTRS( proximityProfile_attrTbl ),
+                                                     INVALID_TASK_ID, ProximityProfile_readAttrCB );
+                TRACE_RECORD(TRACE_NOTIFY, TRACE_CHAR_ZONES, status);
+                if (status == SUCCESS)
+                {
+                    energy_add_notification();
+                }
+            }
+            else
+            {
+                status = bleInvalidRange;
+            }
+            break;
+
+        case PROXIMITYPROFILE_MOTION:
+            if (len == MOTION_VALUE_SIZE)
+            {
+                VOID memcpy(proximityProfile_Motion, value, MOTION_VALUE_SIZE);
+                // See if Notification has been enabled
+                status = GATTServApp_ProcessCharCfg( proximityProfile_MotionConfig, proximityProfile_Motion, FALSE,
+                                                     proximityProfile_attrTbl, GATT_NUM_ATTRS( proximityProfile_attrTbl ),
+                                                     INVALID_TASK_ID, ProximityProfile_readAttrCB );
+                TRACE_RECORD(TRACE_NOTIFY, TRACE_CHAR_MOTION, status);
+                if (status == SUCCESS)
+                {
+                    energy_add_notification();
+                }
+            }
+            else
+            {
+                status = bleInvalidRange;
+            }
+            break;
+
         default:
             status = INVALIDPARAMETER;
             break;
@@ -274,6 +405,22 @@ bStatus_t ProximityProfile_getParameter(uint8_t param, void *value)
             *((uint16_t *)value) = proximityProfile_Timeout;
             break;
 
+        case PROXIMITYPROFILE_DETECTOR:
+            *((proximityProfile_Detector_t *)value) = proximityProfile_Detector;
+            break;
+
+        case PROXIMITYPROFILE_ZONES:
+            *((uint8_t *)value) = proximityProfile_Zones;
+            break;
+
+        case PROXIMITYPROFILE_MOTION:
+            VOID memcpy(value, proximityProfile_Motion, MOTION_VALUE_SIZE);
+            break;
+
+        case PROXIMITYPROFILE_CONFIG:
+            *((proximityProfile_Config_t *)value) = proximityProfile_Config;
+            break;
+
         default:
             status = INVALIDPARAMETER;
             break;
@@ -305,20 +452,23 @@ bStatus_t ProximityProfile_readAttrCB(uint16_t connHandle,
 {
     bStatus_t status = SUCCESS;
 
-    // Make sure it's not a blob operation (no attributes in the profile are long)
-    if (offset > 0)
-    {
-        return (ATT_ERR_ATTR_NOT_LONG);
-    }
-
     if (pAttr->type.len == ATT_BT_UUID_SIZE)
     {
         // 16-bit UUID
         uint16 uuid = BUILD_UINT16(pAttr->type.uuid[0], pAttr->type.uuid[1]);
+
+        // Make sure it's not a blob operation (only the detector, config and diagnostics attributes are long)
+        if (offset > 0 && uuid != PROXIMITYPROFILE_DETECTOR_UUID && uuid != PROXIMITYPROFILE_CONFIG_UUID &&
+            uuid != PROXIMITYPROFILE_DIAGNOSTICS_UUID)
+        {
+            return (ATT_ERR_ATTR_NOT_LONG);
+        }
+
         switch (uuid)
         {
             case PROXIMITYPROFILE_DETECTION_UUID:
             case PROXIMITYPROFILE_SENSITIVITY_UUID:
+            case PROXIMITYPROFILE_ZONES_UUID:
                 *pLen = 1;
                 pValue[0] = *pAttr->pValue;
                 break;
@@ -329,6 +479,62 @@ bStatus_t ProximityProfile_readAttrCB(uint16_t connHandle,
                 VOID memcpy(pValue, pAttr->pValue, sizeof(uint16_t));
                 break;
 
+            case PROXIMITYPROFILE_MOTION_UUID:
+                *pLen = MOTION_VALUE_SIZE;
+                VOID memcpy(pValue, pAttr->pValue, MOTION_VALUE_SIZE);
+                break;
+
+            case PROXIMITYPROFILE_DETECTOR_UUID:
+                if (offset > proximityProfile_Detector.len)
+                {
+                    *pLen = 0;
+                    status = ATT_ERR_INVALID_OFFSET;
+                }
+                else
+                {
+                    *pLen = MIN(maxLen, proximityProfile_Detector.len - offset);
+                    VOID memcpy(pValue, &proximityProfile_Detector.value[offset], *pLen);
+                }
+                break;
+
+            case PROXIMITYPROFILE_CONFIG_UUID:
+                // Read the current configuration, a long read continues on the same value
+                if (offset == 0)
+                {
+                    proximityProfile_ConfigRead.len = getConfigValue(proximityProfile_ConfigRead.value,
+                                                                     sizeof(proximityProfile_ConfigRead.value));
+                }
+                if (offset > proximityProfile_ConfigRead.len)
+                {
+                    *pLen = 0;
+                    status = ATT_ERR_INVALID_OFFSET;
+                }
+                else
+                {
+                    *pLen = MIN(maxLen, proximityProfile_ConfigRead.len - offset);
+                    VOID memcpy(pValue, &proximityProfile_ConfigRead.value[offset], *pLen);
+                }
+                break;
+
+            case PROXIMITYPROFILE_DIAGNOSTICS_UUID:
+                // Read the statistics of the last window, a long read continues on the same value
+                if (offset == 0)
+                {
+                    proximityProfile_DiagnosticsRead.len = instrumentation_get_value(proximityProfile_DiagnosticsRead.value,
+                                                                                     sizeof(proximityProfile_DiagnosticsRead.value));
+                }
+                if (offset > proximityProfile_DiagnosticsRead.len)
+                {
+                    *pLen = 0;
+                    status = ATT_ERR_INVALID_OFFSET;
+                }
+                else
+                {
+                    *pLen = MIN(maxLen, proximityProfile_DiagnosticsRead.len - offset);
+                    VOID memcpy(pValue, &proximityProfile_DiagnosticsRead.value[offset], *pLen);
+                }
+                break;
+
             default:
                 *pLen = 0;
                 status = ATT_ERR_ATTR_NOT_FOUND;
@@ -417,6 +623,88 @@ bStatus_t ProximityProfile_writeAttrCB(uint16_t connHandle,
                 }
                 break;
 
+            case PROXIMITYPROFILE_DETECTOR_UUID:
+                // Thresholds are written in chunks that fit into a single write, see setDetectorValue()
+                if (offset != 0)
+                {
+                    status = ATT_ERR_ATTR_NOT_LONG;
+                }
+                else if (len < DETECTOR_VALUE_HEADER_SIZE || len > DETECTOR_VALUE_MAX_SIZE)
+                {
+                    status = ATT_ERR_INVALID_VALUE_SIZE;
+                }
+                else
+                {
+                    VOID memcpy(proximityProfile_Detector.value, pValue, len);
+                    proximityProfile_Detector.len = len;
+                }
+                break;
+
+            case PROXIMITYPROFILE_CONFIG_UUID:
+                // The whole configuration is written at once, see setConfigValue()
+                if (offset != 0)
+                {
+                    status = ATT_ERR_ATTR_NOT_LONG;
+                }
+                else if (len < CONFIG_VALUE_V1_HEADER_SIZE || len > CONFIG_VALUE_MAX_SIZE)
+                {
+                    status = ATT_ERR_INVALID_VALUE_SIZE;
+                }
+                else
+                {
+                    VOID memcpy(proximityProfile_Config.value, pValue, len);
+                    proximityProfile_Config.len = len;
+                }
+                break;
+
+            case PROXIMITYPROFILE_ZONES_UUID:
+                // Sets the zones, the value keeps reading the occupied zones, see setZonesValue()
+                if (offset != 0)
+                {
+                    status = ATT_ERR_ATTR_NOT_LONG;
+                }
+                else if (len > ZONES_VALUE_MAX_SIZE)
+                {
+                    status = ATT_ERR_INVALID_VALUE_SIZE;
+                }
+                else if (!setZonesValue(pValue, len))
+                {
+                    status = ATT_ERR_INVALID_VALUE;
+                }
+                break;
+
+            case PROXIMITYPROFILE_MOTION_UUID:
+                // Enables or disables the tracking, the value keeps reading the target, see setMotionValue()
+                if (offset != 0)
+                {
+                    status = ATT_ERR_ATTR_NOT_LONG;
+                }
+                else if (len != 1)
+                {
+                    status = ATT_ERR_INVALID_VALUE_SIZE;
+                }
+                else if (!setMotionValue(pValue, len))
+                {
+                    status = ATT_ERR_INVALID_VALUE;
+                }
+                break;
+
+            case PROXIMITYPROFILE_DIAGNOSTICS_UUID:
+                // The only command is the dump of the event trace
+                if (offset != 0)
+                {
+                    status = ATT_ERR_ATTR_NOT_LONG;
+                }
+                else if (len != 1 || pValue[0] != TRACE_DUMP_COMMAND)
+                {
+                    status = ATT_ERR_INVALID_VALUE;
+                }
+                else
+                {
+                    dumpTrace();
+                }
+                break;
+
             case GATT_CLIENT_CHAR_CFG_UUID:
                 status = GATTServApp_ProcessCCCWriteReq( connHandle, pAttr, pValue, len,
                                                          offset, GATT_CLIENT_CFG_NOTIFY );
@@ -437,6 +725,18 @@ bStatus_t ProximityProfile_writeAttrCB(uint16_t connHandle,
                     case PROXIMITYPROFILE_TIMEOUT_UUID:
                         notifyApp = PROXIMITYPROFILE_TIMEOUT;
                         break;
+                    case PROXIMITYPROFILE_DETECTOR_UUID:
+                        if (status == SUCCESS)
+                        {
+                            notifyApp = PROXIMITYPROFILE_DETECTOR;
+                        }
+                        break;
+                    case PROXIMITYPROFILE_CONFIG_UUID:
+                        if (status == SUCCESS)
+                        {
+                            notifyApp = PROXIMITYPROFILE_CONFIG;
+                        }
+                        break;
                     case GATT_CLIENT_CHAR_CFG_UUID:
                         notifyApp = PROXIMITYPROFILE_DETECTION;
                         break;
@@ -464,23 +764,28 @@ bStatus_t ProximityProfile_writeAttrCB(uint16_t connHandle,
 /**
  * @brief Handler for the Connect event.
  *
- * This function handles the Connect event by starting the sensor.
+ * This function reports the connection to the proximity module, which applies the sensing
+ * policy. The detection characteristic already holds the current presence state.
  */
 void ProximityProfile_on_connect(void)
 {
-    startSensor();
+    proximityProfile_Connections++;
+    setConnectionState(true);
+    // The sensor is initialized in the background, so the detector value is only known now
+    proximityProfile_Detector.len = getDetectorValue(proximityProfile_Detector.value,
+                                                     sizeof(proximityProfile_Detector.value));
 }
 
 /**
  * @brief Handler for the Disconnect event.
  *
- * This function handles the Disconnect event by stopping the sensor if no active connections are present.
+ * This function reports to the proximity module when the last connection is terminated.
  */
 void ProximityProfile_on_disconnect(void)
 {
-    if(linkDB_NumActive() > 0)
+    if(proximityProfile_Connections > 0 && --proximityProfile_Connections == 0)
     {
-        stopSensor();
+        setConnectionState(false);
     }
 }
 
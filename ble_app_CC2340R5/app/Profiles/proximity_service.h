@@ -11,6 +11,8 @@ extern "C"
 /*********************************************************************
  * INCLUDES
  */
+#include "proximity.h"
+#include "instrumentation.h"
 
 /*********************************************************************
  * CONSTANTS
@@ -20,6 +22,10 @@ extern "C"
 #define PROXIMITYPROFILE_RANGE                       1  // RW uint16 - Profile Characteristic range value
 #define PROXIMITYPROFILE_SENSITIVITY                 2  // RW uint8 - Profile Characteristic sensitivity value
 #define PROXIMITYPROFILE_TIMEOUT                     3  // RW uint16 - Profile Characteristic timeout value
+#define PROXIMITYPROFILE_DETECTOR                    4  // RW proximityProfile_Detector_t - Profile Characteristic detector value
+#define PROXIMITYPROFILE_ZONES                       5  // R uint8 - Profile Characteristic occupied zones
+#define PROXIMITYPROFILE_MOTION                      6  // R uint8[MOTION_VALUE_SIZE] - Profile Characteristic tracked target motion
+#define PROXIMITYPROFILE_CONFIG                      7  // RW proximityProfile_Config_t - Profile Characteristic combined configuration
 
 // Simple Profile Service UUID
 #define PROXIMITYPROFILE_SERV_UUID               0x20F1
@@ -29,8 +35,34 @@ extern "C"
 #define PROXIMITYPROFILE_RANGE_UUID                0x2BB1
 #define PROXIMITYPROFILE_SENSITIVITY_UUID          0x2BB2
 #define PROXIMITYPROFILE_TIMEOUT_UUID              0x2BB3
+#define PROXIMITYPROFILE_DETECTOR_UUID             0x2BB4
+#define PROXIMITYPROFILE_ZONES_UUID                0x2BB5
+#define PROXIMITYPROFILE_MOTION_UUID               0x2BB6
+#define PROXIMITYPROFILE_CONFIG_UUID               0x2BB7
+#define PROXIMITYPROFILE_DIAGNOSTICS_UUID          0x2BB8
 
 
+// Variable length value of the detector characteristic
+typedef struct
+{
+  uint16_t len;
+  uint8_t  value[DETECTOR_VALUE_MAX_SIZE];
+} proximityProfile_Detector_t;
+
+// Variable length value of the config characteristic
+typedef struct
+{
+  uint16_t len;
+  uint8_t  value[CONFIG_VALUE_MAX_SIZE];
+} proximityProfile_Config_t;
+
+// Variable length value of the diagnostics characteristic
+typedef struct
+{
+  uint16_t len;
+  uint8_t  value[DIAGNOSTICS_VALUE_MAX_SIZE];
+} proximityProfile_Diagnostics_t;
+
 /*********************************************************************
  * Profile Callbacks
  */
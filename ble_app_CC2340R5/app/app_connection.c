@@ -26,6 +26,7 @@ $Release Date: PACKAGE RELEASE DATE $
 #include <ti/bleapp/ble_app_util/inc/bleapputil_api.h>
 #include <app_main.h>
 #include <proximity_service.h>
+#include <energy.h>
 #include <ti/display/Display.h>
 
 //*****************************************************************************
@@ -97,6 +98,8 @@ void Connection_ConnEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
             /*! Print the number of current connections */
             Display_printf(handle, 0, 0, "Connections number: %d", linkDB_NumActive());
             ProximityProfile_on_connect();
+            // The connection interval is in units of 1.25 ms
+            energy_set_connection(true, gapEstMsg->connInterval * 1250);
 
             break;
         }
@@ -114,6 +117,7 @@ void Connection_ConnEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
             /*! Print the number of current connections */
             Display_printf(handle, 0, 0, "Connections number: %d", linkDB_NumActive());
             ProximityProfile_on_disconnect();
+            energy_set_connection(false, 0);
 
             break;
         }
@@ -148,6 +152,7 @@ void Connection_ConnEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
               if((pPkt->status == SUCCESS) || (pPkt->status == HCI_ERROR_CODE_PARAM_OUT_OF_MANDATORY_RANGE))
               {
                   Display_printf(handle, 0, 0, "Conn status: Params update - connectionHandle = %d", pPkt->connectionHandle);
+                  energy_set_connection(true, pPkt->connInterval * 1250);
               }
               else
               {
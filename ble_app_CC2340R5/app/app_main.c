@@ -21,6 +21,9 @@ $Release Date: PACKAGE RELEASE DATE $
 #include <ti/bleapp/ble_app_util/inc/bleapputil_api.h>
 #include <app_main.h>
 #include <ti/display/Display.h>
+#include "dlog.h"
+#include "instrumentation.h"
+#include "energy.h"
 
 //*****************************************************************************
 //! Defines
@@ -103,6 +106,12 @@ void App_StackInitDoneHandler(gapDeviceInitDoneEvent_t *deviceInitDoneData)
         /* Failed to open display driver */
         while (1) {}
     }
+    // Start draining the deferred log records to the display
+    dlog_init();
+    // Start the statistics windows of the instrumentation build
+    instrumentation_init();
+    // Start the estimate windows of the energy build
+    energy_init();
 
     Display_printf(handle, 0, 0, "********** Novelda Proximity example **********");
 
@@ -40,6 +40,7 @@ $Release Date: PACKAGE RELEASE DATE $
 #include "ti_ble_config.h"
 #include <ti/bleapp/ble_app_util/inc/bleapputil_api.h>
 #include <app_main.h>
+#include <boot.h>
 #include <ti/display/Display.h>
 
 
@@ -118,6 +119,7 @@ void Peripheral_AdvEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
         case BLEAPPUTIL_ADV_START_AFTER_ENABLE:
         {
             Display_printf(handle, 0, 0, "Adv status: Started - handle: %d", ((BLEAppUtil_AdvEventData_t *)pMsgData)->pBuf->advHandle);
+            boot_mark(BOOT_ADVERTISING);
             break;
         }
 
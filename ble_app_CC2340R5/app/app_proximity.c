@@ -17,9 +17,11 @@
 #include "task.h"
 #include "timers.h"
 #include "semphr.h"
+#include "queue.h"
 #include "proximity.h"
+#include "settings.h"
 #include "proximity_service.h"
-#include <ti/display/Display.h>
+#include "dlog.h"
 
 
 //*****************************************************************************
@@ -29,10 +31,14 @@
 static void Proximity_changeCB( uint8_t paramId );
 extern void sensor_run_thread(void * pvParameter);
 void Proximity_on_proximity_evt(uint8_t proximity);
+void Proximity_on_zones_evt(uint8_t zones);
+void Proximity_on_motion_evt(const uint8_t *motion, uint16_t len);
+void Proximity_on_detector_evt(void);
+void Proximity_on_config_evt(void);
 static void detection_task(void * pvParameter);
 static TaskHandle_t m_proximity_task;
 static TaskHandle_t m_sensor_task;
-SemaphoreHandle_t appSemHandle;
+QueueHandle_t appQueueHandle;
 
 // Simple GATT Profile Callbacks
 static ProximityProfile_CBs_t proximity_profileCBs =
@@ -44,11 +50,65 @@ static ProximityProfile_CBs_t proximity_profileCBs =
 //! Functions
 //*****************************************************************************
 
+/*********************************************************************
+ * @fn      Proximity_detectorChanged
+ *
+ * @brief   Queues a written detector characteristic value for the
+ *          running sensor and updates the characteristic with the
+ *          requested configuration. It is refreshed again once the
+ *          sensor task applied the values.
+ *
+ * @return  None.
+ */
+static void Proximity_detectorChanged( void )
+{
+  proximityProfile_Detector_t detector;
+  ProximityProfile_getParameter(PROXIMITYPROFILE_DETECTOR, &detector);
+
+  if(setDetectorValue(detector.value, detector.len))
+  {
+      DLOG("Detector update queued, M/N %d/%d %d/%d", detector.value[0], detector.value[1], detector.value[2], detector.value[3]);
+  }
+  else
+  {
+      DLOG("Detector value rejected. Expected M0 N0 M1 N1 first_bin thresholds[], with 1 <= M <= N");
+  }
+  detector.len = getDetectorValue(detector.value, sizeof(detector.value));
+  ProximityProfile_setParameter( PROXIMITYPROFILE_DETECTOR, detector.len, detector.value );
+}
+
+/*********************************************************************
+ * @fn      Proximity_configChanged
+ *
+ * @brief   Applies a written config characteristic value. All
+ *          parameters take effect together, an invalid value changes
+ *          nothing.
+ *
+ * @return  None.
+ */
+static void Proximity_configChanged( void )
+{
+  proximityProfile_Config_t config;
+  ProximityProfile_getParameter(PROXIMITYPROFILE_CONFIG, &config);
+
+  if(setConfigValue(config.value, config.len))
+  {
+      DLOG("Config committed. Range: %d cm, sensitivity level: %d, timeout: %d ms",
+           config.value[2] | (config.value[3] << 8), config.value[1], config.value[4] | (config.value[5] << 8));
+  }
+  else
+  {
+      DLOG("Config value rejected. Expected version %d, sensitivity, range, timeout, M0 N0 M1 N1, count, policy, thresholds[]",
+           CONFIG_VALUE_VERSION);
+  }
+}
+
 /*********************************************************************
  * @fn      Proximity_ChangeCB
  *
  * @brief   Callback from Simple Profile indicating a characteristic
- *          value change.
+ *          value change. Range, sensitivity and timeout writes are
+ *          collected and applied together, see configureRange().
  *
  * @param   paramId - parameter Id of the value that was changed.
  *
@@ -57,23 +117,30 @@ static ProximityProfile_CBs_t proximity_profileCBs =
 static void Proximity_changeCB( uint8_t paramId )
 {
   uint16_t newValue = 0;
+  if( paramId == PROXIMITYPROFILE_DETECTOR )
+  {
+    Proximity_detectorChanged();
+    return;
+  }
+  if( paramId == PROXIMITYPROFILE_CONFIG )
+  {
+    Proximity_configChanged();
+    return;
+  }
   ProximityProfile_getParameter(paramId, &newValue);
 
   switch( paramId )
   {
     case PROXIMITYPROFILE_RANGE:
       {
-        if(newValue >= MIN_RANGE_VALUE && newValue <= MAX_RANGE_VALUE)
+        if(configureRange(newValue))
         {
-            Display_printf(handle, 0, 0, "Range value = %d", newValue);
-            stopSensor();
-            setRange(newValue);
-            startSensor();
+            DLOG("Range value = %d", newValue);
         }
         else
         {
             uint16_t charRange = getRange();
-            Display_printf(handle, 0, 0, "New Range value %d is out of rage.Allowed value range[%d, %d]", newValue, MIN_RANGE_VALUE, MAX_RANGE_VALUE);
+            DLOG("New Range value %d is out of rage.Allowed value range[%d, %d]", newValue, MIN_RANGE_VALUE, MAX_RANGE_VALUE);
             ProximityProfile_setParameter( PROXIMITYPROFILE_RANGE, sizeof(uint16_t),
                                                 &charRange );
         }
@@ -82,17 +149,19 @@ static void Proximity_changeCB( uint8_t paramId )
 
     case PROXIMITYPROFILE_SENSITIVITY:
       {
-          if(newValue >= MIN_SENSITIVITY_VALUE && newValue <= MAX_SENSITIVITY_VALUE)
+          if(configureSensitivity(newValue))
           {
-              Display_printf(handle, 0, 0, "Sensitivity value = %d", newValue);
-            stopSensor();
-            setSensitivity(newValue);
-            startSensor();
+              DLOG("Sensitivity value = %d", newValue);
+          }
+          else if(newValue == CALIBRATION_SENSITIVITY_VALUE)
+          {
+              DLOG("Calibrating detector, keep the sensor range empty for %d seconds", CALIBRATION_TIME_SECONDS);
+            calibrateSensor();
           }
           else
           {
               uint8_t charSensitivity = getSensitivity();
-              Display_printf(handle, 0, 0, "New Sensitivity value %d is out of rage.Allowed value range[%d, %d]", newValue, MIN_SENSITIVITY_VALUE, MAX_SENSITIVITY_VALUE);
+              DLOG("New Sensitivity value %d is out of rage.Allowed value range[%d, %d]", newValue, MIN_SENSITIVITY_VALUE, MAX_SENSITIVITY_VALUE);
               ProximityProfile_setParameter( PROXIMITYPROFILE_SENSITIVITY, sizeof(uint8_t),
                                                   &charSensitivity );
           }
@@ -100,8 +169,17 @@ static void Proximity_changeCB( uint8_t paramId )
       break;
     case PROXIMITYPROFILE_TIMEOUT:
       {
-          Display_printf(handle, 0, 0, "Timeout value = %d", newValue);
-        setPresenceTimeout(newValue);
+          if(configureTimeout(newValue))
+          {
+              DLOG("Timeout value = %d", newValue);
+          }
+          else
+          {
+              uint16_t charTimeout = getTimeout();
+              DLOG("New Timeout value %d is out of range. Allowed minimum %d", newValue, MIN_TIMEOUT_VALUE);
+              ProximityProfile_setParameter( PROXIMITYPROFILE_TIMEOUT, sizeof(uint16_t),
+                                                  &charTimeout );
+          }
           break;
       }
     default:
@@ -134,10 +212,18 @@ bStatus_t Proximity_start( void )
     return(status);
   }
 
+  // Restores the saved settings, so the characteristics start with them
+  settings_init();
+  appQueueHandle = xQueueCreate(PROXIMITY_EVENT_QUEUE_LENGTH, sizeof(proximityEvent_t));
+  proximityInit(appQueueHandle, Proximity_on_proximity_evt);
+
     uint8_t charProximity = 0;
     uint16_t charRange = getRange();
     uint8_t charSensitivity = getSensitivity();
     uint16_t charTimeout = getTimeout();
+    uint8_t charZones = getZoneValue();
+    uint8_t charMotion[MOTION_VALUE_SIZE];
+    uint16_t charMotionLen = getMotionValue(charMotion, sizeof(charMotion));
 
     ProximityProfile_setParameter( PROXIMITYPROFILE_DETECTION, sizeof(uint8_t),
                                     &charProximity );
@@ -147,10 +233,16 @@ bStatus_t Proximity_start( void )
                                     &charSensitivity );
     ProximityProfile_setParameter( PROXIMITYPROFILE_TIMEOUT, sizeof(uint16_t),
                                     &charTimeout );
+    ProximityProfile_setParameter( PROXIMITYPROFILE_ZONES, sizeof(uint8_t),
+                                    &charZones );
+    ProximityProfile_setParameter( PROXIMITYPROFILE_MOTION, charMotionLen,
+                                    charMotion );
   // Register callback with SimpleGATTprofile
   status = ProximityProfile_registerAppCBs( &proximity_profileCBs );
-  appSemHandle = xSemaphoreCreateBinary();
-  proximityInit(appSemHandle, Proximity_on_proximity_evt);
+  setZoneCallback(Proximity_on_zones_evt);
+  setMotionCallback(Proximity_on_motion_evt);
+  setDetectorCallback(Proximity_on_detector_evt);
+  setConfigCallback(Proximity_on_config_evt);
 
   if (pdPASS != xTaskCreate(detection_task, "DET", 256, NULL, 1, &m_proximity_task))
   {
@@ -186,12 +278,14 @@ static ICall_SyncHandle syncEvent;
  */
 static void detection_task(void * pvParameter)
 {
+    proximityEvent_t event;
+
     ICall_registerApp(&selfEntity, &syncEvent);
     for(;;)
     {
-        if(pdTRUE == xSemaphoreTake(appSemHandle, portMAX_DELAY))
+        if(pdTRUE == xQueueReceive(appQueueHandle, &event, portMAX_DELAY))
         {
-            processSensorEvent();
+            processSensorEvent(&event);
         }
 
     }
@@ -210,10 +304,63 @@ void Proximity_on_proximity_evt(uint8_t detection)
     if(last_detection != detection)
     {
         ProximityProfile_setParameter(PROXIMITYPROFILE_DETECTION, sizeof(uint8_t), &detection);
-        Display_printf(handle, 0, 0, "Detection value = %d", detection);
+        DLOG("Detection value = %d", detection);
         last_detection = detection;
         GPIO_write(CONFIG_GPIO_LEDG, detection);
 
     }
 }
 
+/**
+ * @brief Event handler for BLE proximity service on zones event.
+ *
+ * @param zones Bitfield of the occupied zones.
+ */
+void Proximity_on_zones_evt(uint8_t zones)
+{
+    ProximityProfile_setParameter(PROXIMITYPROFILE_ZONES, sizeof(uint8_t), &zones);
+    DLOG("Zones value = 0x%02X", zones);
+}
+
+/**
+ * @brief Event handler for BLE proximity service on motion event.
+ *
+ * @param motion Motion value, see getMotionValue().
+ * @param len    Length of the value.
+ */
+void Proximity_on_motion_evt(const uint8_t *motion, uint16_t len)
+{
+    ProximityProfile_setParameter(PROXIMITYPROFILE_MOTION, len, (void *)motion);
+    DLOG("Motion direction = %d", motion[0]);
+}
+
+/**
+ * @brief Event handler for BLE proximity service on detector event.
+ *
+ * Refreshes the detector characteristic after the sensor task changed the detector
+ * configuration.
+ */
+void Proximity_on_detector_evt(void)
+{
+    proximityProfile_Detector_t detector;
+
+    detector.len = getDetectorValue(detector.value, sizeof(detector.value));
+    ProximityProfile_setParameter(PROXIMITYPROFILE_DETECTOR, detector.len, detector.value);
+}
+
+/**
+ * @brief Event handler for BLE proximity service on config event.
+ *
+ * Refreshes the range, sensitivity and timeout characteristics after a configuration was
+ * applied, which may have been written through the config characteristic.
+ */
+void Proximity_on_config_evt(void)
+{
+    uint16_t charRange = getRange();
+    uint8_t charSensitivity = getSensitivity();
+    uint16_t charTimeout = getTimeout();
+
+    ProximityProfile_setParameter(PROXIMITYPROFILE_RANGE, sizeof(uint16_t), &charRange);
+    ProximityProfile_setParameter(PROXIMITYPROFILE_SENSITIVITY, sizeof(uint8_t), &charSensitivity);
+    ProximityProfile_setParameter(PROXIMITYPROFILE_TIMEOUT, sizeof(uint16_t), &charTimeout);
+}
@@ -0,0 +1,15 @@
+/**
+ * @file board_port.h
+ * @brief CC2340R5 port of the portable core, see port.h.
+ */
+
+#ifndef BOARD_PORT_H_
+#define BOARD_PORT_H_
+#include "dlog.h"
+
+#define PORT_LOG_INFO(...)      DLOG(__VA_ARGS__)
+#define PORT_ASSERT_FAILED()    while(1)
+/* The core only uses FreeRTOS software timers */
+#define PORT_INIT_TIMERS()
+
+#endif /* BOARD_PORT_H_ */
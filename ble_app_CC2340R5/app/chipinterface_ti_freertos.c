@@ -30,9 +30,12 @@
 #include <task.h>
 /* Driver configuration */
 #include "ti_drivers_config.h"
+#include "trace.h"
+#include "port.h"
 
 #define CI_EVENTS_IRQ  0x01
 #define CI_EVENTS_DISSABLE 0x02
+#define CI_EVENTS_WAKE 0x04
 
 #define X4_IRQ_0 CONFIG_GPIO_X4_IRQ_0
 #define X4_IRQ_1 0
@@ -53,6 +56,13 @@ struct chipinterface_context_t *context_list[SENSORS_SUPPORTED];
 SemaphoreHandle_t irqSem = NULL;
 static uint8_t gEvents;
 bool gStarted = false;
+/* A chipinterface_wait_for_interrupt_or_wake() is pending and not woken yet */
+static bool gWakeable;
+
+/* SPI runs in callback mode so that bulk reads can complete in the background */
+static SemaphoreHandle_t spiSem = NULL;
+static SPI_Transaction gSpiTransaction;
+static volatile bool gSpiTransferOk;
 
 /**
  * @brief GPIO callback for sensor IRQ.
@@ -76,6 +86,8 @@ static void gpio_irq_callback(uint_least8_t index)
     {
     case X4_IRQ_0:
         gEvents |= CI_EVENTS_IRQ;
+        TRACE_RECORD(TRACE_IRQ, 1, 0);
+        TRACE_RECORD(TRACE_SEM_GIVE, TRACE_SEM_IRQ, 0);
         xSemaphoreGive(irqSem);
        break;
        /* Insert other case statements here to support
@@ -89,6 +101,73 @@ static void gpio_irq_callback(uint_least8_t index)
     }
 }
 
+/**
+ * @brief SPI transfer completion callback.
+ *
+ * Called by the SPI driver when a transfer has completed. It records the
+ * transfer status and gives the SPI semaphore to wake the waiting task.
+ *
+ * @param[in] handle       SPI handle.
+ * @param[in] transaction  Completed transaction.
+ */
+static void spi_transfer_callback(SPI_Handle handle, SPI_Transaction *transaction)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    (void)handle;
+    gSpiTransferOk = (transaction->status == SPI_TRANSFER_COMPLETED);
+    TRACE_RECORD(TRACE_SEM_GIVE, TRACE_SEM_SPI, 0);
+    xSemaphoreGiveFromISR(spiSem, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief Start a single SPI transfer.
+ *
+ * @param[in] txBuf  Data to write or NULL.
+ * @param[out] rxBuf Buffer for the read data or NULL.
+ * @param[in] count  Number of bytes to transfer.
+ * @return true if the transfer has been started, false otherwise.
+ */
+static bool spi_transfer_start(const uint8_t *txBuf, uint8_t *rxBuf, size_t count)
+{
+    SPI_Handle *spi_handle = (SPI_Handle*)context_list[0]->iface_handle;
+
+    gSpiTransaction.count = count;
+    gSpiTransaction.txBuf = (void *) txBuf;
+    gSpiTransaction.rxBuf = (void *) rxBuf;
+    return SPI_transfer(*spi_handle, &gSpiTransaction);
+}
+
+/**
+ * @brief Wait for the SPI transfer started last.
+ *
+ * A transfer that does not complete in time is cancelled, so the DMA no longer writes the
+ * buffers once they are handed back to the caller.
+ *
+ * @param[in] wait Time to wait in ticks.
+ * @return CHIPINTERFACE_SUCCESS if the transfer completed, CHIPINTERFACE_TIMEOUT if it was
+ *         cancelled or CHIPINTERFACE_FAILURE if it failed.
+ */
+static chipinterface_error_t spi_transfer_wait(TickType_t wait)
+{
+    BaseType_t taken = xSemaphoreTake(spiSem, wait);
+
+    TRACE_RECORD(TRACE_SEM_TAKE, TRACE_SEM_SPI, taken == pdTRUE);
+    if(taken != pdTRUE)
+    {
+        SPI_Handle *spi_handle = (SPI_Handle*)context_list[0]->iface_handle;
+
+        // The callback runs for the cancelled transfer too, or already ran if it completed
+        // meanwhile. Take its give here so it does not end the wait of the next transfer.
+        SPI_transferCancel(*spi_handle);
+        xSemaphoreTake(spiSem, portMAX_DELAY);
+        TRACE_RECORD(TRACE_SEM_TAKE, TRACE_SEM_SPI, 1);
+        return CHIPINTERFACE_TIMEOUT;
+    }
+    return gSpiTransferOk ? CHIPINTERFACE_SUCCESS : CHIPINTERFACE_FAILURE;
+}
+
 /**
  * @brief Initialize the radar enable GPIO pin.
  *
@@ -191,8 +270,12 @@ chipinterface_error_t chipinterface_create_spi(uint32_t frequencyHz, const chipi
     {
         irqSem = xSemaphoreCreateBinary();
     }
+    if(!spiSem)
+    {
+        spiSem = xSemaphoreCreateBinary();
+    }
     //modify code with hardcoded index 0 if there is a need to support more than one sensor
-    if(context_list[context_idx] != NULL)
+    if(context_list[context_idx] == NULL)
     {
         context_list[context_idx] = malloc(sizeof(struct chipinterface_context_t));
 
@@ -201,6 +284,8 @@ chipinterface_error_t chipinterface_create_spi(uint32_t frequencyHz, const chipi
         SPI_Handle *spi_handle = malloc(sizeof(SPI_Handle));
         SPI_Params_init(&params);
         params.bitRate = frequencyHz;
+        params.transferMode = SPI_MODE_CALLBACK;
+        params.transferCallbackFxn = spi_transfer_callback;
 
         // Open SPI bus for usage
         *spi_handle = SPI_open(0, &params);
@@ -277,6 +362,7 @@ chipinterface_error_t chipinterface_set_chip_enabled(bool enabled)
     {
         gEvents |= CI_EVENTS_DISSABLE;
         gStarted = false;
+        TRACE_RECORD(TRACE_SEM_GIVE, TRACE_SEM_IRQ, 0);
         xSemaphoreGive(irqSem);
     }
 
@@ -305,20 +391,35 @@ chipinterface_error_t chipinterface_wait_us(uint32_t microseconds)
     return CHIPINTERFACE_SUCCESS;
 }
 
+/**
+ * @brief Get the time since the scheduler started in microseconds.
+ *
+ * The tick count is extended with its overflows by the kernel, so the time does not wrap.
+ * Called from task context.
+ *
+ * @return Time in microseconds.
+ */
+uint64_t chipinterface_get_time_microseconds_64(void)
+{
+    TimeOut_t now;
+
+    vTaskSetTimeOutState(&now);
+    return ((((uint64_t)now.xOverflowCount << 32) | now.xTimeOnEntering) * 1000000) / configTICK_RATE_HZ;
+}
+
 /**
  * @brief Get the current time in microseconds.
  *
- * This function retrieves the current time in microseconds since system startup.
+ * This function retrieves the current time in microseconds since system startup. It is the low
+ * 32 bits of chipinterface_get_time_microseconds_64(), so it wraps only after 2^32 us and the
+ * difference of two values is exact for intervals of up to 71 minutes.
  *
  * @param[out] microseconds Pointer to the variable to store the time in microseconds.
  * @return CHIPINTERFACE_SUCCESS if successful, or CHIPINTERFACE_FAILURE if an error occurs.
  */
 chipinterface_error_t chipinterface_get_time_microseconds(uint32_t *microseconds)
 {
-    TickType_t tickCount = xTaskGetTickCount();
-    TickType_t tickRate = configTICK_RATE_HZ;
-
-    *microseconds = ((uint32_t)tickCount * 1000000) / (uint32_t)tickRate;
+    *microseconds = (uint32_t)chipinterface_get_time_microseconds_64();
 	return CHIPINTERFACE_SUCCESS;
 }
 
@@ -396,33 +497,76 @@ chipinterface_error_t chipinterface_write_i2c(const uint8_t* data, size_t size)
  */
 chipinterface_error_t chipinterface_transfer_spi(const uint8_t *wdata, size_t wlength, uint8_t *rdata, size_t rlength)
 {
-    SPI_Handle *spi_handle = (SPI_Handle*)context_list[0]->iface_handle;
-    SPI_Transaction transaction;
-    bool transfer_ok = false;
+    chipinterface_error_t status;
+
+    status = chipinterface_transfer_spi_async(wdata, wlength, rdata, rlength);
+    if((status == CHIPINTERFACE_SUCCESS) && rlength)
+    {
+        status = spi_transfer_wait(portMAX_DELAY);
+    }
+    return status;
+}
 
+/**
+ * @brief Start a SPI data transfer in the background.
+ *
+ * The write phase is completed before returning, the read phase continues in the background
+ * until chipinterface_wait_transfer_spi() is called.
+ *
+ * @param[in] wdata       Pointer to the data buffer to write.
+ * @param[in] wlength     Number of bytes to write.
+ * @param[out] rdata      Pointer to the data buffer to store the received data.
+ * @param[in] rlength     Number of bytes to read.
+ * @return CHIPINTERFACE_SUCCESS if successful, or CHIPINTERFACE_FAILURE if an error occurs.
+ */
+chipinterface_error_t chipinterface_transfer_spi_async(const uint8_t *wdata, size_t wlength, uint8_t *rdata, size_t rlength)
+{
+    chipinterface_error_t status = CHIPINTERFACE_FAILURE;
 
     /* Set CS before transfer */
     GPIO_write(context_list[0]->gpio_cs, 1);
 
     if(wlength)
     {
-        transaction.count = wlength;
-        transaction.txBuf = (void *) wdata;
-        transaction.rxBuf = NULL;
-        /* Perform SPI transfer */
-        transfer_ok = SPI_transfer(*spi_handle, &transaction);
+        if(!spi_transfer_start(wdata, NULL, wlength))
+        {
+            return CHIPINTERFACE_FAILURE;
+        }
+        status = spi_transfer_wait(portMAX_DELAY);
+        if(status != CHIPINTERFACE_SUCCESS)
+        {
+            return status;
+        }
     }
     if(rlength)
     {
-        transaction.count = rlength;
-        transaction.txBuf = NULL;
-        transaction.rxBuf = (void *) rdata;
-        /* Perform SPI transfer */
-        transfer_ok = SPI_transfer(*spi_handle, &transaction);
+        status = spi_transfer_start(NULL, rdata, rlength) ? CHIPINTERFACE_SUCCESS : CHIPINTERFACE_FAILURE;
     }
 
+    return status;
+}
+
+/**
+ * @brief Wait for a SPI transfer started by chipinterface_transfer_spi_async().
+ *
+ * @param[in] microseconds Time limit to wait in microseconds.
+ * @return CHIPINTERFACE_SUCCESS if the transfer completed, CHIPINTERFACE_TIMEOUT if it was
+ *         cancelled after the time limit or CHIPINTERFACE_FAILURE if it failed.
+ */
+chipinterface_error_t chipinterface_wait_transfer_spi(uint32_t microseconds)
+{
+    TickType_t wait = portMAX_DELAY;
 
-    return transfer_ok ? CHIPINTERFACE_SUCCESS : CHIPINTERFACE_FAILURE;
+    if(microseconds != CHIPINTERFACE_WAIT_FOREVER)
+    {
+        uint32_t millisecs = (uint32_t)(microseconds/1000);
+        if(!millisecs)
+        {
+            millisecs = 1;
+        }
+        wait = pdMS_TO_TICKS(millisecs);
+    }
+    return spi_transfer_wait(wait);
 }
 
 /**
@@ -444,29 +588,30 @@ chipinterface_error_t chipinterface_get_interrupt_state(chipinterface_interrupt_
  * @brief Wait for a sensor interrupt.
  *
  * This function waits for a sensor interrupt to occur, given a specified time limit in microseconds.
+ * Disabling the chip meanwhile ends the wait early, also with a time limit.
  *
- * @param[in] microseconds Time limit to wait for an interrupt in microseconds.
+ * @param[in] microseconds Time limit to wait for an interrupt in microseconds or PORT_WAIT_FOREVER_US.
  * @return CHIPINTERFACE_SUCCESS if an interrupt occurs, or CHIPINTERFACE_FAILURE if a timeout occurs.
  */
 chipinterface_error_t chipinterface_wait_for_interrupt(uint32_t microseconds)
 {
     uint32_t wait;
-    if(microseconds != portMAX_DELAY)
+    BaseType_t taken;
+    gStarted = true;
+    if(microseconds != PORT_WAIT_FOREVER_US)
     {
-        uint32_t millisecs = (uint32_t)(microseconds/1000);
-        if(!millisecs)
-        {
-            millisecs = 1;
-        }
-        wait  = pdMS_TO_TICKS(millisecs);
+        // in 64 bits, the idle and heartbeat waits of the sensor task last up to minutes
+        uint64_t ticks = (uint64_t)microseconds * configTICK_RATE_HZ / 1000000;
+
+        wait = ticks ? (uint32_t)ticks : 1;
     }
     else
     {
-        wait = microseconds;
-        gStarted = true;
-
+        wait = portMAX_DELAY;
     }
-    if(xSemaphoreTake(irqSem, wait))
+    taken = xSemaphoreTake(irqSem, wait);
+    TRACE_RECORD(TRACE_SEM_TAKE, TRACE_SEM_IRQ, taken == pdTRUE);
+    if(taken)
     {
         if(gEvents & CI_EVENTS_IRQ)
         {
@@ -480,3 +625,81 @@ chipinterface_error_t chipinterface_wait_for_interrupt(uint32_t microseconds)
     }
     return CHIPINTERFACE_FAILURE;
 }
+
+/**
+ * @brief Wait for a sensor interrupt or a wake-up.
+ *
+ * Same as chipinterface_wait_for_interrupt(), but chipinterface_wake() ends the wait early as
+ * well. Used by the owner of the sensor to wait for the next frame and for new requests at the
+ * same time. A wake-up that arrives while no such wait is pending ends the next one right away.
+ * Waits of the sensor driver are never woken.
+ *
+ * @param[in] microseconds Time limit to wait for an interrupt in microseconds or PORT_WAIT_FOREVER_US.
+ * @return CHIPINTERFACE_SUCCESS if an interrupt occurs, or CHIPINTERFACE_FAILURE on timeout or wake-up.
+ */
+chipinterface_error_t chipinterface_wait_for_interrupt_or_wake(uint32_t microseconds)
+{
+    chipinterface_error_t status;
+    bool woken;
+
+    taskENTER_CRITICAL();
+    woken = (gEvents & CI_EVENTS_WAKE) != 0;
+    gEvents &= ~CI_EVENTS_WAKE;
+    gWakeable = !woken;
+    taskEXIT_CRITICAL();
+    if(woken)
+    {
+        return CHIPINTERFACE_FAILURE;
+    }
+
+    status = chipinterface_wait_for_interrupt(microseconds);
+
+    taskENTER_CRITICAL();
+    // A wake-up given after the wait ended must not end a later wait of the driver
+    if((gEvents & CI_EVENTS_WAKE) && !gWakeable && !(gEvents & CI_EVENTS_IRQ))
+    {
+        xSemaphoreTake(irqSem, 0);
+    }
+    gEvents &= ~CI_EVENTS_WAKE;
+    gWakeable = false;
+    taskEXIT_CRITICAL();
+    return status;
+}
+
+/**
+ * @brief Wake the sensor owner.
+ *
+ * Ends a pending chipinterface_wait_for_interrupt_or_wake(), or the next one if none is
+ * pending. Does not block and may be called from any task.
+ */
+void chipinterface_wake(void)
+{
+    taskENTER_CRITICAL();
+    gEvents |= CI_EVENTS_WAKE;
+    if(gWakeable)
+    {
+        gWakeable = false;
+        TRACE_RECORD(TRACE_SEM_GIVE, TRACE_SEM_IRQ, 0);
+        xSemaphoreGive(irqSem);
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Select the edges of the sensor interrupt line that raise an interrupt.
+ *
+ * @param[in] both_edges true for both edges, false for the rising edge only.
+ */
+void chipinterface_set_interrupt_edges(bool both_edges)
+{
+    GPIO_disableInt(CONFIG_GPIO_X4_IRQ_0);
+    if(both_edges)
+    {
+        GPIO_setConfig(CONFIG_GPIO_X4_IRQ_0, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_BOTH_EDGES);
+    }
+    else
+    {
+        GPIO_setConfig(CONFIG_GPIO_X4_IRQ_0, GPIO_CFG_IN_NOPULL | GPIO_CFG_IN_INT_RISING);
+    }
+    GPIO_enableInt(CONFIG_GPIO_X4_IRQ_0);
+}
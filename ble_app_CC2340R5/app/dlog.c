@@ -0,0 +1,158 @@
+/**
+ * @file dlog.c
+ * @brief Deferred binary logging.
+ *
+ * Writers reserve space for a record with a critical section of a few instructions, fill in
+ * the arguments and publish the record by writing its first word last. The drain task runs at
+ * idle priority and is the only reader, it consumes published records in order and clears them.
+ * Formatting and the blocking UART output therefore only take time nobody else needs, and a
+ * burst of records costs one task notification.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <novelda_chipinterface.h>
+#include <ti/display/Display.h>
+#include <app_main.h>
+#include "dlog.h"
+
+#define DLOG_RING_MASK      (DLOG_RING_WORDS - 1)
+#define DLOG_TASK_STACK     256
+
+static volatile uint32_t gRing[DLOG_RING_WORDS];
+/* Free running word indexes, written by the writers and the drain task respectively */
+static volatile uint32_t gWrite;
+static volatile uint32_t gRead;
+static uint16_t          gSequence;
+static volatile uint32_t gDropped;
+static TaskHandle_t      gTask;
+
+
+/**
+ * @brief Store a record in the ring.
+ *
+ * Drops the record if the ring is full. Wakes the drain task if the ring was empty, later
+ * records of the same burst are drained in the same run.
+ *
+ * @param[in] nargs Number of arguments, at most DLOG_MAX_ARGS.
+ * @param[in] fmt   Format string literal, the address identifies it.
+ */
+void dlog_write(uint32_t nargs, const char *fmt, ...)
+{
+    uint32_t timestamp_us;
+    uint32_t start;
+    uint32_t sequence;
+    uint32_t words = DLOG_HEADER_WORDS + nargs;
+    bool empty;
+    va_list args;
+
+    chipinterface_get_time_microseconds(&timestamp_us);
+    taskENTER_CRITICAL();
+    sequence = gSequence++;
+    start = gWrite;
+    empty = (start == gRead);
+    if(nargs > DLOG_MAX_ARGS || DLOG_RING_WORDS - (start - gRead) < words)
+    {
+        gDropped++;
+        taskEXIT_CRITICAL();
+        return;
+    }
+    gWrite = start + words;
+    taskEXIT_CRITICAL();
+
+    gRing[(start + 1) & DLOG_RING_MASK] = timestamp_us;
+    gRing[(start + 2) & DLOG_RING_MASK] = (uint32_t)(uintptr_t)fmt;
+    va_start(args, fmt);
+    for(uint32_t i = 0; i < nargs; i++)
+    {
+        // all arguments are at most 32 bits wide and promoted to a full word
+        gRing[(start + DLOG_HEADER_WORDS + i) & DLOG_RING_MASK] = va_arg(args, uint32_t);
+    }
+    va_end(args);
+    // publishes the record, the drain task stops at the first word that is still 0
+    gRing[start & DLOG_RING_MASK] = ((uint32_t)DLOG_MAGIC << 24) | (nargs << 16) | sequence;
+
+    if(empty && gTask)
+    {
+        xTaskNotifyGive(gTask);
+    }
+}
+
+/**
+ * @brief Get the number of records dropped because the ring was full.
+ *
+ * @return Number of dropped records.
+ */
+uint32_t dlog_get_dropped(void)
+{
+    return gDropped;
+}
+
+/**
+ * @brief Write the oldest record to the UART and remove it from the ring.
+ *
+ * @return true if a record was drained, false if the ring is empty.
+ */
+static bool dlog_drain(void)
+{
+    char line[sizeof(DLOG_LINE_PREFIX) + (DLOG_HEADER_WORDS + DLOG_MAX_ARGS) * 9];
+    uint32_t start = gRead;
+    uint32_t header = gRing[start & DLOG_RING_MASK];
+    uint32_t words;
+    int len;
+
+    if(header == 0)
+    {
+        return false;
+    }
+    words = DLOG_HEADER_WORDS + ((header >> 16) & 0xFF);
+    len = snprintf(line, sizeof(line), "%s", DLOG_LINE_PREFIX);
+    for(uint32_t i = 0; i < words; i++)
+    {
+        uint32_t index = (start + i) & DLOG_RING_MASK;
+
+        len += snprintf(&line[len], sizeof(line) - len, " %08x", (unsigned int)gRing[index]);
+        gRing[index] = 0;
+    }
+    gRead = start + words;
+    Display_printf(handle, 0, 0, "%s", line);
+    return true;
+}
+
+/**
+ * @brief Drain task.
+ *
+ * Runs at idle priority, so it only gets the CPU when every other task waits.
+ *
+ * @param[in] arg Unused task argument.
+ */
+static void dlog_task(void *arg)
+{
+    (void)arg;
+
+    for(;;)
+    {
+        // records written before the task existed did not notify it
+        while(dlog_drain())
+        {
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief Start draining the ring.
+ *
+ * Call once the display is open. Records written before are kept and drained first.
+ */
+void dlog_init(void)
+{
+    if(pdPASS != xTaskCreate(dlog_task, "LOG", DLOG_TASK_STACK, NULL, tskIDLE_PRIORITY, &gTask))
+    {
+        gTask = NULL;
+    }
+}
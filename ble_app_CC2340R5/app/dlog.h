@@ -0,0 +1,51 @@
+/**
+ * @file dlog.h
+ * @brief Deferred binary logging.
+ *
+ * DLOG() takes the place of Display_printf() on the hot path. It only stores the address of the
+ * format string, a timestamp and the raw 32 bit arguments in a RAM ring and returns. A task at
+ * idle priority drains the ring to the display UART once nothing else runs, as hex lines that
+ * tools/dlog turns back into text with the format strings of the application image.
+ */
+
+#ifndef DLOG_H_
+#define DLOG_H_
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DLOG_RING_WORDS     512       // size of the ring in 32 bit words, a power of two
+#define DLOG_MAX_ARGS       8         // arguments of one record
+#define DLOG_MAGIC          0xD1      // top byte of the first word of every record
+#define DLOG_LINE_PREFIX    "#DL"     // start of a drained record on the UART
+
+/*
+ * Record in the ring and on the UART, all 32 bit words:
+ * DLOG_MAGIC << 24 | argument count << 16 | sequence number, timestamp in us,
+ * format string address, arguments.
+ * Every DLOG() call takes a sequence number, so a gap shows how many records were dropped.
+ */
+#define DLOG_HEADER_WORDS   3
+
+/* Number of arguments after the format string */
+#define DLOG_COUNT(...) DLOG_COUNT_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0, ~)
+#define DLOG_COUNT_(fmt, a1, a2, a3, a4, a5, a6, a7, a8, n, ...) n
+
+/**
+ * @brief Log a message without formatting it.
+ *
+ * Takes a printf format string literal and up to DLOG_MAX_ARGS arguments of at most 32 bits.
+ * String arguments must point to constant strings of the application image. Task context only.
+ */
+#define DLOG(...) dlog_write(DLOG_COUNT(__VA_ARGS__), __VA_ARGS__)
+
+extern void dlog_init(void);
+extern void dlog_write(uint32_t nargs, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+extern uint32_t dlog_get_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DLOG_H_ */
@@ -0,0 +1,343 @@
+/**
+ * @file energy.c
+ * @brief Energy estimate of the board per operating mode.
+ *
+ * The time of a mode is measured with the run time counter of the instrumentation. The activity
+ * is accounted in segments, a segment ends on every change of the mode or of the connection
+ * interval and at the end of the window. The report is computed by the timer task and logged
+ * through the deferred log.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include "dlog.h"
+#include "novelda_x4sensor.h"
+#include "novelda_sensor.h"
+#include "instrumentation.h"
+#include "energy.h"
+
+#ifdef ENERGY_ESTIMATE
+
+#define ADVERTISING_INTERVAL_US     100000  // advertising interval of the SysConfig
+
+/*
+ * LP-EM-CC2340R5 with the X4 sensor board at 3 V, DC/DC enabled. Estimates from the data sheets
+ * and the power measurements of TI, calibrate them on the bench before relying on absolute
+ * numbers.
+ */
+static const x4sensor_energy_coefficients_t gCoefficients =
+{
+    .idle_na = 5000,
+    .sensor_on_na = 30000,
+    .sensor_frame_nc = 1500,
+    .firmware_upload_nc = 50000,
+    .bus_active_na = 500000,
+    .transaction_nc = 5,
+    .cpu_active_na = 2600000,
+    .wakeup_nc = 5,
+    .connection_event_nc = 3500,
+    .notification_nc = 1200,
+    .advertising_event_nc = 8000,
+};
+
+static const char *const gModeNames[ENERGY_MODE_COUNT] =
+{
+    "idle", "sensing", "connected", "connected sensing"
+};
+
+typedef struct
+{
+    uint32_t duration_us;
+    uint32_t cpu_us;
+    uint32_t connection_events;
+    x4sensor_energy_activity_t activity;
+} modeAccount_t;
+
+/* Accounts of the window, changed by any task in a critical section */
+static modeAccount_t gAccounts[ENERGY_MODE_COUNT];
+static bool gSensing;
+static bool gConnected;
+static uint32_t gIntervalUs;
+/* Counters at the start of the segment */
+static uint32_t gSegmentStartUs;
+static x4sensor_driver_stats_t gSegmentDriver;
+static uint32_t gSegmentWakeups;
+static uint32_t gSegmentSleepUs;
+static bool gSleepCounted;
+
+/* Report of the window, used by the timer task only */
+static modeAccount_t gReport[ENERGY_MODE_COUNT];
+static x4sensor_energy_estimate_t gEstimate;
+
+static TimerHandle_t windowTimer;
+
+/**
+ * @brief Add the activity since the start of the segment to the account of the mode and start
+ *        the next segment.
+ *
+ * Called in a critical section.
+ */
+static void close_segment(void)
+{
+    modeAccount_t *account = &gAccounts[gSensing | (gConnected << 1)];
+    x4sensor_energy_activity_t *activity = &account->activity;
+    x4sensor_driver_stats_t driver;
+    uint32_t now_us = instrumentation_get_time_us();
+    uint32_t segment_us = now_us - gSegmentStartUs;
+    uint32_t wakeups;
+    uint32_t sleep_us;
+
+    x4sensor_get_driver_stats(&driver);
+    gSleepCounted = instrumentation_get_sleep_totals(&wakeups, &sleep_us);
+
+    account->duration_us += segment_us;
+    if(gSleepCounted)
+    {
+        uint32_t segment_sleep_us = sleep_us - gSegmentSleepUs;
+
+        account->cpu_us += segment_sleep_us < segment_us ? segment_us - segment_sleep_us : 0;
+        activity->wakeups += wakeups - gSegmentWakeups;
+    }
+    if(gConnected && gIntervalUs)
+    {
+        account->connection_events += segment_us / gIntervalUs;
+    }
+    activity->frame_rate = sensor_get_frame_rate();
+    activity->bus = driver.bus;
+    activity->bus_frequency_hz = driver.bus_frequency_hz;
+    activity->transactions += driver.transactions - gSegmentDriver.transactions;
+    activity->bytes += driver.bytes - gSegmentDriver.bytes;
+    activity->firmware_uploads += driver.firmware_uploads - gSegmentDriver.firmware_uploads;
+    activity->data_reads += driver.data_reads - gSegmentDriver.data_reads;
+    activity->errors += driver.errors - gSegmentDriver.errors;
+
+    gSegmentStartUs = now_us;
+    gSegmentDriver = driver;
+    gSegmentWakeups = wakeups;
+    gSegmentSleepUs = sleep_us;
+}
+
+/**
+ * @brief Complete the activity of a mode from its account.
+ *
+ * @param[in]     mode    Mode of the account.
+ * @param[in,out] account Account of the window.
+ */
+static void complete_activity(uint8_t mode, modeAccount_t *account)
+{
+    x4sensor_energy_activity_t *activity = &account->activity;
+    uint32_t duration_ms = account->duration_us / 1000;
+
+    activity->duration_ms = duration_ms;
+    activity->sensor_ms = (mode & ENERGY_MODE_SENSING) ? duration_ms : 0;
+    activity->cpu_ms = account->cpu_us / 1000;
+    if(mode & ENERGY_MODE_CONNECTED)
+    {
+        activity->connected_ms = duration_ms;
+        activity->connection_interval_us = account->connection_events ?
+                                           account->duration_us / account->connection_events : 0;
+    }
+    else
+    {
+        activity->advertising_ms = duration_ms;
+        activity->advertising_interval_us = ADVERTISING_INTERVAL_US;
+    }
+}
+
+/**
+ * @brief Log 32 bit words of a structure as lines that tools/energy_replay reads back.
+ *
+ * @param[in] coefficients true for the coefficients, false for an activity.
+ * @param[in] tag          Mode << 8 for an activity, 0 for the coefficients.
+ * @param[in] words        Words of the structure.
+ * @param[in] count        Number of words.
+ */
+static void log_words(bool coefficients, uint32_t tag, const uint32_t *words, uint32_t count)
+{
+    uint32_t line[ENERGY_LINE_WORDS];
+
+    for(uint32_t part = 0; part * ENERGY_LINE_WORDS < count; part++)
+    {
+        for(uint32_t i = 0; i < ENERGY_LINE_WORDS; i++)
+        {
+            uint32_t word = part * ENERGY_LINE_WORDS + i;
+
+            line[i] = word < count ? words[word] : 0;
+        }
+        if(coefficients)
+        {
+            DLOG(ENERGY_COEFFICIENTS_PREFIX " %x %08x %08x %08x %08x %08x",
+                 tag | part, line[0], line[1], line[2], line[3], line[4]);
+        }
+        else
+        {
+            DLOG(ENERGY_LINE_PREFIX " %x %08x %08x %08x %08x %08x",
+                 tag | part, line[0], line[1], line[2], line[3], line[4]);
+        }
+    }
+}
+
+/**
+ * @brief Callback at the end of every estimate window.
+ *
+ * @param[in] timer Timer handle.
+ */
+static void clkWindowCallback(TimerHandle_t timer)
+{
+    uint32_t window_ms = 0;
+
+    (void)timer;
+    taskENTER_CRITICAL();
+    close_segment();
+    memcpy(gReport, gAccounts, sizeof(gReport));
+    memset(gAccounts, 0, sizeof(gAccounts));
+    taskEXIT_CRITICAL();
+
+    for(uint8_t mode = 0; mode < ENERGY_MODE_COUNT; mode++)
+    {
+        window_ms += gReport[mode].duration_us / 1000;
+    }
+    if(window_ms == 0)
+    {
+        return;
+    }
+    log_words(true, 0, (const uint32_t *)&gCoefficients, sizeof(gCoefficients) / sizeof(uint32_t));
+    for(uint8_t mode = 0; mode < ENERGY_MODE_COUNT; mode++)
+    {
+        const x4sensor_energy_activity_t *activity = &gReport[mode].activity;
+
+        complete_activity(mode, &gReport[mode]);
+        if(x4sensor_estimate_energy(&gCoefficients, activity, &gEstimate) != X4SENSOR_SUCCESS)
+        {
+            continue;
+        }
+        DLOG("Energy %s: %u.%03u uA, %u permille of %u ms", gModeNames[mode],
+             gEstimate.total_na / 1000, gEstimate.total_na % 1000,
+             activity->duration_ms * 1000 / window_ms, window_ms);
+        DLOG("Energy %s: idle %u, sensor %u, bus %u, CPU %u, radio %u nA", gModeNames[mode],
+             gEstimate.idle_na, gEstimate.sensor_na, gEstimate.bus_na, gEstimate.cpu_na,
+             gEstimate.radio_na);
+        if(activity->sensor_ms)
+        {
+            // every frame is read while zones or tracking are set, otherwise state changes only
+            DLOG("Energy %s: %u frame reads in %u frames", gModeNames[mode], activity->data_reads,
+                 (uint32_t)((uint64_t)activity->sensor_ms * activity->frame_rate / 1000));
+        }
+        log_words(false, mode << 8, (const uint32_t *)activity, sizeof(*activity) / sizeof(uint32_t));
+    }
+    if(!gSleepCounted)
+    {
+        DLOG("Energy: CPU time estimated, build with INSTRUMENTATION to measure it");
+    }
+}
+
+/**
+ * @brief Start the estimate windows.
+ *
+ * Called by the BLE application task when the stack is initialized.
+ */
+void energy_init(void)
+{
+    // the sensor may have been started already, the accounting starts now
+    taskENTER_CRITICAL();
+    memset(gAccounts, 0, sizeof(gAccounts));
+    gSegmentStartUs = instrumentation_get_time_us();
+    x4sensor_get_driver_stats(&gSegmentDriver);
+    gSleepCounted = instrumentation_get_sleep_totals(&gSegmentWakeups, &gSegmentSleepUs);
+    taskEXIT_CRITICAL();
+    windowTimer = xTimerCreate("ENER",
+                               pdMS_TO_TICKS(ENERGY_WINDOW_MS),
+                               pdTRUE,
+                               NULL,
+                               clkWindowCallback);
+    if(windowTimer == NULL || xTimerStart(windowTimer, 0) != pdPASS)
+    {
+        DLOG("Energy estimate not available");
+    }
+}
+
+/**
+ * @brief Account the sensor as running or stopped from now on.
+ *
+ * @param[in] sensing true when the sensor was started, false when it was stopped.
+ */
+void energy_set_sensing(bool sensing)
+{
+    taskENTER_CRITICAL();
+    if(sensing != gSensing)
+    {
+        close_segment();
+        gSensing = sensing;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Account a connection or advertising from now on.
+ *
+ * @param[in] connected   true while a central is connected, false while advertising.
+ * @param[in] interval_us Connection interval in microseconds, ignored when not connected.
+ */
+void energy_set_connection(bool connected, uint32_t interval_us)
+{
+    taskENTER_CRITICAL();
+    if(connected != gConnected || (connected && interval_us != gIntervalUs))
+    {
+        close_segment();
+        gConnected = connected;
+        gIntervalUs = connected ? interval_us : 0;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Account a notification sent to the central.
+ */
+void energy_add_notification(void)
+{
+    taskENTER_CRITICAL();
+    if(gConnected)
+    {
+        gAccounts[gSensing | (gConnected << 1)].activity.notifications++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+#else
+
+/**
+ * @brief Nothing to start without ENERGY_ESTIMATE.
+ */
+void energy_init(void)
+{
+}
+
+/**
+ * @brief Nothing to account without ENERGY_ESTIMATE.
+ */
+void energy_set_sensing(bool sensing)
+{
+    (void)sensing;
+}
+
+/**
+ * @brief Nothing to account without ENERGY_ESTIMATE.
+ */
+void energy_set_connection(bool connected, uint32_t interval_us)
+{
+    (void)connected;
+    (void)interval_us;
+}
+
+/**
+ * @brief Nothing to account without ENERGY_ESTIMATE.
+ */
+void energy_add_notification(void)
+{
+}
+
+#endif // ENERGY_ESTIMATE
@@ -0,0 +1,363 @@
+/**
+ * @file instrumentation.c
+ * @brief Runtime instrumentation of the tasks, the stacks and the standby sleep.
+ *
+ * The time base is the 1 us system time of SYSTIM, which the device keeps in sync across
+ * standby, so an instrumented build still shows idle power regressions. The power driver
+ * notifies every entry into and wake-up from standby.
+ *
+ * The FreeRTOS configuration of the project is generated by SysConfig. The stack high-water
+ * marks need configUSE_TRACE_FACILITY, the CPU times of the tasks in addition
+ * configGENERATE_RUN_TIME_STATS with portGET_RUN_TIME_COUNTER_VALUE() mapped to
+ * instrumentation_get_time_us(). Statistics the configuration does not provide are flagged as
+ * invalid in the Diagnostics characteristic.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include <ti/drivers/Power.h>
+#include <ti/drivers/power/PowerCC23X0.h>
+#include <ti/devices/DeviceFamily.h>
+#include DeviceFamily_constructPath(inc/hw_types.h)
+#include DeviceFamily_constructPath(inc/hw_memmap.h)
+#include DeviceFamily_constructPath(inc/hw_systim.h)
+#include "dlog.h"
+#include "instrumentation.h"
+#include "novelda_sensor.h"
+
+typedef struct
+{
+    char     name[DIAGNOSTICS_TASK_NAME_LEN + 1];
+    uint32_t cpu_us;
+    uint16_t stack_free;
+} taskStats_t;
+
+typedef struct
+{
+    uint8_t     flags;
+    uint32_t    window_us;
+    uint32_t    wakeups;
+    uint32_t    sleep_us;
+    uint8_t     task_count;
+    taskStats_t tasks[INSTRUMENTATION_MAX_TASKS];
+} report_t;
+
+static report_t gReport;
+
+/**
+ * @brief Get the system time.
+ *
+ * @return Time in microseconds, wraps after 71 minutes.
+ */
+uint32_t instrumentation_get_time_us(void)
+{
+    return HWREG(SYSTIM_BASE + SYSTIM_O_TIME1U);
+}
+
+#ifdef INSTRUMENTATION
+
+/* Written by the idle task with interrupts disabled */
+static volatile uint32_t gWakeups;
+static volatile uint32_t gSleepUs;
+static volatile uint32_t gWakeupsTotal;
+static volatile uint32_t gSleepUsTotal;
+static uint32_t gSleepStartUs;
+static uint32_t gWindowStartUs;
+static Power_NotifyObj gPowerNotify;
+static TimerHandle_t windowTimer;
+#if (configUSE_TRACE_FACILITY == 1)
+/* Run time counters at the end of the last window, by task number */
+static UBaseType_t gLastNumber[INSTRUMENTATION_MAX_TASKS];
+static uint32_t gLastRunTime[INSTRUMENTATION_MAX_TASKS];
+static UBaseType_t gLastCount;
+static TaskStatus_t gStatus[INSTRUMENTATION_MAX_TASKS];
+#endif
+
+
+/**
+ * @brief Called by the power driver before entering and after waking up from standby.
+ *
+ * Runs in the idle task with interrupts disabled.
+ *
+ * @param[in] eventType Power event.
+ * @param[in] eventArg  Unused event argument.
+ * @param[in] clientArg Unused client argument.
+ * @return Power_NOTIFYDONE.
+ */
+static int_fast16_t power_notify(uint_fast16_t eventType, uintptr_t eventArg, uintptr_t clientArg)
+{
+    (void)eventArg;
+    (void)clientArg;
+
+    if(eventType == PowerLPF3_ENTERING_STANDBY)
+    {
+        gSleepStartUs = instrumentation_get_time_us();
+    }
+    else
+    {
+        uint32_t sleep_us = instrumentation_get_time_us() - gSleepStartUs;
+
+        gSleepUs += sleep_us;
+        gSleepUsTotal += sleep_us;
+        gWakeups++;
+        gWakeupsTotal++;
+    }
+    return Power_NOTIFYDONE;
+}
+
+/**
+ * @brief Collect the CPU time and stack high-water mark of every task.
+ *
+ * @param[out] report Report of the window.
+ */
+static void collect_tasks(report_t *report)
+{
+#if (configUSE_TRACE_FACILITY == 1)
+    UBaseType_t count = uxTaskGetSystemState(gStatus, INSTRUMENTATION_MAX_TASKS, NULL);
+
+    // 0 if there are more tasks than INSTRUMENTATION_MAX_TASKS
+    if(count == 0)
+    {
+        report->task_count = 0;
+        return;
+    }
+    report->flags |= DIAGNOSTICS_FLAG_STACK;
+#if (configGENERATE_RUN_TIME_STATS == 1)
+    report->flags |= DIAGNOSTICS_FLAG_CPU;
+#endif
+    report->task_count = (uint8_t)count;
+    for(UBaseType_t i = 0; i < count; i++)
+    {
+        taskStats_t *task = &report->tasks[i];
+
+        memset(task->name, 0, sizeof(task->name));
+        strncpy(task->name, gStatus[i].pcTaskName, DIAGNOSTICS_TASK_NAME_LEN);
+        task->stack_free = gStatus[i].usStackHighWaterMark;
+        task->cpu_us = 0;
+#if (configGENERATE_RUN_TIME_STATS == 1)
+        uint32_t last = 0;
+
+        for(UBaseType_t j = 0; j < gLastCount; j++)
+        {
+            if(gLastNumber[j] == gStatus[i].xTaskNumber)
+            {
+                last = gLastRunTime[j];
+                break;
+            }
+        }
+        task->cpu_us = gStatus[i].ulRunTimeCounter - last;
+#endif
+    }
+#if (configGENERATE_RUN_TIME_STATS == 1)
+    for(UBaseType_t i = 0; i < count; i++)
+    {
+        gLastNumber[i] = gStatus[i].xTaskNumber;
+        gLastRunTime[i] = gStatus[i].ulRunTimeCounter;
+    }
+    gLastCount = count;
+#endif
+#else
+    report->task_count = 0;
+#endif
+}
+
+/**
+ * @brief Print a report on the UART.
+ *
+ * @param[in] report Report of the window.
+ */
+static void print_report(const report_t *report)
+{
+    uint32_t window_ms = report->window_us / 1000;
+    sensor_health_t health;
+
+    if(window_ms == 0)
+    {
+        return;
+    }
+    sensor_get_health(&health);
+    DLOG("Diagnostics: %u wake-ups/s, asleep %u permille of %u ms",
+         report->wakeups * 1000 / window_ms, report->sleep_us / window_ms, window_ms);
+    DLOG("Sensor: %u failures, %u recoveries, downtime %u ms, last %u ms%s",
+         health.failures, health.recoveries, health.downtime_ms, health.last_downtime_ms,
+         health.recovering ? ", recovering" : "");
+    for(uint8_t i = 0; i < report->task_count; i++)
+    {
+        const taskStats_t *task = &report->tasks[i];
+
+        // the task name is not a constant of the image, it is logged character by character
+        DLOG("Task %c%c%c%c: CPU %u us, %u permille, stack free %u words",
+             task->name[0] ? task->name[0] : ' ', task->name[1] ? task->name[1] : ' ',
+             task->name[2] ? task->name[2] : ' ', task->name[3] ? task->name[3] : ' ',
+             task->cpu_us, task->cpu_us / window_ms, task->stack_free);
+    }
+}
+
+/**
+ * @brief Callback at the end of every statistics window.
+ *
+ * @param[in] timer Timer handle.
+ */
+static void clkWindowCallback(TimerHandle_t timer)
+{
+    report_t *report = &gReport;
+    uint32_t now_us = instrumentation_get_time_us();
+    uint32_t wakeups;
+    uint32_t sleep_us;
+
+    (void)timer;
+    taskENTER_CRITICAL();
+    wakeups = gWakeups;
+    sleep_us = gSleepUs;
+    gWakeups = 0;
+    gSleepUs = 0;
+    taskEXIT_CRITICAL();
+
+    // readers are tasks, they do not run while the report changes
+    vTaskSuspendAll();
+    report->flags = DIAGNOSTICS_FLAG_SLEEP;
+    report->window_us = now_us - gWindowStartUs;
+    report->wakeups = wakeups;
+    report->sleep_us = sleep_us;
+    collect_tasks(report);
+    (void)xTaskResumeAll();
+    gWindowStartUs = now_us;
+
+    print_report(report);
+}
+
+/**
+ * @brief Get the wake-ups and the time asleep since the start.
+ *
+ * The counters wrap, differences of two readings are valid across a wrap.
+ *
+ * @param[out] wakeups  Wake-ups from sleep.
+ * @param[out] sleep_us Time asleep in microseconds.
+ * @return true, the counters are available.
+ */
+bool instrumentation_get_sleep_totals(uint32_t *wakeups, uint32_t *sleep_us)
+{
+    taskENTER_CRITICAL();
+    *wakeups = gWakeupsTotal;
+    *sleep_us = gSleepUsTotal;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+/**
+ * @brief Start the statistics windows.
+ */
+void instrumentation_init(void)
+{
+    gWindowStartUs = instrumentation_get_time_us();
+    if(Power_SOK != Power_registerNotify(&gPowerNotify,
+                                         PowerLPF3_ENTERING_STANDBY | PowerLPF3_AWAKE_STANDBY,
+                                         power_notify, 0))
+    {
+        DLOG("Standby notifications not available");
+    }
+    windowTimer = xTimerCreate("DIAG",
+                               pdMS_TO_TICKS(INSTRUMENTATION_WINDOW_MS),
+                               pdTRUE,
+                               NULL,
+                               clkWindowCallback);
+    if(windowTimer == NULL || xTimerStart(windowTimer, 0) != pdPASS)
+    {
+        DLOG("Instrumentation not available");
+    }
+}
+
+#else
+
+/**
+ * @brief Nothing to start without INSTRUMENTATION.
+ */
+void instrumentation_init(void)
+{
+}
+
+/**
+ * @brief The sleep is not counted without INSTRUMENTATION.
+ *
+ * @param[out] wakeups  Set to 0.
+ * @param[out] sleep_us Set to 0.
+ * @return false, the counters are not available.
+ */
+bool instrumentation_get_sleep_totals(uint32_t *wakeups, uint32_t *sleep_us)
+{
+    *wakeups = 0;
+    *sleep_us = 0;
+    return false;
+}
+
+#endif // INSTRUMENTATION
+
+/**
+ * @brief Store a little endian 32 bit value.
+ *
+ * @param[out] p     Destination.
+ * @param[in]  value Value to store.
+ * @return Position after the value.
+ */
+static uint8_t *put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+/**
+ * @brief Encode the Diagnostics characteristic value.
+ *
+ * Holds the statistics of the last complete window and the sensor watchdog statistics since the
+ * start, see instrumentation.h for the format.
+ *
+ * @param[out] value  Buffer for the value.
+ * @param[in]  maxLen Size of the buffer, at least DIAGNOSTICS_HEADER_SIZE.
+ * @return Length of the value, 0 if the buffer is too small.
+ */
+uint16_t instrumentation_get_value(uint8_t *value, uint16_t maxLen)
+{
+    uint8_t *p = value;
+    uint8_t count;
+    sensor_health_t health;
+
+    if(maxLen < DIAGNOSTICS_HEADER_SIZE)
+    {
+        return 0;
+    }
+    sensor_get_health(&health);
+    taskENTER_CRITICAL();
+    count = gReport.task_count;
+    if(count > (maxLen - DIAGNOSTICS_HEADER_SIZE) / DIAGNOSTICS_TASK_SIZE)
+    {
+        count = (maxLen - DIAGNOSTICS_HEADER_SIZE) / DIAGNOSTICS_TASK_SIZE;
+    }
+    *p++ = DIAGNOSTICS_VALUE_VERSION;
+    *p++ = gReport.flags | (health.recovering ? DIAGNOSTICS_FLAG_RECOVERING : 0);
+    p = put_u32(p, gReport.window_us);
+    p = put_u32(p, gReport.wakeups);
+    p = put_u32(p, gReport.sleep_us);
+    p = put_u32(p, health.failures);
+    p = put_u32(p, health.recoveries);
+    p = put_u32(p, health.downtime_ms);
+    p = put_u32(p, health.last_downtime_ms);
+    *p++ = count;
+    for(uint8_t i = 0; i < count; i++)
+    {
+        memcpy(p, gReport.tasks[i].name, DIAGNOSTICS_TASK_NAME_LEN);
+        p += DIAGNOSTICS_TASK_NAME_LEN;
+        p = put_u32(p, gReport.tasks[i].cpu_us);
+        *p++ = (uint8_t)gReport.tasks[i].stack_free;
+        *p++ = (uint8_t)(gReport.tasks[i].stack_free >> 8);
+    }
+    taskEXIT_CRITICAL();
+
+    return (uint16_t)(p - value);
+}
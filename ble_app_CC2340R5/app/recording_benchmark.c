@@ -0,0 +1,155 @@
+/**
+ * @file recording_benchmark.c
+ * @brief Benchmark of serial versus pipelined sensor data reads in recording mode.
+ *
+ * The benchmark runs the sensor in recording mode twice. First each frame is read with
+ * x4sensor_get_sensor_data() and processed afterwards. Then two buffers are used in turn with
+ * x4sensor_start_sensor_data_read() so the radar data transfer of frame N+1 overlaps the
+ * processing of frame N. For both variants the host time spent per frame is measured with the
+ * 1 us SYSTIM counter, from which the maximum sustainable frame rate is derived and printed.
+ *
+ * Build with RECORDING_BENCHMARK defined to run it once after sensor initialization.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <novelda_chipinterface.h>
+#include <novelda_x4sensor.h>
+#include <ti/display/Display.h>
+#include <app_main.h>
+#include "instrumentation.h"
+#include "recording_benchmark.h"
+
+static volatile uint32_t gBenchmarkResult;
+
+/**
+ * @brief Synthetic host processing of one recorded frame.
+ *
+ * Sums up the power of all radar samples following the payload a number of times to emulate
+ * the load of host side signal processing.
+ *
+ * @param[in] buffer Frame data read from the sensor.
+ * @param[in] size   Number of valid bytes in buffer.
+ */
+static void benchmark_process_frame(const uint8_t *buffer, size_t size)
+{
+    size_t offset = x4sensor_get_max_sensor_data_size_event_mode();
+    uint32_t power = 0;
+
+    for(uint8_t pass = 0; pass < RECORDING_BENCHMARK_PROCESSING_PASSES; pass++)
+    {
+        for(size_t i = offset; i + 4 <= size; i += 4)
+        {
+            int16_t re = (int16_t)(buffer[i] | (buffer[i + 1] << 8));
+            int16_t im = (int16_t)(buffer[i + 2] | (buffer[i + 3] << 8));
+            power += (uint32_t)(re * re) + (uint32_t)(im * im);
+        }
+    }
+    gBenchmarkResult = power;
+}
+
+/**
+ * @brief Measure the host time per frame for one read variant.
+ *
+ * @param[in] buffers   Two frame buffers.
+ * @param[in] size      Size of each buffer.
+ * @param[in] pipelined Use the pipelined read API if true.
+ * @return Average host time per frame in microseconds, 0 on error.
+ */
+static uint32_t benchmark_pass(uint8_t *buffers[2], size_t size, bool pipelined)
+{
+    uint32_t busy_us = 0;
+    uint32_t start_us;
+    uint32_t end_us;
+    size_t bytes[2] = {0, 0};
+    uint8_t current = 0;
+    uint16_t frames;
+
+    if(x4sensor_start_recording_mode() != X4SENSOR_SUCCESS)
+    {
+        return 0;
+    }
+
+    for(frames = 0; frames < RECORDING_BENCHMARK_FRAMES; frames++)
+    {
+        if(chipinterface_wait_for_interrupt(1000000) != CHIPINTERFACE_SUCCESS)
+        {
+            break;
+        }
+        start_us = instrumentation_get_time_us();
+        if(pipelined)
+        {
+            if(x4sensor_start_sensor_data_read(buffers[current], size) != X4SENSOR_SUCCESS)
+            {
+                break;
+            }
+            // process the previous frame while the current one is transferred
+            if(bytes[current ^ 1])
+            {
+                benchmark_process_frame(buffers[current ^ 1], bytes[current ^ 1]);
+            }
+            bytes[current] = x4sensor_finish_sensor_data_read();
+            if(!bytes[current])
+            {
+                break;
+            }
+            current ^= 1;
+        }
+        else
+        {
+            bytes[0] = x4sensor_get_sensor_data(buffers[0], size);
+            if(!bytes[0])
+            {
+                break;
+            }
+            benchmark_process_frame(buffers[0], bytes[0]);
+        }
+        end_us = instrumentation_get_time_us();
+        busy_us += end_us - start_us;
+    }
+    x4sensor_stop();
+
+    return (frames == RECORDING_BENCHMARK_FRAMES) ? busy_us / frames : 0;
+}
+
+/**
+ * @brief Run the recording read benchmark.
+ *
+ * Must be called from the sensor task while the sensor is initialized and stopped.
+ */
+void recording_benchmark_run(void)
+{
+    size_t size = x4sensor_get_max_sensor_data_size_recording_mode();
+    uint8_t *buffers[2];
+    uint32_t serial_us;
+    uint32_t pipelined_us;
+
+    buffers[0] = pvPortMalloc(size);
+    buffers[1] = pvPortMalloc(size);
+    if(!buffers[0] || !buffers[1])
+    {
+        Display_printf(handle, 0, 0, "Recording benchmark: out of memory");
+        goto end;
+    }
+
+    serial_us = benchmark_pass(buffers, size, false);
+    pipelined_us = benchmark_pass(buffers, size, true);
+    if(!serial_us || !pipelined_us)
+    {
+        Display_printf(handle, 0, 0, "Recording benchmark failed: %s",
+                       x4sensor_convert_error_to_string(x4sensor_get_last_error()));
+        goto end;
+    }
+
+    Display_printf(handle, 0, 0, "Recording benchmark, %u bytes per frame, sensor at %u fps:",
+                   size, x4sensor_get_frame_rate());
+    Display_printf(handle, 0, 0, "  serial:    %u us per frame, max %u fps",
+                   serial_us, 1000000 / serial_us);
+    Display_printf(handle, 0, 0, "  pipelined: %u us per frame, max %u fps",
+                   pipelined_us, 1000000 / pipelined_us);
+end:
+    vPortFree(buffers[0]);
+    vPortFree(buffers[1]);
+}
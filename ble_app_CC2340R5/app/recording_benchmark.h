@@ -0,0 +1,25 @@
+/**
+ * @file recording_benchmark.h
+ * @brief Header file for the recording mode read benchmark.
+ *
+ * This header file declares the benchmark that compares serial and pipelined sensor data reads
+ * in recording mode.
+ */
+
+#ifndef RECORDING_BENCHMARK_H_
+#define RECORDING_BENCHMARK_H_
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORDING_BENCHMARK_FRAMES            200   // frames measured per read variant
+#define RECORDING_BENCHMARK_PROCESSING_PASSES 8     // synthetic host processing load per frame
+
+extern void recording_benchmark_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RECORDING_BENCHMARK_H_ */
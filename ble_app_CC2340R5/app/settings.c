@@ -0,0 +1,60 @@
+/**
+ * @file settings.c
+ * @brief Persistent application settings in flash.
+ *
+ * The settings are one item of the non-volatile storage of the BLE stack (NVS region, managed
+ * by the NV compaction driver). Every write appends a new copy of the item and compaction
+ * reclaims outdated copies, which spreads the writes over the NVS pages. The item is in the
+ * range the stack reserves for applications.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "bcomdef.h"
+#include "osal_snv.h"
+#include "settings.h"
+
+#define SETTINGS_NV_ID      BLE_NVID_CUST_START   // item of settings_t
+
+
+/**
+ * @brief Initialize the settings storage.
+ *
+ * Nothing to do, the BLE stack initializes the non-volatile storage before the application.
+ *
+ * @return true.
+ */
+bool settings_init(void)
+{
+    return true;
+}
+
+/**
+ * @brief Load the stored settings.
+ *
+ * @param[out] settings Destination for the settings.
+ * @return true if settings of SETTINGS_VERSION were stored, false otherwise.
+ */
+bool settings_load(settings_t *settings)
+{
+    if(osal_snv_read(SETTINGS_NV_ID, sizeof(*settings), settings) != SUCCESS)
+    {
+        return false;
+    }
+    return (settings->version == SETTINGS_VERSION);
+}
+
+/**
+ * @brief Store the settings.
+ *
+ * Writes the settings right away, so it blocks the calling task for the flash write and a
+ * compaction that may be due.
+ *
+ * @param[in] settings Settings to store.
+ * @return true if the settings were written, false otherwise.
+ */
+bool settings_store(const settings_t *settings)
+{
+    return (osal_snv_write(SETTINGS_NV_ID, sizeof(*settings), (void *)settings) == SUCCESS);
+}
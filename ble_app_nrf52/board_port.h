@@ -0,0 +1,18 @@
+/**
+ * @file board_port.h
+ * @brief nRF52840 port of the portable core, see port.h.
+ */
+
+#ifndef BOARD_PORT_H_
+#define BOARD_PORT_H_
+#include "app_timer.h"
+#include "app_error.h"
+#include "nrf_log.h"
+
+#define PORT_LOG_INFO(...)      NRF_LOG_INFO(__VA_ARGS__)
+/* Log and continue, the watchdog of the sensor task recovers a sensor that does not run */
+#define PORT_ASSERT_FAILED()    NRF_LOG_INFO("SENSOR ASSERT!!")
+/* app_timer runs on FreeRTOS timers, see app_timer_freertos.c */
+#define PORT_INIT_TIMERS()      APP_ERROR_CHECK(app_timer_init())
+
+#endif /* BOARD_PORT_H_ */
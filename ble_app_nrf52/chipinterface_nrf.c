@@ -29,6 +29,8 @@
 #include <timers.h>
 #include <task.h>
 #include <novelda_chipinterface.h>
+#include "trace.h"
+#include "port.h"
 
 
 /* TWI instance ID. */
@@ -36,6 +38,7 @@
 
 #define CI_EVENTS_IRQ  0x01
 #define CI_EVENTS_DISSABLE 0x02
+#define CI_EVENTS_WAKE 0x04
 
 #define CONFIG_GPIO_X4_EN_0 NRF_GPIO_PIN_MAP(1, 11)
 #define CONFIG_GPIO_X4_IRQ_0 NRF_GPIO_PIN_MAP(1, 10)
@@ -57,6 +60,8 @@ struct chipinterface_context_t *context_list[SENSORS_SUPPORTED];
 SemaphoreHandle_t irqSem;
 static uint8_t gEvents;
 bool gStarted = false;
+/* A chipinterface_wait_for_interrupt_or_wake() is pending and not woken yet */
+static bool gWakeable;
 
 
 /**
@@ -81,6 +86,8 @@ void gpio_irq_callback(nrf_drv_gpiote_pin_t index, nrf_gpiote_polarity_t action)
     {
     case CONFIG_GPIO_X4_IRQ_0:
         gEvents |= CI_EVENTS_IRQ;
+        TRACE_RECORD(TRACE_IRQ, 1, 0);
+        TRACE_RECORD(TRACE_SEM_GIVE, TRACE_SEM_IRQ, 0);
         xSemaphoreGive(irqSem);
        break;
        /* Insert other case statements here to support
@@ -258,6 +265,7 @@ chipinterface_error_t chipinterface_set_chip_enabled(bool enabled)
     {
         gEvents |= CI_EVENTS_DISSABLE;
         gStarted = false;
+        TRACE_RECORD(TRACE_SEM_GIVE, TRACE_SEM_IRQ, 0);
         xSemaphoreGive(irqSem);
     }
 
@@ -287,20 +295,35 @@ chipinterface_error_t chipinterface_wait_us(uint32_t microseconds)
 }
 
 
+/**
+ * @brief Get the time since the scheduler started in microseconds.
+ *
+ * The tick count is extended with its overflows by the kernel, so the time does not wrap.
+ * Called from task context.
+ *
+ * @return Time in microseconds.
+ */
+uint64_t chipinterface_get_time_microseconds_64(void)
+{
+    TimeOut_t now;
+
+    vTaskSetTimeOutState(&now);
+    return ((((uint64_t)now.xOverflowCount << 32) | now.xTimeOnEntering) * 1000000) / configTICK_RATE_HZ;
+}
+
 /**
  * @brief Get the current time in microseconds.
  *
- * This function retrieves the current time in microseconds since system startup.
+ * This function retrieves the current time in microseconds since system startup. It is the low
+ * 32 bits of chipinterface_get_time_microseconds_64(), so it wraps only after 2^32 us and the
+ * difference of two values is exact for intervals of up to 71 minutes.
  *
  * @param[out] microseconds Pointer to the variable to store the time in microseconds.
  * @return CHIPINTERFACE_SUCCESS if successful, or CHIPINTERFACE_FAILURE if an error occurs.
  */
 chipinterface_error_t chipinterface_get_time_microseconds(uint32_t *microseconds)
 {
-    TickType_t tickCount = xTaskGetTickCount(); 
-    TickType_t tickRate = configTICK_RATE_HZ;   
-
-    *microseconds = ((uint32_t)tickCount * 1000000) / (uint32_t)tickRate;
+    *microseconds = (uint32_t)chipinterface_get_time_microseconds_64();
 	return CHIPINTERFACE_SUCCESS;
 }
 
@@ -375,6 +398,38 @@ chipinterface_error_t chipinterface_transfer_spi(const uint8_t *wdata, size_t wl
     return transfer_ok ? CHIPINTERFACE_SUCCESS : CHIPINTERFACE_FAILURE;
 }
 
+/**
+ * @brief Start a SPI data transfer in the background.
+ *
+ * This port has no background transfer, the transfer is done with chipinterface_transfer_spi()
+ * before returning and its result is reported by chipinterface_wait_transfer_spi(). A failed
+ * transfer is reported right away, so the sensor driver falls back to its blocking read.
+ *
+ * @param[in] wdata       Pointer to the data buffer to write.
+ * @param[in] wlength     Number of bytes to write.
+ * @param[out] rdata      Pointer to the data buffer to store the received data.
+ * @param[in] rlength     Number of bytes to read.
+ * @return CHIPINTERFACE_SUCCESS if successful, or CHIPINTERFACE_FAILURE if an error occurs.
+ */
+chipinterface_error_t chipinterface_transfer_spi_async(const uint8_t *wdata, size_t wlength, uint8_t *rdata, size_t rlength)
+{
+    return chipinterface_transfer_spi(wdata, wlength, rdata, rlength);
+}
+
+/**
+ * @brief Wait for a SPI transfer started by chipinterface_transfer_spi_async().
+ *
+ * The transfer already completed when chipinterface_transfer_spi_async() returned.
+ *
+ * @param[in] microseconds Time limit to wait in microseconds, unused.
+ * @return CHIPINTERFACE_SUCCESS.
+ */
+chipinterface_error_t chipinterface_wait_transfer_spi(uint32_t microseconds)
+{
+    (void)microseconds;
+    return CHIPINTERFACE_SUCCESS;
+}
+
 /**
  * @brief Get the interrupt state of the sensor.
  *
@@ -394,29 +449,30 @@ chipinterface_error_t chipinterface_get_interrupt_state(chipinterface_interrupt_
  * @brief Wait for a sensor interrupt.
  *
  * This function waits for a sensor interrupt to occur, given a specified time limit in microseconds.
+ * Disabling the chip meanwhile ends the wait early, also with a time limit.
  *
- * @param[in] microseconds Time limit to wait for an interrupt in microseconds.
+ * @param[in] microseconds Time limit to wait for an interrupt in microseconds or PORT_WAIT_FOREVER_US.
  * @return CHIPINTERFACE_SUCCESS if an interrupt occurs, or CHIPINTERFACE_FAILURE if a timeout occurs.
  */
 chipinterface_error_t chipinterface_wait_for_interrupt(uint32_t microseconds)
 {
     uint32_t wait;
-    if(microseconds != portMAX_DELAY)
+    BaseType_t taken;
+    gStarted = true;
+    if(microseconds != PORT_WAIT_FOREVER_US)
     {
-        uint32_t millisecs = (uint32_t)(microseconds/1000);
-        if(!millisecs)
-        {
-            millisecs = 1;
-        }
-        wait  = pdMS_TO_TICKS(millisecs);
+        // in 64 bits, the idle and heartbeat waits of the sensor task last up to minutes
+        uint64_t ticks = (uint64_t)microseconds * configTICK_RATE_HZ / 1000000;
+
+        wait = ticks ? (uint32_t)ticks : 1;
     }
     else
     {
-        wait = microseconds;
-        gStarted = true;
-
+        wait = portMAX_DELAY;
     }
-    if(xSemaphoreTake(irqSem, wait))
+    taken = xSemaphoreTake(irqSem, wait);
+    TRACE_RECORD(TRACE_SEM_TAKE, TRACE_SEM_IRQ, taken == pdTRUE);
+    if(taken)
     {
         if(gEvents & CI_EVENTS_IRQ)
         {
@@ -430,3 +486,78 @@ chipinterface_error_t chipinterface_wait_for_interrupt(uint32_t microseconds)
     }
     return CHIPINTERFACE_FAILURE;
 }
+
+/**
+ * @brief Wait for a sensor interrupt or a wake-up.
+ *
+ * Same as chipinterface_wait_for_interrupt(), but chipinterface_wake() ends the wait early as
+ * well. Used by the owner of the sensor to wait for the next frame and for new requests at the
+ * same time. A wake-up that arrives while no such wait is pending ends the next one right away.
+ * Waits of the sensor driver are never woken.
+ *
+ * @param[in] microseconds Time limit to wait for an interrupt in microseconds or PORT_WAIT_FOREVER_US.
+ * @return CHIPINTERFACE_SUCCESS if an interrupt occurs, or CHIPINTERFACE_FAILURE on timeout or wake-up.
+ */
+chipinterface_error_t chipinterface_wait_for_interrupt_or_wake(uint32_t microseconds)
+{
+    chipinterface_error_t status;
+    bool woken;
+
+    taskENTER_CRITICAL();
+    woken = (gEvents & CI_EVENTS_WAKE) != 0;
+    gEvents &= ~CI_EVENTS_WAKE;
+    gWakeable = !woken;
+    taskEXIT_CRITICAL();
+    if(woken)
+    {
+        return CHIPINTERFACE_FAILURE;
+    }
+
+    status = chipinterface_wait_for_interrupt(microseconds);
+
+    taskENTER_CRITICAL();
+    // A wake-up given after the wait ended must not end a later wait of the driver
+    if((gEvents & CI_EVENTS_WAKE) && !gWakeable && !(gEvents & CI_EVENTS_IRQ))
+    {
+        xSemaphoreTake(irqSem, 0);
+    }
+    gEvents &= ~CI_EVENTS_WAKE;
+    gWakeable = false;
+    taskEXIT_CRITICAL();
+    return status;
+}
+
+/**
+ * @brief Wake the sensor owner.
+ *
+ * Ends a pending chipinterface_wait_for_interrupt_or_wake(), or the next one if none is
+ * pending. Does not block and may be called from any task.
+ */
+void chipinterface_wake(void)
+{
+    taskENTER_CRITICAL();
+    gEvents |= CI_EVENTS_WAKE;
+    if(gWakeable)
+    {
+        gWakeable = false;
+        TRACE_RECORD(TRACE_SEM_GIVE, TRACE_SEM_IRQ, 0);
+        xSemaphoreGive(irqSem);
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Select the edges of the sensor interrupt line that raise an interrupt.
+ *
+ * @param[in] both_edges true for both edges, false for the rising edge only.
+ */
+void chipinterface_set_interrupt_edges(bool both_edges)
+{
+    nrf_drv_gpiote_in_config_t in_config = both_edges ? GPIOTE_CONFIG_IN_SENSE_TOGGLE(true) :
+                                                        GPIOTE_CONFIG_IN_SENSE_LOTOHI(true);
+
+    in_config.pull = NRF_GPIO_PIN_PULLUP;
+    nrf_drv_gpiote_in_uninit(CONFIG_GPIO_X4_IRQ_0);
+    nrf_drv_gpiote_in_init(CONFIG_GPIO_X4_IRQ_0, &in_config, gpio_irq_callback);
+    nrf_drv_gpiote_in_event_enable(CONFIG_GPIO_X4_IRQ_0, true);
+}
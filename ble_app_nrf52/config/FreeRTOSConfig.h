@@ -63,7 +63,7 @@
 #define configTICK_RATE_HZ                                                        1024
 #define configMAX_PRIORITIES                                                      ( 3 )
 #define configMINIMAL_STACK_SIZE                                                  ( 60 )
-#define configTOTAL_HEAP_SIZE                                                     ( 9216 )
+#define configTOTAL_HEAP_SIZE                                                     ( 10240 )
 #define configMAX_TASK_NAME_LEN                                                   ( 4 )
 #define configUSE_16_BIT_TICKS                                                    0
 #define configIDLE_SHOULD_YIELD                                                   1
@@ -80,12 +80,21 @@
 /* Hook function related definitions. */
 #define configUSE_IDLE_HOOK 0
 #define configUSE_TICK_HOOK                                                       0
+#ifdef INSTRUMENTATION
+#define configCHECK_FOR_STACK_OVERFLOW                                            2
+#else
 #define configCHECK_FOR_STACK_OVERFLOW                                            0
+#endif
 #define configUSE_MALLOC_FAILED_HOOK                                              0
 
 /* Run time and task stats gathering related definitions. */
+#ifdef INSTRUMENTATION
+#define configGENERATE_RUN_TIME_STATS                                             1
+#define configUSE_TRACE_FACILITY                                                  1
+#else
 #define configGENERATE_RUN_TIME_STATS                                             0
 #define configUSE_TRACE_FACILITY                                                  0
+#endif
 #define configUSE_STATS_FORMATTING_FUNCTIONS                                      0
 
 /* Co-routine definitions. */
@@ -96,7 +105,12 @@
 #define configUSE_TIMERS 1
 #define configTIMER_TASK_PRIORITY                                                 ( 2 )
 #define configTIMER_QUEUE_LENGTH                                                  32
+/* The energy estimate computes and logs its report in the timer task */
+#ifdef ENERGY_ESTIMATE
+#define configTIMER_TASK_STACK_DEPTH                                              ( 160 )
+#else
 #define configTIMER_TASK_STACK_DEPTH                                              ( 80 )
+#endif
 
 /* Tickless Idle configuration. */
 #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP                                     2
@@ -189,6 +203,19 @@ standard names - or at least those used in the unmodified vector table. */
         #include <stdint.h>
         extern uint32_t SystemCoreClock;
     #endif
+
+    /* Run time counter and sleep accounting of the instrumentation build, see instrumentation.c */
+    #ifdef INSTRUMENTATION
+        #include <stdint.h>
+        extern void instrumentation_start_counter(void);
+        extern uint32_t instrumentation_get_time_us(void);
+        extern void instrumentation_pre_sleep(void);
+        extern void instrumentation_post_sleep(void);
+        #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    instrumentation_start_counter()
+        #define portGET_RUN_TIME_COUNTER_VALUE()            instrumentation_get_time_us()
+        #define configPRE_SLEEP_PROCESSING(x)               instrumentation_pre_sleep()
+        #define configPOST_SLEEP_PROCESSING(x)              instrumentation_post_sleep()
+    #endif
 #endif /* !assembler */
 
 /** Implementation note:  Use this with caution and set this to 1 ONLY for debugging
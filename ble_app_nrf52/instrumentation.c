@@ -0,0 +1,393 @@
+/**
+ * @file instrumentation.c
+ * @brief Runtime instrumentation of the tasks, the stacks and the idle sleep.
+ *
+ * The run time counter is RTC2 at 32.768 kHz converted to microseconds. Unlike the cycle counter
+ * it keeps counting while the CPU sleeps and costs no current, so an instrumented build still
+ * shows idle power regressions. Its resolution is 30.5 us, the CPU time of a task is the sum of
+ * many such samples. The counter is 24 bits wide and extended in software, which needs a read at
+ * least every 512 seconds. The RTC2 interrupt reads it twice per period, at the overflow and at
+ * half of the period, so the time stays right whichever of the instrumentation, the energy
+ * estimate and the trace recorder is built in, and however rarely they read it.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include "nrf.h"
+#include "app_error.h"
+#include "app_util_platform.h"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+#include "novelda_sensor.h"
+#include "instrumentation.h"
+
+typedef struct
+{
+    char     name[DIAGNOSTICS_TASK_NAME_LEN + 1];
+    uint32_t cpu_us;
+    uint16_t stack_free;
+} taskStats_t;
+
+typedef struct
+{
+    uint8_t     flags;
+    uint32_t    window_us;
+    uint32_t    wakeups;
+    uint32_t    sleep_us;
+    uint8_t     task_count;
+    taskStats_t tasks[INSTRUMENTATION_MAX_TASKS];
+} report_t;
+
+static report_t gReport;
+
+#define RTC_COUNTER_MASK        0x00FFFFFF
+#define RTC_FREQUENCY_SHIFT     15          // 32768 Hz
+#define RTC_HALF_PERIOD         0x00800000
+
+static uint64_t gRtcTicks;
+static uint32_t gRtcLast;
+static bool gRtcStarted;
+
+/**
+ * @brief Start the run time counter.
+ *
+ * Called by the kernel when the scheduler starts and by the trace recorder, which uses the
+ * counter for its timestamps. The LFCLK is already running for the SoftDevice. The overflow and
+ * the compare at half of the period wake the CPU twice every 512 seconds.
+ */
+void instrumentation_start_counter(void)
+{
+    // the prescaler can only be written while the RTC is stopped
+    if(!gRtcStarted)
+    {
+        gRtcStarted = true;
+        NRF_RTC2->PRESCALER = 0;
+        NRF_RTC2->CC[0] = RTC_HALF_PERIOD;
+        NRF_RTC2->INTENSET = RTC_INTENSET_OVRFLW_Msk | RTC_INTENSET_COMPARE0_Msk;
+        NVIC_SetPriority(RTC2_IRQn, APP_IRQ_PRIORITY_LOWEST);
+        NVIC_ClearPendingIRQ(RTC2_IRQn);
+        NVIC_EnableIRQ(RTC2_IRQn);
+        NRF_RTC2->TASKS_START = 1;
+    }
+}
+
+/**
+ * @brief RTC2 interrupt, at the overflow and at half of the period of the counter.
+ *
+ * Reads the counter so that the extension never misses an overflow.
+ */
+void RTC2_IRQHandler(void)
+{
+    NRF_RTC2->EVENTS_OVRFLW = 0;
+    NRF_RTC2->EVENTS_COMPARE[0] = 0;
+    // read back so the events are cleared before the handler returns
+    (void)NRF_RTC2->EVENTS_COMPARE[0];
+    (void)instrumentation_get_time_us();
+}
+
+/**
+ * @brief Get the time of the run time counter.
+ *
+ * Called by the kernel on every context switch and from the idle sleep, in any context.
+ *
+ * @return Time in microseconds, wraps after 71 minutes.
+ */
+uint32_t instrumentation_get_time_us(void)
+{
+    UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    uint32_t counter = NRF_RTC2->COUNTER;
+    uint64_t ticks;
+
+    gRtcTicks += (counter - gRtcLast) & RTC_COUNTER_MASK;
+    gRtcLast = counter;
+    ticks = gRtcTicks;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    return (uint32_t)((ticks * 1000000) >> RTC_FREQUENCY_SHIFT);
+}
+
+#ifdef INSTRUMENTATION
+
+/* Written by the idle task with interrupts disabled */
+static volatile uint32_t gWakeups;
+static volatile uint32_t gSleepUs;
+static volatile uint32_t gWakeupsTotal;
+static volatile uint32_t gSleepUsTotal;
+static uint32_t gSleepStartUs;
+static uint32_t gWindowStartUs;
+/* Run time counters at the end of the last window, by task number */
+static UBaseType_t gLastNumber[INSTRUMENTATION_MAX_TASKS];
+static uint32_t gLastRunTime[INSTRUMENTATION_MAX_TASKS];
+static UBaseType_t gLastCount;
+static TaskStatus_t gStatus[INSTRUMENTATION_MAX_TASKS];
+static TimerHandle_t windowTimer;
+
+
+/**
+ * @brief Called by the tickless idle before the CPU sleeps, with interrupts disabled.
+ */
+void instrumentation_pre_sleep(void)
+{
+    gSleepStartUs = instrumentation_get_time_us();
+}
+
+/**
+ * @brief Called by the tickless idle after the CPU woke up, with interrupts disabled.
+ */
+void instrumentation_post_sleep(void)
+{
+    uint32_t sleep_us = instrumentation_get_time_us() - gSleepStartUs;
+
+    gSleepUs += sleep_us;
+    gSleepUsTotal += sleep_us;
+    gWakeups++;
+    gWakeupsTotal++;
+}
+
+/**
+ * @brief Called by the kernel when it finds the stack of a task overflowed.
+ *
+ * @param[in] task Task handle.
+ * @param[in] name Task name.
+ */
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name)
+{
+    UNUSED_PARAMETER(task);
+    NRF_LOG_ERROR("Stack overflow in task %s", NRF_LOG_PUSH(name));
+    NRF_LOG_FINAL_FLUSH();
+    APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+}
+
+/**
+ * @brief Collect the CPU time and stack high-water mark of every task.
+ *
+ * @param[out] report Report of the window.
+ */
+static void collect_tasks(report_t *report)
+{
+    UBaseType_t count = uxTaskGetSystemState(gStatus, INSTRUMENTATION_MAX_TASKS, NULL);
+
+    // 0 if there are more tasks than INSTRUMENTATION_MAX_TASKS
+    if(count == 0)
+    {
+        report->task_count = 0;
+        return;
+    }
+    report->flags |= DIAGNOSTICS_FLAG_STACK | DIAGNOSTICS_FLAG_CPU;
+    report->task_count = (uint8_t)count;
+    for(UBaseType_t i = 0; i < count; i++)
+    {
+        taskStats_t *task = &report->tasks[i];
+        uint32_t last = 0;
+
+        for(UBaseType_t j = 0; j < gLastCount; j++)
+        {
+            if(gLastNumber[j] == gStatus[i].xTaskNumber)
+            {
+                last = gLastRunTime[j];
+                break;
+            }
+        }
+        memset(task->name, 0, sizeof(task->name));
+        strncpy(task->name, gStatus[i].pcTaskName, DIAGNOSTICS_TASK_NAME_LEN);
+        task->cpu_us = gStatus[i].ulRunTimeCounter - last;
+        task->stack_free = gStatus[i].usStackHighWaterMark;
+    }
+    for(UBaseType_t i = 0; i < count; i++)
+    {
+        gLastNumber[i] = gStatus[i].xTaskNumber;
+        gLastRunTime[i] = gStatus[i].ulRunTimeCounter;
+    }
+    gLastCount = count;
+}
+
+/**
+ * @brief Print a report on the UART.
+ *
+ * @param[in] report Report of the window.
+ */
+static void print_report(const report_t *report)
+{
+    uint32_t window_ms = report->window_us / 1000;
+    sensor_health_t health;
+
+    if(window_ms == 0)
+    {
+        return;
+    }
+    sensor_get_health(&health);
+    NRF_LOG_INFO("Diagnostics: %u wake-ups/s, asleep %u permille of %u ms",
+                 report->wakeups * 1000 / window_ms, report->sleep_us / window_ms, window_ms);
+    NRF_LOG_INFO("Sensor: %u failures, %u recoveries, downtime %u ms, last %u ms%s",
+                 health.failures, health.recoveries, health.downtime_ms, health.last_downtime_ms,
+                 health.recovering ? ", recovering" : "");
+    for(uint8_t i = 0; i < report->task_count; i++)
+    {
+        NRF_LOG_INFO("Task %s: CPU %u us, %u permille, stack free %u words",
+                     report->tasks[i].name, report->tasks[i].cpu_us,
+                     report->tasks[i].cpu_us / window_ms, report->tasks[i].stack_free);
+    }
+}
+
+/**
+ * @brief Callback at the end of every statistics window.
+ *
+ * @param[in] timer Timer handle.
+ */
+static void clkWindowCallback(TimerHandle_t timer)
+{
+    report_t *report = &gReport;
+    uint32_t now_us = instrumentation_get_time_us();
+    uint32_t wakeups;
+    uint32_t sleep_us;
+
+    (void)timer;
+    taskENTER_CRITICAL();
+    wakeups = gWakeups;
+    sleep_us = gSleepUs;
+    gWakeups = 0;
+    gSleepUs = 0;
+    taskEXIT_CRITICAL();
+
+    // readers are tasks, they do not run while the report changes
+    vTaskSuspendAll();
+    report->flags = DIAGNOSTICS_FLAG_SLEEP;
+    report->window_us = now_us - gWindowStartUs;
+    report->wakeups = wakeups;
+    report->sleep_us = sleep_us;
+    collect_tasks(report);
+    (void)xTaskResumeAll();
+    gWindowStartUs = now_us;
+
+    print_report(report);
+}
+
+/**
+ * @brief Get the wake-ups and the time asleep since the start.
+ *
+ * The counters wrap, differences of two readings are valid across a wrap.
+ *
+ * @param[out] wakeups  Wake-ups from sleep.
+ * @param[out] sleep_us Time asleep in microseconds.
+ * @return true, the counters are available.
+ */
+bool instrumentation_get_sleep_totals(uint32_t *wakeups, uint32_t *sleep_us)
+{
+    taskENTER_CRITICAL();
+    *wakeups = gWakeupsTotal;
+    *sleep_us = gSleepUsTotal;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+/**
+ * @brief Start the statistics windows.
+ */
+void instrumentation_init(void)
+{
+    gWindowStartUs = instrumentation_get_time_us();
+    windowTimer = xTimerCreate("DIAG",
+                               pdMS_TO_TICKS(INSTRUMENTATION_WINDOW_MS),
+                               pdTRUE,
+                               NULL,
+                               clkWindowCallback);
+    if(windowTimer == NULL || xTimerStart(windowTimer, 0) != pdPASS)
+    {
+        NRF_LOG_INFO("Instrumentation not available");
+    }
+}
+
+#else
+
+/**
+ * @brief Nothing to start without INSTRUMENTATION.
+ */
+void instrumentation_init(void)
+{
+}
+
+/**
+ * @brief The sleep is not counted without INSTRUMENTATION.
+ *
+ * @param[out] wakeups  Set to 0.
+ * @param[out] sleep_us Set to 0.
+ * @return false, the counters are not available.
+ */
+bool instrumentation_get_sleep_totals(uint32_t *wakeups, uint32_t *sleep_us)
+{
+    *wakeups = 0;
+    *sleep_us = 0;
+    return false;
+}
+
+#endif // INSTRUMENTATION
+
+/**
+ * @brief Store a little endian 32 bit value.
+ *
+ * @param[out] p     Destination.
+ * @param[in]  value Value to store.
+ * @return Position after the value.
+ */
+static uint8_t *put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+/**
+ * @brief Encode the Diagnostics characteristic value.
+ *
+ * Holds the statistics of the last complete window and the sensor watchdog statistics since the
+ * start, see instrumentation.h for the format.
+ *
+ * @param[out] value  Buffer for the value.
+ * @param[in]  maxLen Size of the buffer, at least DIAGNOSTICS_HEADER_SIZE.
+ * @return Length of the value, 0 if the buffer is too small.
+ */
+uint16_t instrumentation_get_value(uint8_t *value, uint16_t maxLen)
+{
+    uint8_t *p = value;
+    uint8_t count;
+    sensor_health_t health;
+
+    if(maxLen < DIAGNOSTICS_HEADER_SIZE)
+    {
+        return 0;
+    }
+    sensor_get_health(&health);
+    taskENTER_CRITICAL();
+    count = gReport.task_count;
+    if(count > (maxLen - DIAGNOSTICS_HEADER_SIZE) / DIAGNOSTICS_TASK_SIZE)
+    {
+        count = (maxLen - DIAGNOSTICS_HEADER_SIZE) / DIAGNOSTICS_TASK_SIZE;
+    }
+    *p++ = DIAGNOSTICS_VALUE_VERSION;
+    *p++ = gReport.flags | (health.recovering ? DIAGNOSTICS_FLAG_RECOVERING : 0);
+    p = put_u32(p, gReport.window_us);
+    p = put_u32(p, gReport.wakeups);
+    p = put_u32(p, gReport.sleep_us);
+    p = put_u32(p, health.failures);
+    p = put_u32(p, health.recoveries);
+    p = put_u32(p, health.downtime_ms);
+    p = put_u32(p, health.last_downtime_ms);
+    *p++ = count;
+    for(uint8_t i = 0; i < count; i++)
+    {
+        memcpy(p, gReport.tasks[i].name, DIAGNOSTICS_TASK_NAME_LEN);
+        p += DIAGNOSTICS_TASK_NAME_LEN;
+        p = put_u32(p, gReport.tasks[i].cpu_us);
+        *p++ = (uint8_t)gReport.tasks[i].stack_free;
+        *p++ = (uint8_t)(gReport.tasks[i].stack_free >> 8);
+    }
+    taskEXIT_CRITICAL();
+
+    return (uint16_t)(p - value);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file instrumentation.h
+ * @brief Runtime instrumentation of the tasks, the stacks and the idle sleep.
+ *
+ * Built with INSTRUMENTATION defined, the kernel accounts the CPU time of every task on a
+ * microsecond counter and checks the stacks, and the tickless idle reports every sleep. At the
+ * end of every window of INSTRUMENTATION_WINDOW_MS the statistics of the window are printed on
+ * the UART and kept for the Diagnostics characteristic. Without INSTRUMENTATION the
+ * characteristic only reports that no statistics are available.
+ */
+
+#ifndef INSTRUMENTATION_H_
+#define INSTRUMENTATION_H_
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define INSTRUMENTATION_WINDOW_MS   10000   // statistics window
+#define INSTRUMENTATION_MAX_TASKS   10      // tasks reported, more tasks disable the task statistics
+
+/* Diagnostics characteristic value: version, flags, uint32 window in us, uint32 wake-ups in the
+ * window, uint32 time asleep in the window in us, uint32 sensor failures, uint32 sensor
+ * recoveries, uint32 total and uint32 last sensor downtime in ms, task count, then per task the
+ * name padded with 0 to DIAGNOSTICS_TASK_NAME_LEN characters, uint32 CPU time in the window in us
+ * and uint16 stack high-water mark in words, little endian. The sensor statistics count from the
+ * start, see sensor_get_health(), and are valid in every build. */
+#define DIAGNOSTICS_VALUE_VERSION   2
+#define DIAGNOSTICS_HEADER_SIZE     31
+#define DIAGNOSTICS_TASK_NAME_LEN   4
+#define DIAGNOSTICS_TASK_SIZE       (DIAGNOSTICS_TASK_NAME_LEN + 6)
+#define DIAGNOSTICS_VALUE_MAX_SIZE  (DIAGNOSTICS_HEADER_SIZE + INSTRUMENTATION_MAX_TASKS * DIAGNOSTICS_TASK_SIZE)
+
+#define DIAGNOSTICS_FLAG_SLEEP      0x01    // wake-ups and time asleep are valid
+#define DIAGNOSTICS_FLAG_STACK      0x02    // the tasks and their stack high-water marks are valid
+#define DIAGNOSTICS_FLAG_CPU        0x04    // the CPU times of the tasks are valid
+#define DIAGNOSTICS_FLAG_RECOVERING 0x08    // the sensor task is recovering the sensor
+
+extern void instrumentation_init(void);
+extern uint16_t instrumentation_get_value(uint8_t *value, uint16_t maxLen);
+extern bool instrumentation_get_sleep_totals(uint32_t *wakeups, uint32_t *sleep_us);
+
+/* Kernel hooks, see FreeRTOSConfig.h. The counter is also the time base of the trace recorder. */
+extern void instrumentation_start_counter(void);
+extern uint32_t instrumentation_get_time_us(void);
+extern void instrumentation_pre_sleep(void);
+extern void instrumentation_post_sleep(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INSTRUMENTATION_H_ */
@@ -33,6 +33,7 @@
 #include "task.h"
 #include "timers.h"
 #include "semphr.h"
+#include "queue.h"
 #include "fds.h"
 #include "ble_conn_state.h"
 #include "nrf_drv_clock.h"
@@ -49,6 +50,10 @@
 #include <novelda_chipinterface.h>
 #include "novelda_sensor.h"
 #include "proximity.h"
+#include "settings.h"
+#include "instrumentation.h"
+#include "energy.h"
+#include "boot.h"
 
 #define DEVICE_NAME                         "Proximity"                             /**< Name of device. Will be included in the advertising data. */
 #define MANUFACTURER_NAME                   "Novelda"                               /**< Manufacturer. Will be passed to Device Information Service. */
@@ -97,8 +102,12 @@ BLE_ADVERTISING_DEF(m_advertising);                                 /**< Adverti
 
 static TaskHandle_t m_proximity_task;
 static TaskHandle_t m_sensor_task;
-SemaphoreHandle_t appSemHandle;
+QueueHandle_t appQueueHandle;
 void ble_proximity_service_on_detection_evt(uint8_t detection);
+void ble_proximity_service_on_zones_evt(uint8_t zones);
+void ble_proximity_service_on_motion_evt(const uint8_t *motion, uint16_t len);
+void ble_proximity_service_on_detector_evt(void);
+void ble_proximity_service_on_config_evt(void);
 extern void sensor_run_thread(void * pvParameter);
 
 static uint16_t m_conn_handle         = BLE_CONN_HANDLE_INVALID;    /**< Handle of the current connection. */
@@ -117,6 +126,7 @@ static TimerHandle_t m_battery_timer;                               /**< Definit
 
 #if NRF_LOG_ENABLED
 static TaskHandle_t m_logger_thread;                                /**< Definition of Logger thread. */
+static volatile bool m_log_pending;                                 /**< Logger thread was woken and has not flushed yet. */
 #endif
 
 static void advertising_start(void * p_erase_bonds);
@@ -438,6 +448,7 @@ static void on_adv_evt(ble_adv_evt_t ble_adv_evt)
     {
         case BLE_ADV_EVT_FAST:
             NRF_LOG_INFO("Fast advertising.");
+            boot_mark(BOOT_ADVERTISING);
             err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
             APP_ERROR_CHECK(err_code);
             break;
@@ -470,11 +481,19 @@ static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
             m_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
             err_code = nrf_ble_qwr_conn_handle_assign(&m_qwr, m_conn_handle);
             APP_ERROR_CHECK(err_code);
+            energy_set_connection(true,
+                                  p_ble_evt->evt.gap_evt.params.connected.conn_params.max_conn_interval * UNIT_1_25_MS);
             break;
 
         case BLE_GAP_EVT_DISCONNECTED:
             NRF_LOG_INFO("Disconnected");
             m_conn_handle = BLE_CONN_HANDLE_INVALID;
+            energy_set_connection(false, 0);
+            break;
+
+        case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+            energy_set_connection(true,
+                                  p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval * UNIT_1_25_MS);
             break;
 
         case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
@@ -509,7 +528,6 @@ static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
             // No implementation needed.
             break;
     }
-    vTaskResume(m_logger_thread);
 }
 
 
@@ -580,7 +598,6 @@ static void bsp_event_handler(bsp_event_t event)
         default:
             break;
     }
-    vTaskResume(m_logger_thread);
 }
 
 
@@ -708,7 +725,9 @@ static void advertising_start(void * p_erase_bonds)
 /**@brief Thread for handling the logger.
  *
  * @details This thread is responsible for processing log entries if logs are deferred.
- *          Thread flushes all log entries and suspends. It is resumed by idle task hook.
+ *          NRF_LOG only stores the format string and the arguments of every entry, this thread
+ *          formats and prints them. It runs at idle priority and sleeps until log_pending_hook()
+ *          wakes it, so logging neither delays the other tasks nor wakes the CPU periodically.
  *
  * @param[in]   arg   Pointer used for passing some arbitrary information (context) from the
  *                    osThreadCreate() call to the thread.
@@ -719,32 +738,36 @@ static void logger_thread(void * arg)
 
     while (1)
     {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        m_log_pending = false;
         NRF_LOG_FLUSH();
-
-        //vTaskSuspend(NULL); // Suspend myself
-        vTaskDelay(pdMS_TO_TICKS(500));
     }
 }
 #endif //NRF_LOG_ENABLED
 
 #if NRF_LOG_ENABLED && NRF_LOG_DEFERRED
+ /**@brief Called by NRF_LOG for every new log entry.
+  *
+  * @details Wakes the logger thread once per burst of entries, entries logged before it
+  *          flushed are printed in the same run.
+  */
  void log_pending_hook( void )
  {
-     BaseType_t result = pdFAIL;
+    if ( m_log_pending || m_logger_thread == NULL )
+    {
+        return;
+    }
+    m_log_pending = true;
 
     if ( __get_IPSR() != 0 )
     {
         BaseType_t higherPriorityTaskWoken = pdFALSE;
-        result = xTaskNotifyFromISR( m_logger_thread, 0, eSetValueWithoutOverwrite, &higherPriorityTaskWoken );
-
-        if ( pdFAIL != result )
-        {
+        vTaskNotifyGiveFromISR( m_logger_thread, &higherPriorityTaskWoken );
         portYIELD_FROM_ISR( higherPriorityTaskWoken );
-        }
     }
     else
     {
-        UNUSED_RETURN_VALUE(xTaskNotify( m_logger_thread, 0, eSetValueWithoutOverwrite ));
+        UNUSED_RETURN_VALUE(xTaskNotifyGive( m_logger_thread ));
     }
  }
 #endif
@@ -763,12 +786,18 @@ static void clock_init(void)
 static void proximity_task(void * pvParameter)
 {
     UNUSED_PARAMETER(pvParameter);
-    ble_proximity_service_init(&m_occu, appSemHandle, ble_proximity_service_on_detection_evt);
+    proximityEvent_t event;
+
+    ble_proximity_service_init(&m_occu, appQueueHandle, ble_proximity_service_on_detection_evt);
+    setZoneCallback(ble_proximity_service_on_zones_evt);
+    setMotionCallback(ble_proximity_service_on_motion_evt);
+    setDetectorCallback(ble_proximity_service_on_detector_evt);
+    setConfigCallback(ble_proximity_service_on_config_evt);
     for(;;)
     {
-        if(pdTRUE == xSemaphoreTake(appSemHandle, portMAX_DELAY))
+        if(pdTRUE == xQueueReceive(appQueueHandle, &event, portMAX_DELAY))
         {
-            processSensorEvent();
+            processSensorEvent(&event);
         }
     }
 }
@@ -786,6 +815,32 @@ void ble_proximity_service_on_detection_evt(uint8_t detection)
 }
 
 
+void ble_proximity_service_on_zones_evt(uint8_t zones)
+{
+    ble_proximity_service_zones_update(&m_occu, zones);
+    NRF_LOG_INFO("zones EVNT. Zones: 0x%02X", zones);
+}
+
+
+void ble_proximity_service_on_motion_evt(const uint8_t *motion, uint16_t len)
+{
+    ble_proximity_service_motion_update(&m_occu, motion, len);
+    NRF_LOG_INFO("motion EVNT. Direction: %d", motion[0]);
+}
+
+
+void ble_proximity_service_on_detector_evt(void)
+{
+    ble_proximity_service_detector_refresh(&m_occu);
+}
+
+
+void ble_proximity_service_on_config_evt(void)
+{
+    ble_proximity_service_config_refresh(&m_occu);
+}
+
+
 /**@brief Function for application main entry.
  */
 int main(void)
@@ -801,14 +856,15 @@ int main(void)
 
 #if NRF_LOG_ENABLED
     // Start execution.
-    if (pdPASS != xTaskCreate(logger_thread, "LOG", 256, NULL, 1, &m_logger_thread))
+    if (pdPASS != xTaskCreate(logger_thread, "LOG", 256, NULL, tskIDLE_PRIORITY, &m_logger_thread))
     {
         APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
     }
 #endif
 
-    appSemHandle = xSemaphoreCreateBinary();
-    if (pdPASS != xTaskCreate(proximity_task, "OCC", 64, NULL, 1, &m_proximity_task))
+    appQueueHandle = xQueueCreate(PROXIMITY_EVENT_QUEUE_LENGTH, sizeof(proximityEvent_t));
+    // loads and saves the settings through FDS and encodes the characteristic values
+    if (pdPASS != xTaskCreate(proximity_task, "OCC", 256, NULL, 1, &m_proximity_task))
     {
         APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
     }
@@ -829,6 +885,13 @@ int main(void)
     gap_params_init();
     gatt_init();
     advertising_init();
+    // FDS is shared with the peer manager, the settings are restored by the proximity task
+    if (!settings_init())
+    {
+        NRF_LOG_INFO("Settings storage not available");
+    }
+    instrumentation_init();
+    energy_init();
     services_init();
     sensor_simulator_init();
     conn_params_init();
@@ -11,6 +11,9 @@
 
 #include "proximity.h"
 #include "proximity_service.h"
+#include "instrumentation.h"
+#include "trace.h"
+#include "energy.h"
 #include <string.h>
 #include "sdk_common.h"
 #include "ble_srv_common.h"
@@ -22,6 +25,11 @@ static uint8_t proximityProfile_DetectionUserDesc[] = "Detection";
 static uint8_t proximityProfile_RangeUserDesc[] = "Range";
 static uint8_t proximityProfile_SensitivityUserDesc[] = "Sensitivity";
 static uint8_t proximityProfile_TimeoutUserDesc[] = "Timeout";
+static uint8_t proximityProfile_DetectorUserDesc[] = "Detector";
+static uint8_t proximityProfile_ZonesUserDesc[] = "Zones";
+static uint8_t proximityProfile_MotionUserDesc[] = "Motion";
+static uint8_t proximityProfile_ConfigUserDesc[] = "Config";
+static uint8_t proximityProfile_DiagnosticsUserDesc[] = "Diagnostics";
 
 
 /**
@@ -67,6 +75,95 @@ static ret_code_t proximity_char_add(ble_proximity_service_t* p_occu)
 
 }
 
+/**
+ * @brief Function for adding the Zones characteristic.
+ *
+ * This function initializes the characteristic for the occupied distance zones. Writing a
+ * zones value sets the zones, see ble_proximity_service_zones_write().
+ *
+ * @param[in] p_occu Pointer to the proximity Service structure.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+static ret_code_t zones_char_add(ble_proximity_service_t* p_occu)
+{
+    uint8_t init_zones = getZoneValue();
+    ble_add_char_params_t char_params;
+    memset(&char_params, 0, sizeof(ble_add_char_params_t));
+
+    // Set the required parameters
+    char_params.uuid_type = BLE_UUID_TYPE_BLE;
+    char_params.uuid = BLE_UUID_ZONES_CHAR;
+    char_params.char_props.read = 1;
+    char_params.char_props.write = 1;
+    char_params.char_props.notify = 1;
+    char_params.read_access = SEC_OPEN;
+    char_params.write_access = SEC_OPEN;
+    char_params.cccd_write_access = SEC_OPEN;
+    char_params.is_var_len = true;
+    char_params.max_len = ZONES_VALUE_MAX_SIZE;
+    char_params.init_len = sizeof(uint8_t);
+    char_params.p_init_value = &init_zones;
+
+    ble_add_char_user_desc_t user_desc;
+    memset(&user_desc, 0, sizeof(ble_add_char_user_desc_t));
+    user_desc.max_size = sizeof(proximityProfile_ZonesUserDesc);
+    user_desc.size = sizeof(proximityProfile_ZonesUserDesc);
+    user_desc.p_char_user_desc = proximityProfile_ZonesUserDesc;
+    user_desc.char_props.read = 1;
+    user_desc.read_access = SEC_OPEN;
+
+    char_params.p_user_descr = &user_desc;
+
+    return characteristic_add(p_occu->service_handle,
+                              &char_params,
+                              &p_occu->zones_handles);
+}
+
+/**
+ * @brief Function for adding the Motion characteristic.
+ *
+ * This function initializes the characteristic for the direction, distance and radial velocity
+ * of the tracked target. Writing MOTION_TRACKING_ON or MOTION_TRACKING_OFF enables or disables
+ * the tracking, see ble_proximity_service_motion_write().
+ *
+ * @param[in] p_occu Pointer to the proximity Service structure.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+static ret_code_t motion_char_add(ble_proximity_service_t* p_occu)
+{
+    uint8_t init_motion[MOTION_VALUE_SIZE];
+    ble_add_char_params_t char_params;
+    memset(&char_params, 0, sizeof(ble_add_char_params_t));
+
+    // Set the required parameters
+    char_params.uuid_type = BLE_UUID_TYPE_BLE;
+    char_params.uuid = BLE_UUID_MOTION_CHAR;
+    char_params.char_props.read = 1;
+    char_params.char_props.write = 1;
+    char_params.char_props.notify = 1;
+    char_params.read_access = SEC_OPEN;
+    char_params.write_access = SEC_OPEN;
+    char_params.cccd_write_access = SEC_OPEN;
+    char_params.is_var_len = true;
+    char_params.max_len = MOTION_VALUE_SIZE;
+    char_params.init_len = getMotionValue(init_motion, sizeof(init_motion));
+    char_params.p_init_value = init_motion;
+
+    ble_add_char_user_desc_t user_desc;
+    memset(&user_desc, 0, sizeof(ble_add_char_user_desc_t));
+    user_desc.max_size = sizeof(proximityProfile_MotionUserDesc);
+    user_desc.size = sizeof(proximityProfile_MotionUserDesc);
+    user_desc.p_char_user_desc = proximityProfile_MotionUserDesc;
+    user_desc.char_props.read = 1;
+    user_desc.read_access = SEC_OPEN;
+
+    char_params.p_user_descr = &user_desc;
+
+    return characteristic_add(p_occu->service_handle,
+                              &char_params,
+                              &p_occu->motion_handles);
+}
+
 /**
  * @brief Function for adding the Range characteristic.
  *
@@ -193,17 +290,152 @@ static ret_code_t timeout_char_add(ble_proximity_service_t* p_occu)
                               &p_occu->timeout_handles);
 }
 
+/**
+ * @brief Function for adding the Detector characteristic.
+ *
+ * This function initializes the characteristic for the detector thresholds and M-of-N values.
+ * The value is variable length, see setDetectorValue() for the format. It stays empty until
+ * the first connection since the sensor is initialized in the background.
+ *
+ * @param[in] p_occu Pointer to the proximity Service structure.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+static ret_code_t detector_char_add(ble_proximity_service_t* p_occu)
+{
+    static uint8_t init_detector[DETECTOR_VALUE_MAX_SIZE];
+    ble_add_char_params_t char_params;
+    memset(&char_params, 0, sizeof(ble_add_char_params_t));
+
+    // Set the required parameters
+    char_params.uuid_type = BLE_UUID_TYPE_BLE;
+    char_params.uuid = BLE_UUID_DETECTOR_CHAR;
+    char_params.char_props.read = 1;
+    char_params.char_props.write = 1;
+    char_params.char_props.write_wo_resp = 1;
+    char_params.read_access = SEC_OPEN;
+    char_params.write_access = SEC_OPEN;
+    char_params.cccd_write_access = SEC_OPEN;
+    char_params.is_var_len = true;
+    char_params.max_len = DETECTOR_VALUE_MAX_SIZE;
+    char_params.init_len = 0;
+    char_params.p_init_value = init_detector;
+
+    ble_add_char_user_desc_t user_desc;
+    memset(&user_desc, 0, sizeof(ble_add_char_user_desc_t));
+    user_desc.max_size = sizeof(proximityProfile_DetectorUserDesc);
+    user_desc.size = sizeof(proximityProfile_DetectorUserDesc);
+    user_desc.p_char_user_desc = proximityProfile_DetectorUserDesc;
+    user_desc.char_props.read = 1;
+    user_desc.read_access = SEC_OPEN;
+
+    char_params.p_user_descr = &user_desc;
+
+    return characteristic_add(p_occu->service_handle,
+                              &char_params,
+                              &p_occu->detector_handles);
+}
+
+/**
+ * @brief Function for adding the Config characteristic.
+ *
+ * This function initializes the characteristic for the combined configuration, see
+ * setConfigValue() for the format. Reads are deferred and answered with the current
+ * configuration, see on_rw_authorize_request().
+ *
+ * @param[in] p_occu Pointer to the proximity Service structure.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+static ret_code_t config_char_add(ble_proximity_service_t* p_occu)
+{
+    static uint8_t init_config[CONFIG_VALUE_MAX_SIZE];
+    ble_add_char_params_t char_params;
+    memset(&char_params, 0, sizeof(ble_add_char_params_t));
+
+    // Set the required parameters
+    char_params.uuid_type = BLE_UUID_TYPE_BLE;
+    char_params.uuid = BLE_UUID_CONFIG_CHAR;
+    char_params.char_props.read = 1;
+    char_params.char_props.write = 1;
+    char_params.read_access = SEC_OPEN;
+    char_params.write_access = SEC_OPEN;
+    char_params.cccd_write_access = SEC_OPEN;
+    char_params.is_var_len = true;
+    char_params.is_defered_read = true;
+    char_params.max_len = CONFIG_VALUE_MAX_SIZE;
+    char_params.init_len = 0;
+    char_params.p_init_value = init_config;
+
+    ble_add_char_user_desc_t user_desc;
+    memset(&user_desc, 0, sizeof(ble_add_char_user_desc_t));
+    user_desc.max_size = sizeof(proximityProfile_ConfigUserDesc);
+    user_desc.size = sizeof(proximityProfile_ConfigUserDesc);
+    user_desc.p_char_user_desc = proximityProfile_ConfigUserDesc;
+    user_desc.char_props.read = 1;
+    user_desc.read_access = SEC_OPEN;
+
+    char_params.p_user_descr = &user_desc;
+
+    return characteristic_add(p_occu->service_handle,
+                              &char_params,
+                              &p_occu->config_handles);
+}
+
+/**
+ * @brief Function for adding the Diagnostics characteristic.
+ *
+ * This function initializes the characteristic for the runtime statistics of the
+ * instrumentation build, see instrumentation.h for the format. Reads are deferred and answered
+ * with the statistics of the last window, see on_rw_authorize_request().
+ * Writing TRACE_DUMP_COMMAND requests a dump of the event trace to the UART, see on_write().
+ *
+ * @param[in] p_occu Pointer to the proximity Service structure.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+static ret_code_t diagnostics_char_add(ble_proximity_service_t* p_occu)
+{
+    static uint8_t init_diagnostics[DIAGNOSTICS_VALUE_MAX_SIZE];
+    ble_add_char_params_t char_params;
+    memset(&char_params, 0, sizeof(ble_add_char_params_t));
+
+    // Set the required parameters
+    char_params.uuid_type = BLE_UUID_TYPE_BLE;
+    char_params.uuid = BLE_UUID_DIAGNOSTICS_CHAR;
+    char_params.char_props.read = 1;
+    char_params.char_props.write = 1;
+    char_params.read_access = SEC_OPEN;
+    char_params.write_access = SEC_OPEN;
+    char_params.is_var_len = true;
+    char_params.is_defered_read = true;
+    char_params.max_len = DIAGNOSTICS_VALUE_MAX_SIZE;
+    char_params.init_len = 0;
+    char_params.p_init_value = init_diagnostics;
+
+    ble_add_char_user_desc_t user_desc;
+    memset(&user_desc, 0, sizeof(ble_add_char_user_desc_t));
+    user_desc.max_size = sizeof(proximityProfile_DiagnosticsUserDesc);
+    user_desc.size = sizeof(proximityProfile_DiagnosticsUserDesc);
+    user_desc.p_char_user_desc = proximityProfile_DiagnosticsUserDesc;
+    user_desc.char_props.read = 1;
+    user_desc.read_access = SEC_OPEN;
+
+    char_params.p_user_descr = &user_desc;
+
+    return characteristic_add(p_occu->service_handle,
+                              &char_params,
+                              &p_occu->diagnostics_handles);
+}
+
 /**
  * @brief Function for initializing the custom proximity service.
  *
  * This function initializes the custom BLE service for the proximity sensor.
  *
  * @param[in] p_occu        Pointer to the proximity Service structure.
- * @param[in] ble_app_sem   Pointer to the BLE application semaphore.
+ * @param[in] ble_app_queue Event queue of the BLE application task, see proximityInit().
  * @param[in] updateSensCb  Callback function to update the sensor value.
  * @return NRF_SUCCESS if successful, otherwise an error code.
  */
-ret_code_t ble_proximity_service_init(ble_proximity_service_t* p_occu, void* ble_app_sem, updateSensorValueCb_t updateSensCb)
+ret_code_t ble_proximity_service_init(ble_proximity_service_t* p_occu, void* ble_app_queue, updateSensorValueCb_t updateSensCb)
 {
     ret_code_t err_code;
     ble_uuid_t service_uuid;
@@ -215,6 +447,8 @@ ret_code_t ble_proximity_service_init(ble_proximity_service_t* p_occu, void* ble
     // Initialize service structure
     p_occu->conn_handle = BLE_CONN_HANDLE_INVALID;
 
+    // Restores the saved settings, so the characteristics start with them
+    proximityInit(ble_app_queue, updateSensCb);
 
     BLE_UUID_BLE_ASSIGN(service_uuid, BLE_UUID_PROXIMITY_SERVICE);
 
@@ -255,7 +489,40 @@ ret_code_t ble_proximity_service_init(ble_proximity_service_t* p_occu, void* ble
         return err_code;
     }
 
-    proximityInit(ble_app_sem, updateSensCb);
+    // Add Detector Characteristic
+    err_code = detector_char_add(p_occu);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add Zones Characteristic
+    err_code = zones_char_add(p_occu);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add Motion Characteristic
+    err_code = motion_char_add(p_occu);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add Config Characteristic
+    err_code = config_char_add(p_occu);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Add Diagnostics Characteristic
+    err_code = diagnostics_char_add(p_occu);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
 
     return NRF_SUCCESS;
 }
@@ -295,24 +562,136 @@ ret_code_t ble_proximity_service_detection_update(ble_proximity_service_t* p_occ
         return err_code;
     }
 
+    // While disconnected only the value is kept, a connecting central reads it right away
+    if (p_occu->conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return NRF_SUCCESS;
+    }
+
     uint16_t len = sizeof(detection_value);
     ble_gatts_hvx_params_t hvx_params;
-    if (p_occu->conn_handle != BLE_CONN_HANDLE_INVALID)
+    memset(&hvx_params, 0, sizeof(hvx_params));
+    hvx_params.handle = p_occu->detection_value_handles.value_handle;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.p_data = &detection_value;
+    hvx_params.p_len  = &len;
+
+    err_code = sd_ble_gatts_hvx(p_occu->conn_handle, &hvx_params);
+    TRACE_RECORD(TRACE_NOTIFY, TRACE_CHAR_DETECTION, (uint16_t)err_code);
+    if (err_code == NRF_SUCCESS)
+    {
+        energy_add_notification();
+    }
+    return err_code;
+}
+
+/**
+ * @brief Function for updating the Zones characteristic.
+ *
+ * This function updates the zones characteristic and sends a notification.
+ *
+ * @param[in] p_occu       Pointer to the proximity Service structure.
+ * @param[in] zones_value  New zone value, bit n set if zone n is occupied.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+ret_code_t ble_proximity_service_zones_update(ble_proximity_service_t* p_occu, uint8_t zones_value)
+{
+    ret_code_t err_code;
+    ble_gatts_value_t gatts_value;
+    if (p_occu == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    // Initialize value struct.
+    memset(&gatts_value, 0, sizeof(gatts_value));
+
+    gatts_value.len     = sizeof(uint8_t);
+    gatts_value.offset  = 0;
+    gatts_value.p_value = &zones_value;
+
+    // Update the value of the zones characteristic and send a notification
+    err_code = sd_ble_gatts_value_set(p_occu->conn_handle,
+                                      p_occu->zones_handles.value_handle,
+                                      &gatts_value);
+    if (err_code != NRF_SUCCESS || p_occu->conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return err_code;
+    }
+
+    uint16_t len = sizeof(zones_value);
+    ble_gatts_hvx_params_t hvx_params;
+    memset(&hvx_params, 0, sizeof(hvx_params));
+    hvx_params.handle = p_occu->zones_handles.value_handle;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.p_data = &zones_value;
+    hvx_params.p_len  = &len;
+
+    err_code = sd_ble_gatts_hvx(p_occu->conn_handle, &hvx_params);
+    TRACE_RECORD(TRACE_NOTIFY, TRACE_CHAR_ZONES, (uint16_t)err_code);
+    if (err_code == NRF_SUCCESS)
     {
-        memset(&hvx_params, 0, sizeof(hvx_params));
-        hvx_params.handle = p_occu->detection_value_handles.value_handle;
-        hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
-        hvx_params.p_data = &detection_value;
-        hvx_params.p_len  = &len;
+        energy_add_notification();
     }
+    return err_code;
+}
 
-    return sd_ble_gatts_hvx(p_occu->conn_handle, &hvx_params);
+/**
+ * @brief Function for updating the Motion characteristic.
+ *
+ * This function updates the motion characteristic and sends a notification.
+ *
+ * @param[in] p_occu  Pointer to the proximity Service structure.
+ * @param[in] value   New motion value, see getMotionValue().
+ * @param[in] len     Length of the value.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+ret_code_t ble_proximity_service_motion_update(ble_proximity_service_t* p_occu, const uint8_t *value, uint16_t len)
+{
+    ret_code_t err_code;
+    ble_gatts_value_t gatts_value;
+    if (p_occu == NULL || value == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    // Initialize value struct.
+    memset(&gatts_value, 0, sizeof(gatts_value));
+
+    gatts_value.len     = len;
+    gatts_value.offset  = 0;
+    gatts_value.p_value = (uint8_t *)value;
+
+    // Update the value of the motion characteristic and send a notification
+    err_code = sd_ble_gatts_value_set(p_occu->conn_handle,
+                                      p_occu->motion_handles.value_handle,
+                                      &gatts_value);
+    if (err_code != NRF_SUCCESS || p_occu->conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return err_code;
+    }
+
+    ble_gatts_hvx_params_t hvx_params;
+    memset(&hvx_params, 0, sizeof(hvx_params));
+    hvx_params.handle = p_occu->motion_handles.value_handle;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.p_data = value;
+    hvx_params.p_len  = &len;
+
+    err_code = sd_ble_gatts_hvx(p_occu->conn_handle, &hvx_params);
+    TRACE_RECORD(TRACE_NOTIFY, TRACE_CHAR_MOTION, (uint16_t)err_code);
+    if (err_code == NRF_SUCCESS)
+    {
+        energy_add_notification();
+    }
+    return err_code;
 }
 
 /**
  * @brief Function for updating the Range characteristic value.
  *
- * This function updates the range characteristic value.
+ * This function updates the range characteristic value. A valid value is added to the pending
+ * configuration, see configureRange(), an invalid one is replaced by the current value.
  *
  * @param[in] p_occu     Pointer to the proximity Service structure.
  * @param[in] new_value  New range value to update.
@@ -330,13 +709,9 @@ ret_code_t ble_proximity_service_range_update(ble_proximity_service_t* p_occu, u
     gatts_value.offset  = 0;
     gatts_value.p_value = (uint8_t*)&new_value;
 
-    if(new_value >= MIN_RANGE_VALUE && new_value <= MAX_RANGE_VALUE)
+    if(configureRange(new_value))
     {
-        stopSensor();
-        setRange(new_value);
-        startSensor();
-
-        NRF_LOG_INFO("Range value Updated to %d\nSensor restarted successfully.", new_value);
+        NRF_LOG_INFO("Range value Updated to %d\nApplied with the next configuration commit.", new_value);
     }
     else
     {
@@ -356,7 +731,8 @@ ret_code_t ble_proximity_service_range_update(ble_proximity_service_t* p_occu, u
 /**
  * @brief Function for updating the Timeout characteristic value.
  *
- * This function updates the timeout characteristic value.
+ * This function updates the timeout characteristic value. A valid value is added to the pending
+ * configuration, see configureTimeout(), an invalid one is replaced by the current value.
  *
  * @param[in] p_occu     Pointer to the proximity Service structure.
  * @param[in] new_value  New timeout value to update.
@@ -374,22 +750,28 @@ ret_code_t ble_proximity_service_timeout_update(ble_proximity_service_t* p_occu,
     gatts_value.offset  = 0;
     gatts_value.p_value = (uint8_t*)&new_value;
 
+    if(configureTimeout(new_value))
+    {
+        NRF_LOG_INFO("Timeout value Updated to %dms", new_value);
+    }
+    else
+    {
+        NRF_LOG_INFO("Timeout value %d is out of bounds.\nShould be at least %d", new_value, MIN_TIMEOUT_VALUE);
+        new_value = getTimeout();
+    }
     // Update the characteristic value
     err_code = sd_ble_gatts_value_set(p_occu->conn_handle,
                                       p_occu->timeout_handles.value_handle,
                                       &gatts_value);
 
-    setPresenceTimeout(new_value);
-
-    NRF_LOG_INFO("Timeout value Updated to %dms", new_value);
-
     return err_code;
 }
 
 /**
  * @brief Function for updating the Sensitivity characteristic value.
  *
- * This function updates the sensitivity characteristic value.
+ * This function updates the sensitivity characteristic value. A valid value is added to the pending
+ * configuration, see configureSensitivity(), an invalid one is replaced by the current value.
  *
  * @param[in] p_occu     Pointer to the proximity Service structure.
  * @param[in] new_value  New sensitivity value to update.
@@ -407,12 +789,14 @@ ret_code_t ble_proximity_service_sensitivity_update(ble_proximity_service_t* p_o
     gatts_value.offset  = 0;
     gatts_value.p_value = &new_value;
 
-    if(new_value >= MIN_SENSITIVITY_VALUE && new_value <= MAX_SENSITIVITY_VALUE)
+    if(configureSensitivity(new_value))
+    {
+        NRF_LOG_INFO("Sensitivity value Updated to %d\nApplied with the next configuration commit.", new_value);
+    }
+    else if(new_value == CALIBRATION_SENSITIVITY_VALUE)
     {
-        stopSensor();
-        setSensitivity(new_value);
-        startSensor();
-        NRF_LOG_INFO("Sensitivity value Updated to %d\nSensor restarted successfully.", new_value);
+        calibrateSensor();
+        NRF_LOG_INFO("Calibrating detector, keep the sensor range empty for %d seconds.", CALIBRATION_TIME_SECONDS);
     }
     else
     {
@@ -427,16 +811,253 @@ ret_code_t ble_proximity_service_sensitivity_update(ble_proximity_service_t* p_o
 }
 
 
+/**
+ * @brief Function for refreshing the Detector characteristic value.
+ *
+ * @param[in] p_occu Pointer to the proximity Service structure.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+ret_code_t ble_proximity_service_detector_refresh(ble_proximity_service_t* p_occu)
+{
+    uint8_t value[DETECTOR_VALUE_MAX_SIZE];
+    ble_gatts_value_t gatts_value;
+
+    memset(&gatts_value, 0, sizeof(gatts_value));
+    gatts_value.len     = getDetectorValue(value, sizeof(value));
+    gatts_value.offset  = 0;
+    gatts_value.p_value = value;
+
+    return sd_ble_gatts_value_set(p_occu->conn_handle,
+                                  p_occu->detector_handles.value_handle,
+                                  &gatts_value);
+}
+
+/**
+ * @brief Function for updating the Detector characteristic value.
+ *
+ * This function queues custom detector thresholds and M-of-N values for the running sensor
+ * and updates the characteristic with the requested configuration. It is refreshed again
+ * once the sensor task applied the values.
+ *
+ * @param[in] p_occu  Pointer to the proximity Service structure.
+ * @param[in] p_value Written value.
+ * @param[in] len     Length of the written value.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+ret_code_t ble_proximity_service_detector_update(ble_proximity_service_t* p_occu, const uint8_t* p_value, uint16_t len)
+{
+    if(setDetectorValue(p_value, len))
+    {
+        NRF_LOG_INFO("Detector update queued, M/N %d/%d %d/%d", p_value[0], p_value[1], p_value[2], p_value[3]);
+    }
+    else
+    {
+        NRF_LOG_INFO("Detector value rejected.\nExpected M0 N0 M1 N1 first_bin thresholds[], with 1 <= M <= N");
+    }
+
+    return ble_proximity_service_detector_refresh(p_occu);
+}
+
+/**
+ * @brief Function for refreshing the Range, Sensitivity and Timeout characteristic values.
+ *
+ * Called after a configuration was applied, which may have been written through the Config
+ * characteristic.
+ *
+ * @param[in] p_occu Pointer to the proximity Service structure.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+ret_code_t ble_proximity_service_config_refresh(ble_proximity_service_t* p_occu)
+{
+    ret_code_t err_code;
+    ble_gatts_value_t gatts_value;
+    uint16_t range = getRange();
+    uint8_t sensitivity = getSensitivity();
+    uint16_t timeout = getTimeout();
+
+    memset(&gatts_value, 0, sizeof(gatts_value));
+    gatts_value.len     = sizeof(uint16_t);
+    gatts_value.p_value = (uint8_t*)&range;
+    err_code = sd_ble_gatts_value_set(p_occu->conn_handle,
+                                      p_occu->range_handles.value_handle,
+                                      &gatts_value);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    gatts_value.len     = sizeof(uint8_t);
+    gatts_value.p_value = &sensitivity;
+    err_code = sd_ble_gatts_value_set(p_occu->conn_handle,
+                                      p_occu->sensitivity_handles.value_handle,
+                                      &gatts_value);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    gatts_value.len     = sizeof(uint16_t);
+    gatts_value.p_value = (uint8_t*)&timeout;
+    return sd_ble_gatts_value_set(p_occu->conn_handle,
+                                  p_occu->timeout_handles.value_handle,
+                                  &gatts_value);
+}
+
+/**
+ * @brief Function for updating the Config characteristic value.
+ *
+ * This function applies all parameters of a written Config value in one transaction. An
+ * invalid value changes nothing.
+ *
+ * @param[in] p_occu  Pointer to the proximity Service structure.
+ * @param[in] p_value Written value.
+ * @param[in] len     Length of the written value.
+ */
+void ble_proximity_service_config_update(ble_proximity_service_t* p_occu, const uint8_t* p_value, uint16_t len)
+{
+    UNUSED_PARAMETER(p_occu);
+    if(setConfigValue(p_value, len))
+    {
+        NRF_LOG_INFO("Config committed. Range: %d cm, sensitivity level: %d, timeout: %d ms",
+                     p_value[2] | (p_value[3] << 8), p_value[1], p_value[4] | (p_value[5] << 8));
+    }
+    else
+    {
+        NRF_LOG_INFO("Config value rejected.\nExpected version %d, sensitivity, range, timeout, M0 N0 M1 N1, count, policy, thresholds[]",
+                     CONFIG_VALUE_VERSION);
+    }
+}
+
+/**
+ * @brief Function for handling a write of the Zones characteristic.
+ *
+ * This function sets the written zones, they are applied with the pending configuration. An
+ * invalid value changes nothing. The characteristic keeps reading the occupied zones.
+ *
+ * @param[in] p_occu  Pointer to the proximity Service structure.
+ * @param[in] p_value Written value.
+ * @param[in] len     Length of the written value.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+ret_code_t ble_proximity_service_zones_write(ble_proximity_service_t* p_occu, const uint8_t* p_value, uint16_t len)
+{
+    ble_gatts_value_t gatts_value;
+    uint8_t zones_value;
+
+    if(setZonesValue(p_value, len))
+    {
+        NRF_LOG_INFO("Zones update queued, %d zones", p_value[0]);
+    }
+    else
+    {
+        NRF_LOG_INFO("Zones value rejected.\nExpected count (0 to %d), from_cm to_cm timeout_ms[], event mode builds only", MAX_ZONES);
+    }
+
+    zones_value = getZoneValue();
+    memset(&gatts_value, 0, sizeof(gatts_value));
+    gatts_value.len     = sizeof(uint8_t);
+    gatts_value.offset  = 0;
+    gatts_value.p_value = &zones_value;
+
+    return sd_ble_gatts_value_set(p_occu->conn_handle,
+                                  p_occu->zones_handles.value_handle,
+                                  &gatts_value);
+}
+
+/**
+ * @brief Function for handling a write of the Motion characteristic.
+ *
+ * This function enables or disables the target tracking, applied with the pending
+ * configuration. An invalid value changes nothing. The characteristic keeps reading the
+ * tracked target.
+ *
+ * @param[in] p_occu  Pointer to the proximity Service structure.
+ * @param[in] p_value Written value.
+ * @param[in] len     Length of the written value.
+ * @return NRF_SUCCESS if successful, otherwise an error code.
+ */
+ret_code_t ble_proximity_service_motion_write(ble_proximity_service_t* p_occu, const uint8_t* p_value, uint16_t len)
+{
+    ble_gatts_value_t gatts_value;
+    uint8_t motion_value[MOTION_VALUE_SIZE];
+
+    if(setMotionValue(p_value, len))
+    {
+        NRF_LOG_INFO("Tracking %s queued", p_value[0] == MOTION_TRACKING_ON ? "enable" : "disable");
+    }
+    else
+    {
+        NRF_LOG_INFO("Motion value rejected.\nExpected %d to disable or %d to enable tracking, event mode builds only",
+                     MOTION_TRACKING_OFF, MOTION_TRACKING_ON);
+    }
+
+    memset(&gatts_value, 0, sizeof(gatts_value));
+    gatts_value.len     = getMotionValue(motion_value, sizeof(motion_value));
+    gatts_value.offset  = 0;
+    gatts_value.p_value = motion_value;
+
+    return sd_ble_gatts_value_set(p_occu->conn_handle,
+                                  p_occu->motion_handles.value_handle,
+                                  &gatts_value);
+}
+
+/**
+ * @brief Function for handling the Read/Write Authorization Request event.
+ *
+ * Answers reads of the Config characteristic with the current configuration and reads of the
+ * Diagnostics characteristic with the statistics of the last window. A long read continues on
+ * the value taken at offset 0, so all parts of the value belong together.
+ *
+ * @param[in] p_occu     Pointer to the proximity Service structure.
+ * @param[in] p_ble_evt  Event received from the BLE stack.
+ */
+static void on_rw_authorize_request(ble_proximity_service_t* p_occu, ble_evt_t const * p_ble_evt)
+{
+    ble_gatts_evt_rw_authorize_request_t const * p_req = &p_ble_evt->evt.gatts_evt.params.authorize_request;
+    ble_gatts_rw_authorize_reply_params_t reply;
+    uint8_t value[MAX(CONFIG_VALUE_MAX_SIZE, DIAGNOSTICS_VALUE_MAX_SIZE)];
+    uint16_t handle = p_req->request.read.handle;
+
+    if (p_req->type != BLE_GATTS_AUTHORIZE_TYPE_READ ||
+        (handle != p_occu->config_handles.value_handle &&
+         handle != p_occu->diagnostics_handles.value_handle))
+    {
+        return;
+    }
+
+    memset(&reply, 0, sizeof(reply));
+    reply.type = BLE_GATTS_AUTHORIZE_TYPE_READ;
+    reply.params.read.gatt_status = BLE_GATT_STATUS_SUCCESS;
+    if (p_req->request.read.offset == 0)
+    {
+        reply.params.read.update = 1;
+        if (handle == p_occu->config_handles.value_handle)
+        {
+            reply.params.read.len = getConfigValue(value, sizeof(value));
+        }
+        else
+        {
+            reply.params.read.len = instrumentation_get_value(value, sizeof(value));
+        }
+        reply.params.read.p_data = value;
+    }
+    sd_ble_gatts_rw_authorize_reply(p_ble_evt->evt.gatts_evt.conn_handle, &reply);
+}
+
 /**
  * @brief Function for handling the Connect event.
  *
+ * The sensor keeps running across connections as the sensing policy selects, the detection
+ * characteristic already holds the current presence state.
+ *
  * @param[in] p_occu     Pointer to the proximity Service structure.
  * @param[in] p_ble_evt  Event received from the BLE stack.
  */
 static void on_connect(ble_proximity_service_t* p_occu, ble_evt_t const * p_ble_evt)
 {
     p_occu->conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
-    startSensor();
+    setConnectionState(true);
+    ble_proximity_service_detector_refresh(p_occu);
 }
 
 
@@ -451,7 +1072,7 @@ static void on_disconnect(ble_proximity_service_t* p_occu, ble_evt_t const * p_b
 {
     UNUSED_PARAMETER(p_ble_evt);
     p_occu->conn_handle = BLE_CONN_HANDLE_INVALID;
-    stopSensor();
+    setConnectionState(false);
 }
 
 
@@ -496,6 +1117,27 @@ static void on_write(ble_proximity_service_t * p_occu, ble_evt_t const * p_ble_e
         uint8_t sens_value = *(uint8_t*)p_evt_write->data;
         ble_proximity_service_sensitivity_update(p_occu, sens_value);
     }
+    if (p_evt_write->handle == p_occu->detector_handles.value_handle)
+    {
+        ble_proximity_service_detector_update(p_occu, p_evt_write->data, p_evt_write->len);
+    }
+    if (p_evt_write->handle == p_occu->zones_handles.value_handle)
+    {
+        ble_proximity_service_zones_write(p_occu, p_evt_write->data, p_evt_write->len);
+    }
+    if (p_evt_write->handle == p_occu->motion_handles.value_handle)
+    {
+        ble_proximity_service_motion_write(p_occu, p_evt_write->data, p_evt_write->len);
+    }
+    if (p_evt_write->handle == p_occu->config_handles.value_handle)
+    {
+        ble_proximity_service_config_update(p_occu, p_evt_write->data, p_evt_write->len);
+    }
+    if (p_evt_write->handle == p_occu->diagnostics_handles.value_handle &&
+        p_evt_write->len == 1 && p_evt_write->data[0] == TRACE_DUMP_COMMAND)
+    {
+        dumpTrace();
+    }
 }
 
 /**
@@ -527,6 +1169,10 @@ void ble_proximity_service_on_ble_evt(ble_evt_t const* p_ble_evt, void* p_contex
             on_write(p_occu, p_ble_evt);
             break;
 
+        case BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST:
+            on_rw_authorize_request(p_occu, p_ble_evt);
+            break;
+
         default:
             // No implementation needed.
             break;
@@ -39,6 +39,11 @@ NRF_SDH_BLE_OBSERVER(_name ## _obs,
 #define BLE_UUID_RANGE_CHAR          0x2BB1
 #define BLE_UUID_SENSITIVITY_CHAR    0x2BB2
 #define BLE_UUID_TIMEOUT_CHAR        0x2BB3
+#define BLE_UUID_DETECTOR_CHAR       0x2BB4
+#define BLE_UUID_ZONES_CHAR          0x2BB5
+#define BLE_UUID_MOTION_CHAR         0x2BB6
+#define BLE_UUID_CONFIG_CHAR         0x2BB7
+#define BLE_UUID_DIAGNOSTICS_CHAR    0x2BB8
 
 
 
@@ -50,16 +55,33 @@ typedef struct
     ble_gatts_char_handles_t    range_handles;           // Handles for Range characteristic
     ble_gatts_char_handles_t    sensitivity_handles;     // Handles for Sensitivity characteristic
     ble_gatts_char_handles_t    timeout_handles;         // Handles for Timeout characteristic
+    ble_gatts_char_handles_t    detector_handles;        // Handles for Detector characteristic
+    ble_gatts_char_handles_t    zones_handles;           // Handles for Zones characteristic
+    ble_gatts_char_handles_t    motion_handles;          // Handles for Motion characteristic
+    ble_gatts_char_handles_t    config_handles;          // Handles for Config characteristic
+    ble_gatts_char_handles_t    diagnostics_handles;     // Handles for Diagnostics characteristic
     uint16_t                    conn_handle;            // Connection handle to identify the connected peer
 } ble_proximity_service_t;
 
 
 // Function for initializing the custom GATT service
-extern ret_code_t ble_proximity_service_init(ble_proximity_service_t* p_occu, void* ble_app_sem, updateSensorValueCb_t updateSensCb);
+extern ret_code_t ble_proximity_service_init(ble_proximity_service_t* p_occu, void* ble_app_queue, updateSensorValueCb_t updateSensCb);
 
 // Function for updating the detection characteristic
 extern ret_code_t ble_proximity_service_detection_update(ble_proximity_service_t* p_proximity_service, uint8_t detection_value);
 
+// Function for updating the zones characteristic
+extern ret_code_t ble_proximity_service_zones_update(ble_proximity_service_t* p_proximity_service, uint8_t zones_value);
+
+// Function for updating the motion characteristic
+extern ret_code_t ble_proximity_service_motion_update(ble_proximity_service_t* p_proximity_service, const uint8_t *value, uint16_t len);
+
+// Function for refreshing the detector characteristic
+extern ret_code_t ble_proximity_service_detector_refresh(ble_proximity_service_t* p_proximity_service);
+
+// Function for refreshing the range, sensitivity and timeout characteristics
+extern ret_code_t ble_proximity_service_config_refresh(ble_proximity_service_t* p_proximity_service);
+
 // Function for handling GATT events related to the custom service
 extern void ble_proximity_service_on_ble_evt(ble_evt_t const* p_ble_evt, void* p_context);
 
@@ -0,0 +1,229 @@
+/**
+ * @file settings.c
+ * @brief Persistent application settings in flash.
+ *
+ * The settings are one Flash Data Storage (FDS) record. FDS writes every update as a new copy
+ * and reclaims outdated copies by garbage collection, which spreads the writes over the flash
+ * pages of FDS. The pages are shared with the peer manager.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "fds.h"
+#include "nrf_log.h"
+#include "settings.h"
+
+#define SETTINGS_FILE_ID            0x4E58    // file of the application settings, 'NX'
+#define SETTINGS_RECORD_KEY         0x0001    // record of settings_t
+#define SETTINGS_RECORD_WORDS       ((sizeof(settings_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
+/* Data of the record being written, must not change until FDS reports the write */
+static uint32_t          gRecord[SETTINGS_RECORD_WORDS];
+static volatile bool     gBusy;
+/* Settings stored while a write was in progress, written once it is done */
+static settings_t        gNext;
+static volatile bool     gNextPending;
+/* Flash ran full, the write is repeated after the garbage collection */
+static volatile bool     gGcPending;
+
+
+/**
+ * @brief Write gRecord as the settings record.
+ *
+ * Updates the existing record or writes the first one. A full flash starts a garbage collection,
+ * the write is then repeated once it is done.
+ *
+ * @return NRF_SUCCESS if the write or garbage collection was queued, otherwise an error code.
+ */
+static ret_code_t settings_write(void)
+{
+    fds_record_t record;
+    fds_record_desc_t desc;
+    fds_find_token_t token;
+    ret_code_t err_code;
+
+    record.file_id = SETTINGS_FILE_ID;
+    record.key = SETTINGS_RECORD_KEY;
+    record.data.p_data = gRecord;
+    record.data.length_words = SETTINGS_RECORD_WORDS;
+
+    memset(&token, 0, sizeof(token));
+    if(fds_record_find(SETTINGS_FILE_ID, SETTINGS_RECORD_KEY, &desc, &token) == NRF_SUCCESS)
+    {
+        err_code = fds_record_update(&desc, &record);
+    }
+    else
+    {
+        err_code = fds_record_write(NULL, &record);
+    }
+    if(err_code == FDS_ERR_NO_SPACE_IN_FLASH)
+    {
+        gGcPending = true;
+        err_code = fds_gc();
+        gGcPending = (err_code == NRF_SUCCESS);
+    }
+    return err_code;
+}
+
+/**
+ * @brief Finish a write and start the next one if settings were stored meanwhile.
+ */
+static void settings_write_done(void)
+{
+    bool next;
+
+    taskENTER_CRITICAL();
+    next = gNextPending;
+    if(next)
+    {
+        memcpy(gRecord, &gNext, sizeof(gNext));
+        gNextPending = false;
+    }
+    else
+    {
+        gBusy = false;
+    }
+    taskEXIT_CRITICAL();
+    if(next && settings_write() != NRF_SUCCESS)
+    {
+        gBusy = false;
+    }
+}
+
+/**
+ * @brief FDS event handler.
+ *
+ * @param[in] p_evt FDS event.
+ */
+static void settings_fds_evt_handler(fds_evt_t const * p_evt)
+{
+    switch(p_evt->id)
+    {
+        case FDS_EVT_WRITE:
+        case FDS_EVT_UPDATE:
+            if(p_evt->write.file_id == SETTINGS_FILE_ID && p_evt->write.record_key == SETTINGS_RECORD_KEY)
+            {
+                if(p_evt->result != NRF_SUCCESS)
+                {
+                    NRF_LOG_INFO("Settings write failed: %u", p_evt->result);
+                }
+                settings_write_done();
+            }
+            break;
+
+        case FDS_EVT_GC:
+            if(gGcPending)
+            {
+                gGcPending = false;
+                if(p_evt->result != NRF_SUCCESS || settings_write() != NRF_SUCCESS)
+                {
+                    NRF_LOG_INFO("Settings write failed, flash full");
+                    settings_write_done();
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Initialize the settings storage.
+ *
+ * Registers with FDS and initializes it. Must be called after the SoftDevice is enabled and
+ * before the peer manager initializes FDS, so the handler is registered before the first FDS
+ * operation. With formatted flash pages FDS is ready when this function returns.
+ *
+ * @return true on success, false otherwise.
+ */
+bool settings_init(void)
+{
+    ret_code_t err_code;
+
+    err_code = fds_register(settings_fds_evt_handler);
+    if(err_code == NRF_SUCCESS)
+    {
+        err_code = fds_init();
+    }
+    return (err_code == NRF_SUCCESS);
+}
+
+/**
+ * @brief Load the stored settings.
+ *
+ * Does not wait for FDS. FDS is only still initializing if the flash pages need formatting, and
+ * then no settings are stored yet.
+ *
+ * @param[out] settings Destination for the settings.
+ * @return true if settings of SETTINGS_VERSION were stored, false otherwise.
+ */
+bool settings_load(settings_t *settings)
+{
+    fds_record_desc_t desc;
+    fds_find_token_t token;
+    fds_flash_record_t flash_record;
+    fds_stat_t stat;
+    bool valid;
+
+    // fds_stat() fails until FDS is initialized
+    if(fds_stat(&stat) != NRF_SUCCESS)
+    {
+        return false;
+    }
+    memset(&token, 0, sizeof(token));
+    if(fds_record_find(SETTINGS_FILE_ID, SETTINGS_RECORD_KEY, &desc, &token) != NRF_SUCCESS ||
+       fds_record_open(&desc, &flash_record) != NRF_SUCCESS)
+    {
+        return false;
+    }
+    valid = flash_record.p_header->length_words == SETTINGS_RECORD_WORDS &&
+            ((const settings_t *)flash_record.p_data)->version == SETTINGS_VERSION;
+    if(valid)
+    {
+        memcpy(settings, flash_record.p_data, sizeof(*settings));
+    }
+    fds_record_close(&desc);
+    return valid;
+}
+
+/**
+ * @brief Store the settings.
+ *
+ * Does not block. The settings are written in the background, settings stored while a write is
+ * in progress are written after it and replace each other.
+ *
+ * @param[in] settings Settings to store.
+ * @return true if the write was queued, false otherwise.
+ */
+bool settings_store(const settings_t *settings)
+{
+    bool busy;
+
+    taskENTER_CRITICAL();
+    busy = gBusy;
+    if(busy)
+    {
+        gNext = *settings;
+        gNextPending = true;
+    }
+    else
+    {
+        gBusy = true;
+        memcpy(gRecord, settings, sizeof(*settings));
+    }
+    taskEXIT_CRITICAL();
+    if(busy)
+    {
+        return true;
+    }
+    if(settings_write() != NRF_SUCCESS)
+    {
+        gBusy = false;
+        return false;
+    }
+    return true;
+}
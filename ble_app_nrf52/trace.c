@@ -0,0 +1,141 @@
+/**
+ * @file trace.c
+ * @brief Event trace recorder.
+ *
+ * The timestamps come from the RTC2 counter of the instrumentation, which keeps counting while
+ * the CPU sleeps and stays extended however long no event is recorded. A record is written with interrupts masked, so the interrupt handlers and the
+ * tasks can record into the same ring. The dump goes through the deferred log and yields every
+ * few records to let the logger task empty its buffer.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "nrf_log.h"
+#include "novelda_x4sensor.h"
+#include "instrumentation.h"
+#include "trace.h"
+
+#ifdef EVENT_TRACE
+
+#define TRACE_RECORDS           512     // 4 kB, a power of two
+#define TRACE_DUMP_BURST        16      // records logged before the logger task gets to run
+
+static traceRecord_t gTrace[TRACE_RECORDS];
+static uint32_t gTraceHead;             // records written since the start
+static volatile bool gTracePaused;
+
+/**
+ * @brief Record the start and the end of every bus transaction of the sensor driver.
+ *
+ * @param[in] op    Operation of the host interface.
+ * @param[in] end   false at the start, true at the end of the operation.
+ * @param[in] value Address, mode, size or ticks at the start, result at the end.
+ */
+static void trace_bus(x4sensor_trace_op_t op, bool end, uint16_t value)
+{
+    trace_record(end ? TRACE_BUS_END : TRACE_BUS_BEGIN, (uint8_t)op, value);
+}
+
+/**
+ * @brief Start the recorder.
+ *
+ * Called before the sensor driver is initialized, which takes over the bus trace hook.
+ */
+void trace_init(void)
+{
+    instrumentation_start_counter();
+    x4sensor_set_trace_hook(trace_bus);
+}
+
+/**
+ * @brief Store a record in the ring, overwriting the oldest one when it is full.
+ *
+ * Can be called from any context.
+ *
+ * @param[in] event traceEvent_t.
+ * @param[in] arg   Argument of the event.
+ * @param[in] value Value of the event.
+ */
+void trace_record(uint8_t event, uint8_t arg, uint16_t value)
+{
+    UBaseType_t mask;
+    traceRecord_t *record;
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    if(!gTracePaused)
+    {
+        record = &gTrace[gTraceHead % TRACE_RECORDS];
+        record->timestamp_us = instrumentation_get_time_us();
+        record->event = event;
+        record->arg = arg;
+        record->value = value;
+        gTraceHead++;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/**
+ * @brief Write the records on the UART, oldest first, and empty the ring.
+ *
+ * Called by the application task. Recording pauses during the dump.
+ */
+void trace_dump(void)
+{
+    uint32_t head;
+    uint32_t count;
+    uint32_t lost;
+
+    taskENTER_CRITICAL();
+    gTracePaused = true;
+    head = gTraceHead;
+    taskEXIT_CRITICAL();
+    count = head < TRACE_RECORDS ? head : TRACE_RECORDS;
+    lost = head - count;
+    NRF_LOG_INFO("Trace: %u records, %u lost", count, lost);
+    for(uint32_t i = head - count; i != head; i++)
+    {
+        const traceRecord_t *record = &gTrace[i % TRACE_RECORDS];
+
+        NRF_LOG_INFO(TRACE_LINE_PREFIX " %08x %08x", record->timestamp_us,
+                     record->event | (record->arg << 8) | ((uint32_t)record->value << 16));
+        if((i + 1) % TRACE_DUMP_BURST == 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+    NRF_LOG_INFO(TRACE_LINE_PREFIX " %08x %08x", instrumentation_get_time_us(),
+                 TRACE_DUMP_END | ((lost > UINT16_MAX ? UINT16_MAX : lost) << 16));
+    gTraceHead = 0;
+    gTracePaused = false;
+}
+
+#else
+
+/**
+ * @brief Nothing to start without EVENT_TRACE.
+ */
+void trace_init(void)
+{
+}
+
+/**
+ * @brief Nothing to record without EVENT_TRACE.
+ */
+void trace_record(uint8_t event, uint8_t arg, uint16_t value)
+{
+    (void)event;
+    (void)arg;
+    (void)value;
+}
+
+/**
+ * @brief Nothing to dump without EVENT_TRACE.
+ */
+void trace_dump(void)
+{
+    NRF_LOG_INFO("Trace not available, build with EVENT_TRACE");
+}
+
+#endif // EVENT_TRACE
@@ -0,0 +1,96 @@
+/**
+ * @file boot.c
+ * @brief Boot milestones and the startup metrics.
+ *
+ * Milestones are marked from the sensor task and from the BLE stack, the times are written in
+ * critical sections and logged by the marking task.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "boot.h"
+#include "port.h"
+
+static const char *const gMilestoneNames[BOOT_MILESTONE_COUNT] =
+{
+    "sensor discovered", "sensor prepared", "advertising", "first valid frame"
+};
+
+/* Time of every marked milestone, bit n of gMarked is set once milestone n is marked */
+static uint32_t gTimesMs[BOOT_MILESTONE_COUNT];
+static uint8_t gMarked;
+
+/**
+ * @brief Record the time of a boot milestone.
+ *
+ * Only the first mark of a milestone is recorded, later ones return right away. The startup
+ * metrics are logged by the task whose mark completes them.
+ *
+ * @param[in] milestone Milestone reached.
+ * @param[in] time_us   Time of the milestone from chipinterface_get_time_microseconds_64(), may
+ *                      lie ahead when it is known in advance.
+ */
+void boot_mark_at(bootMilestone_t milestone, uint64_t time_us)
+{
+    const uint8_t report = (1 << BOOT_ADVERTISING) | (1 << BOOT_FIRST_FRAME);
+    uint32_t time_ms = (uint32_t)(time_us / 1000);
+    uint8_t marked;
+
+    if(milestone >= BOOT_MILESTONE_COUNT || (gMarked & (1 << milestone)))
+    {
+        return;
+    }
+    taskENTER_CRITICAL();
+    marked = gMarked;
+    if(!(marked & (1 << milestone)))
+    {
+        gTimesMs[milestone] = time_ms;
+        gMarked = marked | (1 << milestone);
+    }
+    taskEXIT_CRITICAL();
+    if(marked & (1 << milestone))
+    {
+        return;
+    }
+    PORT_LOG_INFO("Boot: %s after %u ms", gMilestoneNames[milestone], time_ms);
+    if(((marked | (1 << milestone)) & report) == report)
+    {
+        PORT_LOG_INFO("Boot: time to advertise %u ms, time to first valid frame %u ms",
+                      gTimesMs[BOOT_ADVERTISING], gTimesMs[BOOT_FIRST_FRAME]);
+        PORT_LOG_INFO(BOOT_LINE_PREFIX " %u %u", gTimesMs[BOOT_ADVERTISING], gTimesMs[BOOT_FIRST_FRAME]);
+    }
+}
+
+/**
+ * @brief Record a boot milestone reached now.
+ *
+ * @param[in] milestone Milestone reached.
+ */
+void boot_mark(bootMilestone_t milestone)
+{
+    boot_mark_at(milestone, chipinterface_get_time_microseconds_64());
+}
+
+/**
+ * @brief Get the time of a boot milestone.
+ *
+ * @param[in]  milestone Milestone to read.
+ * @param[out] time_ms   Time of the milestone since the scheduler started.
+ * @return true if the milestone was reached, false otherwise.
+ */
+bool boot_get_time_ms(bootMilestone_t milestone, uint32_t *time_ms)
+{
+    bool marked;
+
+    if(milestone >= BOOT_MILESTONE_COUNT)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    marked = (gMarked & (1 << milestone)) != 0;
+    *time_ms = gTimesMs[milestone];
+    taskEXIT_CRITICAL();
+    return marked;
+}
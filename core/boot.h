@@ -0,0 +1,48 @@
+/**
+ * @file boot.h
+ * @brief Boot milestones and the startup metrics.
+ *
+ * The boot runs two pipelines in parallel from the start of the scheduler: the BLE stack brings
+ * up advertising in its own task while the sensor task discovers the sensor and prepares it for
+ * the first start (x4sensor_prepare(): firmware upload and oscillator calibration). The board and
+ * the sensor task mark every milestone with boot_mark(), only the first mark of a milestone
+ * counts. Each milestone is logged with its time, and once both are known the time to advertise
+ * and the time to the first valid frame are logged as a BOOT_LINE_PREFIX line to track them
+ * across releases. Times are in milliseconds since the scheduler started, taken from
+ * chipinterface_get_time_microseconds_64() so they do not wrap. The initialization before the
+ * scheduler is not included.
+ */
+
+#ifndef BOOT_H_
+#define BOOT_H_
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOOT_LINE_PREFIX    "#BT"   // start of the logged startup metrics on the UART
+
+/*
+ * Logged startup metrics: BOOT_LINE_PREFIX, time to advertise and time to the first valid frame
+ * in milliseconds as decimal numbers.
+ */
+typedef enum
+{
+    BOOT_SENSOR_DISCOVERED = 0,     // sensor found on the bus
+    BOOT_SENSOR_PREPARED,           // firmware loaded and oscillator calibrated
+    BOOT_ADVERTISING,               // advertising started
+    BOOT_FIRST_FRAME,               // first frame of the started sensor, in normal operation mode
+                                    // one frame period after the start
+    BOOT_MILESTONE_COUNT
+} bootMilestone_t;
+
+extern void boot_mark(bootMilestone_t milestone);
+extern void boot_mark_at(bootMilestone_t milestone, uint64_t time_us);
+extern bool boot_get_time_ms(bootMilestone_t milestone, uint32_t *time_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOOT_H_ */
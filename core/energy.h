@@ -0,0 +1,51 @@
+/**
+ * @file energy.h
+ * @brief Energy estimate of the board per operating mode.
+ *
+ * Built with ENERGY_ESTIMATE defined, the activity of the board is accounted per operating mode:
+ * the time in the mode, the bus operations of the sensor driver, the CPU wake-ups and running
+ * time of an INSTRUMENTATION build, the connection and advertising time and the notifications.
+ * At the end of every window of ENERGY_WINDOW_MS the estimated average current of every mode
+ * used in the window is printed on the UART, computed with the calibration coefficients of the
+ * board by x4sensor_estimate_energy(). The activity and the coefficients are also logged as
+ * ENERGY_LINE_PREFIX and ENERGY_COEFFICIENTS_PREFIX lines, which tools/energy_replay reads back
+ * to estimate the same activity with other settings on a PC.
+ */
+
+#ifndef ENERGY_H_
+#define ENERGY_H_
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ENERGY_WINDOW_MS            60000   // estimate window
+#define ENERGY_LINE_PREFIX          "#EN"   // start of a logged activity line on the UART
+#define ENERGY_COEFFICIENTS_PREFIX  "#EC"   // start of a logged coefficients line on the UART
+#define ENERGY_LINE_WORDS           5       // 32 bit words per logged line
+
+/*
+ * Logged activity: ENERGY_LINE_PREFIX, mode << 8 | part, then words part * ENERGY_LINE_WORDS
+ * and up of x4sensor_energy_activity_t, as hex words padded with 0. Logged coefficients:
+ * ENERGY_COEFFICIENTS_PREFIX, part, then words of x4sensor_energy_coefficients_t the same way.
+ */
+typedef enum
+{
+    ENERGY_MODE_IDLE = 0,               // advertising, sensor stopped
+    ENERGY_MODE_SENSING,                // advertising, sensor running
+    ENERGY_MODE_CONNECTED,              // connected, sensor stopped
+    ENERGY_MODE_CONNECTED_SENSING,      // connected, sensor running
+    ENERGY_MODE_COUNT
+} energyMode_t;
+
+extern void energy_init(void);
+extern void energy_set_sensing(bool sensing);
+extern void energy_set_connection(bool connected, uint32_t interval_us);
+extern void energy_add_notification(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENERGY_H_ */
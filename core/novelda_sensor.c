@@ -0,0 +1,1313 @@
+/**
+ * @file novelda_sensor.c
+ * @brief Implementation of the Novelda X4 proximity sensor module.
+ *
+ * This module provides the implementation of the Novelda X4 proximity sensor interface, including
+ * initialization, sensor control, and event processing. It interacts with the Novelda chip
+ * interface and FreeRTOS-based applications.
+ */
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <queue.h>
+#include <timers.h>
+#include <task.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <novelda_chipinterface.h>
+#include <x4sensor_configuration_blob.h>
+#include "novelda_sensor.h"
+#include "boot.h"
+#ifdef RECORDING_BENCHMARK
+#include "recording_benchmark.h"
+#endif
+#include "port.h"
+
+/* Requests to the sensor task, see sensor_event_t */
+static QueueHandle_t sensorQueue;
+volatile presence_callback gPresence_cb;
+static sensor_done_callback gDone_cb;
+uint8_t gSensitivity;
+uint16_t gRange;
+volatile bool gRunning = false;
+
+/* Sensor bus selected by the build configuration */
+#ifdef X4SENSOR_INTERFACE_SPI
+#define SENSOR_INITIALIZE x4sensor_initialize_spi
+#else
+#define SENSOR_INITIALIZE x4sensor_initialize_i2c
+#endif
+
+/* Custom detector configuration, reapplied on every start while set. Written by other tasks,
+ * copied in critical sections. */
+static x4sensor_detector_config_t gDetector;
+static volatile bool gDetectorCustom;
+/* Detector configuration of the sensor, refreshed by the sensor task */
+static x4sensor_detector_config_t gDetectorActive;
+static bool gDetectorActiveValid;
+
+/* Recording mode frame buffer of the background calibration, must hold
+ * x4sensor_get_max_sensor_data_size_recording_mode() bytes */
+#define SENSOR_RECORDING_BUFFER_SIZE 256
+/* Longest time to wait for a recording mode frame */
+#define SENSOR_FRAME_TIMEOUT_US 1000000
+
+static uint8_t gRecordingBuffer[SENSOR_RECORDING_BUFFER_SIZE];
+static x4sensor_calibration_t gCalibration;
+
+/* Identity and oscillator calibration of the sensor, restored at boot and written by the sensor
+ * task in critical sections */
+static sensor_metadata_t gMetadata;
+
+/* Sensor watchdog statistics, written by the sensor task in critical sections */
+static sensor_health_t gHealth;
+/* Start of the current failure, without wrap-around as a failure may last for hours, and delay
+ * before the next recovery attempt */
+static uint64_t gFailureUs;
+static uint32_t gBackoffMs;
+
+/* Presence state machine, advanced by the sensor task with every frame and whenever a pending
+ * transition is due. The detection state of the last frame holds until the next frame. */
+static x4sensor_presence_t gPresence;
+static x4sensor_presence_setup_t gPresenceSetup;
+static bool gDetected;
+static uint32_t gFrameCounter;
+/* Time of gFrameCounter, without wrap-around as normal mode may see no frame for hours */
+static uint64_t gFrameUs;
+static uint8_t gFrameRate;
+/* Idle frame rate, the divider of the full frame rate and the time of the last detection or of
+ * the start */
+static uint8_t gFrameRateDivider;
+static uint32_t gLastDetectionUs;
+
+#ifdef SENSOR_EVENT_MODE
+/* Frame buffer for event mode, must hold x4sensor_get_max_sensor_data_size_event_mode() bytes */
+#define SENSOR_FRAME_BUFFER_SIZE 64
+/* Interval of the periodic report used as sensor heartbeat */
+#define SENSOR_HEARTBEAT_SECONDS 10
+
+/* Report interval while zones or tracking are enabled, both need the distance of every frame */
+#define SENSOR_FRAME_REPORT_INTERVAL 1
+
+/* Time a heartbeat may be late relative to the report interval, covers the tolerance of the
+ * X4 low power oscillator */
+#define SENSOR_HEARTBEAT_MARGIN_PERCENT 200
+
+static uint8_t gFrameBuffer[SENSOR_FRAME_BUFFER_SIZE];
+/* Heartbeat supervision, armed at every start. The time of the last frame does not wrap. */
+static uint32_t gHeartbeatTimeoutUs;
+static uint64_t gLastFrameUs;
+/* Detector range bins of each zone, mapped at every start */
+static uint32_t gZoneMasks[SENSOR_MAX_ZONES];
+static uint8_t gZoneMaskCount;
+/* Target tracker, prepared at every start while tracking is enabled */
+static x4sensor_tracker_t gTracker;
+static bool gTrackerActive;
+#endif
+
+/* Distance zones reported in the snapshot, copied in critical sections */
+static sensor_zone_t gZones[SENSOR_MAX_ZONES];
+static uint8_t gZoneCount;
+/* Track the nearest target in the snapshot */
+static volatile bool gTracking;
+
+/* Compiler barrier, sufficient for the single core Cortex-M targets */
+#define SNAPSHOT_BARRIER() __asm volatile ("" ::: "memory")
+
+/* Latest frame snapshot. Two copies so a reader is never directed to the copy being written */
+static sensor_snapshot_t gSnapshot[2];
+static volatile uint32_t gSnapshotSeq;
+
+/**
+ * @brief Request to the sensor task.
+ *
+ * Requests are queued by value and processed in order between frames, so every request is
+ * executed exactly once with the parameters it was made with.
+ */
+typedef struct
+{
+    uint8_t  type;                                      // sensor_event_type_t
+    uint32_t timestamp_us;                              // chipinterface time of the request
+    union
+    {
+        struct
+        {
+            uint8_t sensitivity;
+            uint16_t range;
+            presence_callback callback;
+        } start;
+        uint16_t calibration_seconds;
+        x4sensor_presence_setup_t presence;
+    } payload;
+} sensor_event_t;
+
+#define SENSOR_EVENT_QUEUE_LENGTH 8
+
+/**
+ * @brief Publish a new sensor snapshot.
+ *
+ * Only called from the sensor task. The snapshot is written to the copy readers are not
+ * directed to and then made visible by advancing the sequence counter. A reader that
+ * preempts the sensor task therefore always finds a complete copy.
+ *
+ * @param[in] snapshot Snapshot to publish.
+ */
+static void sensor_publish_snapshot(const sensor_snapshot_t *snapshot)
+{
+    uint32_t seq = gSnapshotSeq;
+
+    gSnapshot[(seq + 1) & 1] = *snapshot;
+    SNAPSHOT_BARRIER();
+    gSnapshotSeq = seq + 1;
+}
+
+/**
+ * @brief Extend a recent timestamp to the time base without wrap-around.
+ *
+ * @param[in] time_us Timestamp of chipinterface_get_time_microseconds() of the last 71 minutes.
+ * @return The same time as chipinterface_get_time_microseconds_64().
+ */
+static uint64_t sensor_extend_time(uint32_t time_us)
+{
+    uint64_t now_us = chipinterface_get_time_microseconds_64();
+
+    return now_us - (uint32_t)((uint32_t)now_us - time_us);
+}
+
+/**
+ * @brief Extrapolate the frame counter from the last frame.
+ *
+ * @param[in] time_us Current time.
+ * @return Frame counter of the frame the sensor measures at time_us.
+ */
+static uint32_t sensor_estimate_frame(uint32_t time_us)
+{
+    return gFrameCounter + (uint32_t)((sensor_extend_time(time_us) - gFrameUs) * gFrameRate / 1000000);
+}
+
+/**
+ * @brief Advance the presence state machine with a frame.
+ *
+ * Called by the sensor task for every frame before it is published.
+ *
+ * @param[in,out] snapshot Frame with detection state, frame counter and timestamp, receives the
+ *                         presence state.
+ */
+static void sensor_update_presence(sensor_snapshot_t *snapshot)
+{
+    if(gDetected || snapshot->detected)
+    {
+        // the scene is idle from the end of the last detection
+        gLastDetectionUs = snapshot->timestamp_us;
+    }
+    gDetected = snapshot->detected;
+    gFrameCounter = snapshot->frame_counter;
+    gFrameUs = sensor_extend_time(snapshot->timestamp_us);
+    x4sensor_presence_update(&gPresence, gDetected, gFrameCounter, snapshot->timestamp_us);
+    snapshot->presence = x4sensor_presence_is_present(&gPresence);
+}
+
+#ifdef SENSOR_EVENT_MODE
+/**
+ * @brief Read and publish the frame that caused the sensor interrupt.
+ *
+ * Used in event mode. Reads the frame payload, which also releases the interrupt line, and
+ * decodes the reported events, detection state and distance cluster.
+ *
+ * @param[out] snapshot Decoded frame.
+ * @return true if the frame was read, false otherwise.
+ */
+static bool sensor_publish_frame(sensor_snapshot_t *snapshot)
+{
+    x4sensor_distance_cluster_t cluster;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    chipinterface_get_time_microseconds(&snapshot->timestamp_us);
+    if(!x4sensor_get_sensor_data(gFrameBuffer, sizeof(gFrameBuffer)))
+    {
+        return false;
+    }
+    snapshot->events = x4sensor_get_events(gFrameBuffer);
+    snapshot->detected = x4sensor_get_detection_state(gFrameBuffer);
+    snapshot->frame_counter = x4sensor_get_frame_counter(gFrameBuffer);
+    snapshot->first_bin = 0xff;
+    if(x4sensor_get_distance_cluster(gFrameBuffer, &cluster) == X4SENSOR_SUCCESS)
+    {
+        memcpy(snapshot->cluster_power, cluster.bin_power, sizeof(snapshot->cluster_power));
+        if(cluster.detector_hit)
+        {
+            snapshot->first_bin = x4sensor_get_distance_cluster_first_bin_number(gFrameBuffer);
+            snapshot->first_distance_mm = cluster.first_detection_bin_distance_mm;
+        }
+        if(gTrackerActive)
+        {
+            x4sensor_tracker_update(&gTracker, &cluster, snapshot->frame_counter, &snapshot->track);
+        }
+    }
+    if(gZoneMaskCount)
+    {
+        uint32_t detections = x4sensor_get_detection_bin_mask(gFrameBuffer);
+        for(uint8_t zone = 0; zone < gZoneMaskCount; zone++)
+        {
+            if(detections & gZoneMasks[zone])
+            {
+                snapshot->zones |= (uint8_t)(1 << zone);
+            }
+        }
+    }
+    sensor_update_presence(snapshot);
+    sensor_publish_snapshot(snapshot);
+    return true;
+}
+#else
+/**
+ * @brief Publish the interrupt line state.
+ *
+ * Used in normal operation mode where the sensor reports the detection state on the
+ * interrupt line only and no frame data is read out. The frame counter is extrapolated from the
+ * frame rate.
+ *
+ * @param[out] snapshot Published snapshot.
+ */
+static void sensor_publish_irq_state(sensor_snapshot_t *snapshot)
+{
+    chipinterface_interrupt_state_t state;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    chipinterface_get_interrupt_state(&state);
+    chipinterface_get_time_microseconds(&snapshot->timestamp_us);
+    snapshot->detected = (state == chipinterface_interrupt_asserted);
+    snapshot->frame_counter = sensor_estimate_frame(snapshot->timestamp_us);
+    snapshot->first_bin = 0xff;
+    sensor_update_presence(snapshot);
+    sensor_publish_snapshot(snapshot);
+}
+#endif
+
+/**
+ * @brief Read the most recent sensor snapshot.
+ *
+ * Lock-free and safe to call from any task or callback. The copy is retried only if the
+ * sensor task published a new snapshot while it was being read.
+ *
+ * @param[out] snapshot Destination for the snapshot.
+ * @return true if a snapshot has been published since boot, false otherwise.
+ */
+bool sensor_get_snapshot(sensor_snapshot_t *snapshot)
+{
+    uint32_t seq;
+
+    do
+    {
+        seq = gSnapshotSeq;
+        SNAPSHOT_BARRIER();
+        *snapshot = gSnapshot[seq & 1];
+        SNAPSHOT_BARRIER();
+    } while (seq != gSnapshotSeq);
+
+    return (seq != 0);
+}
+
+/**
+ * @brief Queue a request for the sensor task.
+ *
+ * Timestamps the request and wakes the sensor task if it waits for the sensor. Never blocks,
+ * so it is safe in BLE callbacks.
+ *
+ * @param[in] event Request to queue, copied.
+ * @return true if the request was queued, false if the queue is full.
+ */
+static bool sensor_post_event(sensor_event_t *event)
+{
+    chipinterface_get_time_microseconds(&event->timestamp_us);
+    if(xQueueSend(sensorQueue, event, 0) != pdTRUE)
+    {
+        PORT_LOG_INFO("Sensor request %u dropped, queue full", event->type);
+        return false;
+    }
+    chipinterface_wake();
+    return true;
+}
+
+/**
+ * @brief Initialize the proximity sensor module.
+ *
+ * This function initializes the proximity sensor module, creating the request queue, and queues
+ * the initialization of the sensor in the sensor task.
+ *
+ * @param[in] callback Callback for the completion of requests, may be NULL. Runs in the sensor
+ *                     task once per request with the request type and its result.
+ */
+void sensor_init(sensor_done_callback callback)
+{
+    sensor_event_t event;
+
+    /* create the request queue before the first request, which may come before the scheduler
+     * and the sensor task start */
+    sensorQueue = xQueueCreate(SENSOR_EVENT_QUEUE_LENGTH, sizeof(sensor_event_t));
+    MAIN_ASSERT((sensorQueue != NULL), true);
+    gDone_cb = callback;
+    event.type = SENSOR_EVENT_INIT;
+    sensor_post_event(&event);
+}
+
+/**
+ * @brief Start the proximity sensor remotely.
+ *
+ * This function configures the sensor with sensitivity, range, and a callback for presence detection.
+ * The callback runs in the sensor task after every sensor interrupt and receives the published
+ * snapshot. A running sensor is restarted with the new values.
+ *
+ * @param[in] sensitivity Sensitivity level to set.
+ * @param[in] range Range value to set.
+ * @param[in] callback Callback function for presence detection.
+ * @return true if the request was queued, false otherwise.
+ */
+bool sensor_run_remote(uint8_t sensitivity, uint16_t range, presence_callback callback)
+{
+    sensor_event_t event;
+
+    event.type = SENSOR_EVENT_START;
+    event.payload.start.sensitivity = sensitivity;
+    event.payload.start.range = range;
+    event.payload.start.callback = callback;
+    return sensor_post_event(&event);
+}
+
+
+/**
+ * @brief Set custom detector thresholds and M-of-N presence logic.
+ *
+ * Validated right away and applied by the sensor task, a running sensor picks the values up
+ * with the next frame without a restart. The values are kept and reapplied on every start until
+ * sensor_clear_detector() is called. Completion is reported as SENSOR_EVENT_DETECTOR.
+ *
+ * @param[in] detector New detector configuration.
+ * @return true if the configuration was accepted, false otherwise.
+ */
+bool sensor_set_detector(const x4sensor_detector_config_t *detector)
+{
+    sensor_event_t event;
+    bool valid;
+
+    taskENTER_CRITICAL();
+    valid = gDetectorActiveValid && detector->threshold_count == gDetectorActive.threshold_count;
+    taskEXIT_CRITICAL();
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        valid = valid && detector->M[i] > 0 && detector->M[i] <= detector->N[i];
+    }
+    if(!valid)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    gDetector = *detector;
+    gDetectorCustom = true;
+    taskEXIT_CRITICAL();
+    event.type = SENSOR_EVENT_DETECTOR;
+    return sensor_post_event(&event);
+}
+
+/**
+ * @brief Read the detector thresholds and M-of-N presence logic.
+ *
+ * Returns the custom configuration while one is set, including values not yet applied by the
+ * sensor task, and the configuration of the sensor otherwise. Does not access the sensor.
+ *
+ * @param[out] detector Destination for the configuration.
+ * @param[out] custom   Set to true if the configuration is a custom one, may be NULL.
+ * @return true on success, false if the sensor is not initialized.
+ */
+bool sensor_get_detector(x4sensor_detector_config_t *detector, bool *custom)
+{
+    bool valid;
+
+    taskENTER_CRITICAL();
+    valid = gDetectorActiveValid;
+    *detector = gDetectorCustom ? gDetector : gDetectorActive;
+    if(custom)
+    {
+        *custom = gDetectorCustom;
+    }
+    taskEXIT_CRITICAL();
+    return valid;
+}
+
+/**
+ * @brief Read the sensor watchdog statistics.
+ *
+ * @param[out] health Destination for the statistics.
+ */
+void sensor_get_health(sensor_health_t *health)
+{
+    taskENTER_CRITICAL();
+    *health = gHealth;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Get the frame rate of the sensor.
+ *
+ * @return Frame rate the sensor runs at in frames per second, lowered while the scene is idle,
+ *         0 before the first start.
+ */
+uint8_t sensor_get_frame_rate(void)
+{
+    return gFrameRate;
+}
+
+/**
+ * @brief Restore the sensor state of the last boot.
+ *
+ * Called before sensor_init(). The initialization compares the identity of the sensor with the
+ * restored one. For the same sensor it skips the oscillator measurement at the first start and
+ * keeps the custom detector values, for another sensor both are discarded.
+ *
+ * @param[in] metadata Identity and oscillator calibration of the last boot.
+ * @param[in] detector Custom detector values of the last boot, NULL if none were set.
+ */
+void sensor_restore(const sensor_metadata_t *metadata, const x4sensor_detector_config_t *detector)
+{
+    taskENTER_CRITICAL();
+    gMetadata = *metadata;
+    if(detector)
+    {
+        gDetector = *detector;
+        gDetectorCustom = true;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Read the identity and oscillator calibration of the sensor.
+ *
+ * @param[out] metadata Destination for the metadata.
+ */
+void sensor_get_metadata(sensor_metadata_t *metadata)
+{
+    taskENTER_CRITICAL();
+    *metadata = gMetadata;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Apply the stored calibration to a discovered sensor.
+ *
+ * Called by the sensor task after every discovery of the sensor. The oscillator correction is
+ * restored if the sensor is the one it was measured on, otherwise the metadata moves to the new
+ * sensor and the calibration is discarded.
+ */
+static void sensor_restore_calibration(void)
+{
+    const x4sensor_info_t *info = x4sensor_get_info();
+
+    if(!info)
+    {
+        return;
+    }
+    if(info->sample_id == gMetadata.sample_id && info->chip_revision == gMetadata.chip_revision)
+    {
+        if(gMetadata.lposc_correction && x4sensor_set_lposc_correction(gMetadata.lposc_correction) != X4SENSOR_SUCCESS)
+        {
+            gMetadata.lposc_correction = 0;
+        }
+        return;
+    }
+    if(gMetadata.sample_id)
+    {
+        PORT_LOG_INFO("Sensor 0x%X replaced, calibration discarded", gMetadata.sample_id);
+    }
+    taskENTER_CRITICAL();
+    if(gMetadata.sample_id)
+    {
+        gDetectorCustom = false;
+    }
+    gMetadata.sample_id = info->sample_id;
+    gMetadata.chip_revision = info->chip_revision;
+    gMetadata.lposc_correction = 0;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Record the oscillator correction of a started sensor.
+ *
+ * Called by the sensor task after every start.
+ */
+static void sensor_store_calibration(void)
+{
+    uint32_t correction = x4sensor_get_lposc_correction();
+
+    taskENTER_CRITICAL();
+    gMetadata.lposc_correction = correction;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Return to the detector configuration of the sensitivity level.
+ *
+ * Takes effect at the next sensor start.
+ */
+void sensor_clear_detector(void)
+{
+    gDetectorCustom = false;
+}
+
+/**
+ * @brief Calibrate the detector to the empty scene remotely.
+ *
+ * The sensor task stops the sensor if needed, records the scene for the given time, derives
+ * one threshold per detector bin from the background power and keeps the result as custom
+ * detector configuration, as if set with sensor_set_detector(). The M-of-N values of the
+ * current sensitivity level are kept. Queue a start afterwards to resume operation.
+ *
+ * @param[in] seconds Calibration time, nobody should be in range meanwhile.
+ * @return true if the request was queued, false otherwise.
+ */
+bool sensor_calibrate_remote(uint16_t seconds)
+{
+    sensor_event_t event;
+
+    event.type = SENSOR_EVENT_CALIBRATE;
+    event.payload.calibration_seconds = seconds;
+    return sensor_post_event(&event);
+}
+
+/**
+ * @brief Set the distance zones reported in the snapshot.
+ *
+ * The zones are mapped to detector range bins at the next start. Each frame then reports the
+ * zones that contain a detector bin above its threshold. Only event mode reads frames, and
+ * while zones are set every frame is reported instead of state changes and the heartbeat.
+ *
+ * @param[in] zones Zones, may overlap.
+ * @param[in] count Number of zones, 0 to disable zones.
+ * @return true if the zones are valid, false otherwise.
+ */
+bool sensor_set_zones(const sensor_zone_t *zones, uint8_t count)
+{
+    if(count > SENSOR_MAX_ZONES)
+    {
+        return false;
+    }
+    for(uint8_t zone = 0; zone < count; zone++)
+    {
+        if(zones[zone].from_cm >= zones[zone].to_cm)
+        {
+            return false;
+        }
+    }
+    taskENTER_CRITICAL();
+    memcpy(gZones, zones, count * sizeof(sensor_zone_t));
+    gZoneCount = count;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+/**
+ * @brief Enable tracking of the nearest target.
+ *
+ * Takes effect at the next start. The tracker estimates distance and radial velocity of the
+ * target from every frame and classifies it as approaching or leaving, see snapshot->track.
+ * Only event mode reads frames, and while tracking is enabled every frame is reported.
+ *
+ * @param[in] enable true to track the target, false otherwise.
+ */
+void sensor_set_tracking(bool enable)
+{
+    gTracking = enable;
+}
+
+/**
+ * @brief Set the presence hysteresis.
+ *
+ * Applied by the sensor task, a running sensor uses the values for the pending transition
+ * without a restart. The values are kept across restarts. Completion is reported as
+ * SENSOR_EVENT_PRESENCE.
+ *
+ * @param[in] setup Enter and exit hysteresis in frames and milliseconds.
+ * @return true if the request was queued, false otherwise.
+ */
+bool sensor_set_presence(const x4sensor_presence_setup_t *setup)
+{
+    sensor_event_t event;
+
+    event.type = SENSOR_EVENT_PRESENCE;
+    event.payload.presence = *setup;
+    return sensor_post_event(&event);
+}
+
+/**
+ * @brief Stop the proximity sensor remotely.
+ *
+ * This function queues the stop of the sensor. The sensor task stops the sensor, switches the
+ * interrupt back to rising edge and reports the completion.
+ *
+ * @return true if the request was queued, false otherwise.
+ */
+bool sensor_stop_remote(void)
+{
+    sensor_event_t event;
+
+    event.type = SENSOR_EVENT_STOP;
+    return sensor_post_event(&event);
+}
+
+/**
+ * @brief Stop the sensor.
+ *
+ * Called by the sensor task. Switches the interrupt back to rising edge to be able to restart
+ * the sensor and ends a pending recovery.
+ *
+ * @return X4SENSOR_SUCCESS on success, otherwise an error code.
+ */
+static x4sensor_error_t sensor_stop(void)
+{
+    x4sensor_error_t status;
+
+    gRunning = false;
+    // Switch interrupt back to rising edge to be able to restart the sensor
+    chipinterface_set_interrupt_edges(false);
+
+    taskENTER_CRITICAL();
+    gHealth.recovering = false;
+    taskEXIT_CRITICAL();
+    status = x4sensor_stop();
+    // a calibration and the next start run at the full frame rate
+    x4sensor_set_frame_rate_divider(1);
+    return status;
+}
+
+/**
+ * @brief Refresh the detector configuration read by other tasks.
+ *
+ * Called by the sensor task whenever the sensor may have changed its detector configuration.
+ */
+static void sensor_refresh_detector(void)
+{
+    x4sensor_detector_config_t detector;
+
+    if(x4sensor_get_detector_config(&detector) == X4SENSOR_SUCCESS)
+    {
+        taskENTER_CRITICAL();
+        gDetectorActive = detector;
+        gDetectorActiveValid = true;
+        taskEXIT_CRITICAL();
+    }
+}
+
+
+/**
+ * @brief Run the background calibration in recording mode.
+ *
+ * Called by the sensor task while the sensor is stopped. Reads frames until the calibration
+ * is complete and applies the resulting thresholds.
+ *
+ * @param[in] seconds Calibration time.
+ * @return true if the thresholds were applied, false otherwise.
+ */
+static bool sensor_run_calibration(uint16_t seconds)
+{
+    x4sensor_calibration_setup_t setup;
+    x4sensor_detector_config_t detector;
+    uint16_t report_interval;
+    uint32_t frames;
+    bool calibrated = false;
+
+    // the first frame only initializes the static background
+    frames = (uint32_t)seconds * x4sensor_get_frame_rate() + 1;
+    setup.frames = (frames > UINT16_MAX) ? UINT16_MAX : (uint16_t)frames;
+    setup.power_shift = SENSOR_CALIBRATION_POWER_SHIFT;
+    setup.sigma_q4 = SENSOR_CALIBRATION_SIGMA_Q4;
+    setup.margin_percent = SENSOR_CALIBRATION_MARGIN_PERCENT;
+    if(x4sensor_get_max_sensor_data_size_recording_mode() > sizeof(gRecordingBuffer) ||
+       x4sensor_begin_calibration(&gCalibration, &setup) != X4SENSOR_SUCCESS)
+    {
+        return false;
+    }
+
+    // recording mode reports every frame, restore the interval used by event mode
+    report_interval = x4sensor_get_periodic_report_interval();
+    if(x4sensor_start_recording_mode() != X4SENSOR_SUCCESS)
+    {
+        return false;
+    }
+    while(!x4sensor_calibration_is_complete(&gCalibration))
+    {
+        size_t size;
+
+        if(chipinterface_wait_for_interrupt(SENSOR_FRAME_TIMEOUT_US) != CHIPINTERFACE_SUCCESS)
+        {
+            break;
+        }
+        size = x4sensor_get_sensor_data(gRecordingBuffer, sizeof(gRecordingBuffer));
+        if(!size || x4sensor_calibration_add_frame(&gCalibration, gRecordingBuffer, size) != X4SENSOR_SUCCESS)
+        {
+            break;
+        }
+    }
+    x4sensor_stop();
+    x4sensor_set_periodic_report_interval(report_interval);
+
+    if(x4sensor_get_detector_config(&detector) == X4SENSOR_SUCCESS &&
+       x4sensor_calibration_get_thresholds(&gCalibration, &detector) == X4SENSOR_SUCCESS &&
+       x4sensor_set_detector_config(&detector) == X4SENSOR_SUCCESS)
+    {
+        taskENTER_CRITICAL();
+        gDetector = detector;
+        gDetectorCustom = true;
+        taskEXIT_CRITICAL();
+        calibrated = true;
+    }
+    return calibrated;
+}
+
+/**
+ * @brief Configure and start the sensor.
+ *
+ * Called by the sensor task. Applies the selected configuration, range, sensitivity and custom
+ * detector values and starts the sensor in the operation mode of the build.
+ *
+ * @return X4SENSOR_SUCCESS on success, otherwise the error of the failed step.
+ */
+static x4sensor_error_t sensor_start(void)
+{
+    x4sensor_error_t status;
+    x4sensor_detector_config_t detector;
+    bool custom;
+#ifdef SENSOR_EVENT_MODE
+    sensor_zone_t zones[SENSOR_MAX_ZONES];
+    uint16_t report_interval;
+#endif
+
+    gFrameRate = x4sensor_get_frame_rate();
+    if(!gFrameRate)
+    {
+        return x4sensor_get_last_error();
+    }
+    // the presence state carries over a restart, frames are counted on from the start
+    x4sensor_presence_configure(&gPresence, &gPresenceSetup, gFrameRate);
+    gFrameUs = chipinterface_get_time_microseconds_64();
+    gFrameRateDivider = 1;
+    gLastDetectionUs = (uint32_t)gFrameUs;
+
+    status = x4sensor_set_range_cm(gRange);
+    if(status == X4SENSOR_SUCCESS)
+    {
+        status = x4sensor_set_sensitivity_level(gSensitivity);
+    }
+    if(status != X4SENSOR_SUCCESS)
+    {
+        return status;
+    }
+    taskENTER_CRITICAL();
+    custom = gDetectorCustom;
+    detector = gDetector;
+    taskEXIT_CRITICAL();
+    if(custom && x4sensor_set_detector_config(&detector) != X4SENSOR_SUCCESS)
+    {
+        gDetectorCustom = false;
+        PORT_LOG_INFO("Custom detector configuration rejected, using sensitivity level %u", gSensitivity);
+    }
+    sensor_refresh_detector();
+#ifdef SENSOR_EVENT_MODE
+    PORT_LOG_INFO("Starting event mode. Range: %u cm, sensitivity level: %u",
+                  gRange, gSensitivity);
+    // Report state changes and a periodic heartbeat, or every frame if zones are set
+    // or tracking is enabled.
+    // The sensor holds the irq line until the frame is read, so the rising edge
+    // interrupt is kept.
+    taskENTER_CRITICAL();
+    gZoneMaskCount = gZoneCount;
+    memcpy(zones, gZones, sizeof(zones));
+    taskEXIT_CRITICAL();
+    for(uint8_t zone = 0; zone < gZoneMaskCount; zone++)
+    {
+        if(x4sensor_get_range_bin_mask(zones[zone].from_cm, zones[zone].to_cm, &gZoneMasks[zone]) != X4SENSOR_SUCCESS)
+        {
+            gZoneMasks[zone] = 0;
+        }
+    }
+    gTrackerActive = false;
+    if(gTracking)
+    {
+        x4sensor_tracker_setup_t tracking;
+
+        tracking.alpha_q8 = SENSOR_TRACKER_ALPHA_Q8;
+        tracking.beta_q8 = SENSOR_TRACKER_BETA_Q8;
+        tracking.speed_mm_s = SENSOR_TRACKER_SPEED_MM_S;
+        tracking.coast_frames = SENSOR_TRACKER_COAST_FRAMES;
+        gTrackerActive = (x4sensor_begin_tracking(&gTracker, &tracking) == X4SENSOR_SUCCESS);
+    }
+    report_interval = (gZoneMaskCount || gTrackerActive) ? SENSOR_FRAME_REPORT_INTERVAL :
+                      SENSOR_HEARTBEAT_SECONDS * gFrameRate;
+    x4sensor_set_periodic_report_interval(report_interval);
+    // Every report is a heartbeat. Allow for the tolerance of the X4 low power oscillator.
+    gHeartbeatTimeoutUs = (uint32_t)((uint64_t)report_interval * 1000000 / gFrameRate *
+                                     SENSOR_HEARTBEAT_MARGIN_PERCENT / 100) + SENSOR_FRAME_TIMEOUT_US;
+    gLastFrameUs = chipinterface_get_time_microseconds_64();
+    status = x4sensor_start_event_mode(X4SENSOR_EVENT_STATE_CHANGE | X4SENSOR_EVENT_PERIODIC_REPORT);
+#else
+    PORT_LOG_INFO("Starting normal operation mode. Range: %u cm, sensitivity level: %u",
+                  gRange, gSensitivity);
+    status = x4sensor_start_normal_mode();
+
+    // Switch interrupt to both edges so we don't have to poll the irq line
+    // this will trigger an interrupt once the irq line goes down which will restart the proximity timer
+    chipinterface_set_interrupt_edges(true);
+#endif
+    if(status == X4SENSOR_SUCCESS)
+    {
+        sensor_store_calibration();
+        PORT_LOG_INFO("Frame rate %u fps, detection latency %u ms", gFrameRate,
+                      x4sensor_get_detection_latency_us() / 1000);
+#ifndef SENSOR_EVENT_MODE
+        // no frame is read, the interrupt line reports the detection state from the first frame
+        boot_mark_at(BOOT_FIRST_FRAME, chipinterface_get_time_microseconds_64() + 1000000 / gFrameRate);
+#endif
+    }
+
+    return status;
+}
+
+/**
+ * @brief Prepare the discovered sensor for its first start.
+ *
+ * Called by the sensor task after the discovery at boot, while the BLE stack comes up in its own
+ * task. Uploads the firmware of the configuration and calibrates the oscillator unless
+ * the restored calibration applies, so the first start only writes the configuration. A failure
+ * is left to the first start, which then reports it and recovers the sensor.
+ */
+static void sensor_prepare(void)
+{
+    x4sensor_error_t status;
+
+    if(!SENSOR_PREPARE_HOLD_MS)
+    {
+        return;
+    }
+    status = x4sensor_prepare();
+    if(status != X4SENSOR_SUCCESS)
+    {
+        PORT_LOG_INFO("Sensor preparation failed: %s", x4sensor_convert_error_to_string(status));
+        return;
+    }
+    sensor_store_calibration();
+    boot_mark(BOOT_SENSOR_PREPARED);
+}
+
+/**
+ * @brief Record a failure of the running sensor.
+ *
+ * Called by the sensor task. The sensor task then recovers the sensor before it waits for
+ * frames again.
+ *
+ * @param[in] since_us Time of the last good frame or of the failure.
+ */
+static void sensor_fail(uint32_t since_us)
+{
+    if(gHealth.recovering)
+    {
+        return;
+    }
+    taskENTER_CRITICAL();
+    gHealth.failures++;
+    gHealth.recovering = true;
+    taskEXIT_CRITICAL();
+    gFailureUs = sensor_extend_time(since_us);
+    gBackoffMs = SENSOR_RECOVERY_BACKOFF_MIN_MS;
+}
+
+/**
+ * @brief Record that the sensor runs again after a failure.
+ *
+ * Called by the sensor task.
+ */
+static void sensor_recovered(void)
+{
+    uint64_t now_us = chipinterface_get_time_microseconds_64();
+
+    taskENTER_CRITICAL();
+    gHealth.recoveries++;
+    gHealth.last_downtime_ms = (uint32_t)((now_us - gFailureUs) / 1000);
+    gHealth.downtime_ms += gHealth.last_downtime_ms;
+    gHealth.recovering = false;
+    taskEXIT_CRITICAL();
+    PORT_LOG_INFO("Sensor recovered after %u ms, %u failures, %u recoveries, downtime %u ms",
+                  gHealth.last_downtime_ms, gHealth.failures, gHealth.recoveries, gHealth.downtime_ms);
+}
+
+/**
+ * @brief Try to recover the sensor after a missed heartbeat or a failure.
+ *
+ * Called by the sensor task while a failure is recorded. Re-initializes the sensor, which uploads
+ * the firmware again at the start, and restores configuration, range, sensitivity and custom
+ * detector values. After a failed attempt it waits for the backoff delay, which doubles with
+ * every attempt. A request ends the wait early so it is never held up by the recovery.
+ */
+static void sensor_recover(void)
+{
+    sensor_event_t event;
+    x4sensor_error_t status;
+
+    status = x4sensor_reinitialize();
+    if(status == X4SENSOR_SUCCESS)
+    {
+        sensor_restore_calibration();
+        status = sensor_start();
+    }
+    if(status == X4SENSOR_SUCCESS)
+    {
+        sensor_recovered();
+        return;
+    }
+    PORT_LOG_INFO("Sensor recovery failed: %s, retry in %u ms", x4sensor_convert_error_to_string(status), gBackoffMs);
+    xQueuePeek(sensorQueue, &event, pdMS_TO_TICKS(gBackoffMs));
+    gBackoffMs = (gBackoffMs * 2 > SENSOR_RECOVERY_BACKOFF_MAX_MS) ? SENSOR_RECOVERY_BACKOFF_MAX_MS : gBackoffMs * 2;
+}
+
+/**
+ * @brief Advance the presence state machine without a frame.
+ *
+ * Called by the sensor task when no frame arrived. The detection state of the last frame still
+ * holds, so a transition that is due completes and is passed to the application as a snapshot
+ * of the last frame.
+ */
+static void sensor_poll_presence(void)
+{
+    sensor_snapshot_t snapshot;
+    bool present = x4sensor_presence_is_present(&gPresence);
+    uint32_t now_us;
+
+    chipinterface_get_time_microseconds(&now_us);
+    x4sensor_presence_update(&gPresence, gDetected, sensor_estimate_frame(now_us), now_us);
+    if(x4sensor_presence_is_present(&gPresence) == present)
+    {
+        return;
+    }
+    sensor_get_snapshot(&snapshot);
+    snapshot.presence = !present;
+    snapshot.zones = 0;
+    snapshot.track.direction_changed = false;
+    snapshot.timestamp_us = now_us;
+    sensor_publish_snapshot(&snapshot);
+    if(gPresence_cb)
+    {
+        gPresence_cb(&snapshot);
+    }
+}
+
+/**
+ * @brief Change the frame rate divider of the running sensor.
+ *
+ * Called by the sensor task. The presence hysteresis and, in event mode, the heartbeat timeout
+ * follow the new frame rate, as both are counted in frames.
+ *
+ * @param[in] divider Divider of the full frame rate.
+ * @param[in] now_us  Current time.
+ */
+static void sensor_set_frame_rate_divider(uint8_t divider, uint32_t now_us)
+{
+    x4sensor_error_t status;
+
+    status = x4sensor_set_frame_rate_divider(divider);
+    if(status != X4SENSOR_SUCCESS)
+    {
+        PORT_LOG_INFO("Frame rate change failed: %s", x4sensor_convert_error_to_string(status));
+        // the sensor is disabled after a failed write
+        sensor_fail(now_us);
+        return;
+    }
+    // frames are counted on at the new rate from now
+    gFrameCounter = sensor_estimate_frame(now_us);
+    gFrameUs = sensor_extend_time(now_us);
+    gFrameRateDivider = divider;
+    gFrameRate = x4sensor_get_frame_rate() / divider;
+    x4sensor_presence_configure(&gPresence, &gPresenceSetup, gFrameRate);
+#ifdef SENSOR_EVENT_MODE
+    gHeartbeatTimeoutUs = (uint32_t)((uint64_t)x4sensor_get_periodic_report_interval() * 1000000 / gFrameRate *
+                                     SENSOR_HEARTBEAT_MARGIN_PERCENT / 100) + SENSOR_FRAME_TIMEOUT_US;
+#endif
+    PORT_LOG_INFO("Frame rate %u fps, detection latency %u ms", gFrameRate,
+                  x4sensor_get_detection_latency_us() / 1000);
+}
+
+/**
+ * @brief Get the time until the sensor is idle.
+ *
+ * @param[in] now_us Current time.
+ * @return Time until the frame rate is lowered, PORT_WAIT_FOREVER_US if it is not lowered.
+ */
+static uint32_t sensor_get_idle_remaining_us(uint32_t now_us)
+{
+    uint32_t elapsed_us = now_us - gLastDetectionUs;
+
+    if(!SENSOR_IDLE_AFTER_SECONDS || gFrameRateDivider != 1 || gDetected)
+    {
+        return PORT_WAIT_FOREVER_US;
+    }
+    return (elapsed_us < SENSOR_IDLE_AFTER_SECONDS * 1000000UL) ? SENSOR_IDLE_AFTER_SECONDS * 1000000UL - elapsed_us : 0;
+}
+
+/**
+ * @brief Lower the frame rate while the scene is idle and restore it at the first detection.
+ *
+ * Called by the sensor task after every frame and wake-up of the running sensor.
+ *
+ * @param[in] now_us Current time.
+ */
+static void sensor_update_frame_rate(uint32_t now_us)
+{
+    uint8_t full_rate = x4sensor_get_frame_rate();
+    uint8_t divider;
+
+    if(gDetected)
+    {
+        if(gFrameRateDivider != 1)
+        {
+            sensor_set_frame_rate_divider(1, now_us);
+        }
+        return;
+    }
+    if(sensor_get_idle_remaining_us(now_us) || !full_rate)
+    {
+        return;
+    }
+    // the smallest divider of the full rate that reaches the idle rate
+    for(divider = 1; divider < full_rate; divider++)
+    {
+        if(full_rate % divider == 0 && full_rate / divider <= SENSOR_IDLE_FRAME_RATE)
+        {
+            break;
+        }
+    }
+    if(divider != 1)
+    {
+        sensor_set_frame_rate_divider(divider, now_us);
+    }
+}
+
+/**
+ * @brief Wait for the next frame of the running sensor and pass it to the application.
+ *
+ * Called by the sensor task. A new request ends the wait early, a pending presence transition
+ * ends it when it is due.
+ */
+static void sensor_run_frame(void)
+{
+    uint32_t now_us;
+    uint32_t wait_us;
+    uint32_t presence_us;
+    uint32_t idle_us;
+#ifdef SENSOR_EVENT_MODE
+    uint64_t elapsed_us;
+
+    // wait no longer than the next heartbeat is due
+    chipinterface_get_time_microseconds(&now_us);
+    elapsed_us = chipinterface_get_time_microseconds_64() - gLastFrameUs;
+    wait_us = (elapsed_us < gHeartbeatTimeoutUs) ? gHeartbeatTimeoutUs - (uint32_t)elapsed_us : 1;
+#else
+    chipinterface_get_time_microseconds(&now_us);
+    wait_us = PORT_WAIT_FOREVER_US;
+#endif
+    // the wait is rounded down to ticks, round up to end it no earlier than the transition
+    presence_us = x4sensor_presence_get_remaining_us(&gPresence, now_us);
+    if(presence_us != PORT_WAIT_FOREVER_US && presence_us < wait_us)
+    {
+        wait_us = presence_us + 1000;
+    }
+    idle_us = sensor_get_idle_remaining_us(now_us);
+    if(idle_us != PORT_WAIT_FOREVER_US && idle_us < wait_us)
+    {
+        wait_us = idle_us + 1000;
+    }
+    //pend on irq semaphore
+    if(chipinterface_wait_for_interrupt_or_wake(wait_us) == CHIPINTERFACE_SUCCESS)
+    {
+        sensor_snapshot_t snapshot;
+#ifdef SENSOR_EVENT_MODE
+        if(!sensor_publish_frame(&snapshot))
+        {
+            PORT_LOG_INFO("Sensor read failed: %s", x4sensor_convert_error_to_string(x4sensor_get_last_error()));
+            sensor_fail(snapshot.timestamp_us);
+            return;
+        }
+        gLastFrameUs = sensor_extend_time(snapshot.timestamp_us);
+        boot_mark(BOOT_FIRST_FRAME);
+#else
+        sensor_publish_irq_state(&snapshot);
+#endif
+
+        //irq happened report back to application
+        if(gPresence_cb)
+        {
+            gPresence_cb(&snapshot);
+        }
+        sensor_update_frame_rate(snapshot.timestamp_us);
+        return;
+    }
+    // the wait also ends early for requests and chip disables
+    sensor_poll_presence();
+    chipinterface_get_time_microseconds(&now_us);
+#ifdef SENSOR_EVENT_MODE
+    // only a late heartbeat counts
+    if(chipinterface_get_time_microseconds_64() - gLastFrameUs >= gHeartbeatTimeoutUs)
+    {
+        PORT_LOG_INFO("Sensor heartbeat missed");
+        sensor_fail((uint32_t)gLastFrameUs);
+        return;
+    }
+#endif
+    sensor_update_frame_rate(now_us);
+}
+
+/**
+ * @brief Execute a request in the sensor task and report its completion.
+ *
+ * @param[in] event Request received from the queue.
+ */
+static void sensor_process_event(const sensor_event_t *event)
+{
+    x4sensor_error_t status = X4SENSOR_SUCCESS;
+
+    switch(event->type)
+    {
+        case SENSOR_EVENT_INIT:
+        {
+            const x4sensor_info_t *sensor_info;
+
+            status = SENSOR_INITIALIZE(x4sensor_configuration_blob, x4sensor_configuration_blob_size);
+            MAIN_ASSERT(status, X4SENSOR_SUCCESS);
+
+            sensor_restore_calibration();
+            sensor_info = x4sensor_get_info();
+            PORT_LOG_INFO("*** Novelda Sensor ID: 0x%X Chip Version: %d ***", sensor_info->sample_id, sensor_info->chip_revision);
+            boot_mark(BOOT_SENSOR_DISCOVERED);
+#ifdef RECORDING_BENCHMARK
+            recording_benchmark_run();
+#endif
+            sensor_refresh_detector();
+            sensor_prepare();
+            break;
+        }
+
+        case SENSOR_EVENT_START:
+            if(gRunning)
+            {
+                sensor_stop();
+            }
+            gSensitivity = event->payload.start.sensitivity;
+            gRange = event->payload.start.range;
+            gPresence_cb = event->payload.start.callback;
+            status = sensor_start();
+            gRunning = true;
+            if(status != X4SENSOR_SUCCESS)
+            {
+                PORT_LOG_INFO("Sensor start failed: %s", x4sensor_convert_error_to_string(status));
+                // the sensor is down since it was requested to run
+                sensor_fail(event->timestamp_us);
+            }
+            break;
+
+        case SENSOR_EVENT_STOP:
+            if(gRunning)
+            {
+                status = sensor_stop();
+            }
+            x4sensor_presence_reset(&gPresence);
+            break;
+
+        case SENSOR_EVENT_CALIBRATE:
+            if(gRunning)
+            {
+                sensor_stop();
+            }
+            PORT_LOG_INFO("Calibrating detector for %u seconds", event->payload.calibration_seconds);
+            if(sensor_run_calibration(event->payload.calibration_seconds))
+            {
+                PORT_LOG_INFO("Calibration done after %u frames", gCalibration.frames);
+            }
+            else
+            {
+                PORT_LOG_INFO("Calibration failed, detector configuration unchanged");
+                status = X4SENSOR_FAILURE;
+            }
+            sensor_refresh_detector();
+            break;
+
+        case SENSOR_EVENT_DETECTOR:
+            // a failed sensor gets the values at the restart of the recovery
+            if(gDetectorCustom && !gHealth.recovering)
+            {
+                x4sensor_detector_config_t detector;
+
+                taskENTER_CRITICAL();
+                detector = gDetector;
+                taskEXIT_CRITICAL();
+                status = x4sensor_set_detector_config(&detector);
+                sensor_refresh_detector();
+            }
+            break;
+
+        case SENSOR_EVENT_PRESENCE:
+            gPresenceSetup = event->payload.presence;
+            // the frame rate is known once the sensor was started
+            if(gFrameRate)
+            {
+                status = x4sensor_presence_configure(&gPresence, &gPresenceSetup, gFrameRate);
+            }
+            break;
+
+        default:
+            return;
+    }
+    if(gDone_cb)
+    {
+        gDone_cb((sensor_event_type_t)event->type, status);
+    }
+}
+
+/**
+ * @brief Sensor running thread.
+ *
+ * This thread owns the sensor. It processes the queued requests in order and, in between,
+ * sensor events and presence detection while the sensor is active.
+ *
+ * @param[in] pvParameter Unused thread parameter.
+ */
+void sensor_run_thread(void * pvParameter)
+{
+    sensor_event_t event;
+
+    while (1)
+    {
+        if(gRunning && gHealth.recovering)
+        {
+            sensor_recover();
+        }
+        else if(gRunning)
+        {
+            sensor_run_frame();
+        }
+        else if(x4sensor_is_prepared())
+        {
+            // a prepared sensor waits powered for its first start, but not forever
+            if(xQueuePeek(sensorQueue, &event, pdMS_TO_TICKS(SENSOR_PREPARE_HOLD_MS)) != pdTRUE)
+            {
+                x4sensor_stop();
+                PORT_LOG_INFO("Prepared sensor not started, powered down");
+            }
+        }
+        else
+        {
+            // stopped, sleep until the next request
+            xQueuePeek(sensorQueue, &event, portMAX_DELAY);
+        }
+        while(xQueueReceive(sensorQueue, &event, 0) == pdTRUE)
+        {
+            sensor_process_event(&event);
+        }
+    }
+}
@@ -0,0 +1,146 @@
+/*
+ * novelda_sensor.h
+ *
+ *  Created on: Jun 29, 2022
+ *      Author: null
+ */
+
+#ifndef NOVELDA_SENSOR_H_
+#define NOVELDA_SENSOR_H_
+#include <novelda_x4sensor.h>
+
+
+
+
+/* Background calibration, see x4sensor_calibration_setup_t. The power shift and margins depend
+ * on the algorithm and may be tuned on recordings with tools/calibration. */
+#define SENSOR_CALIBRATION_POWER_SHIFT      4
+#define SENSOR_CALIBRATION_SIGMA_Q4         64      // 4 standard deviations
+#define SENSOR_CALIBRATION_MARGIN_PERCENT   150
+
+/* Target tracking, see x4sensor_tracker_setup_t */
+#define SENSOR_TRACKER_ALPHA_Q8             128     // 0.5
+#define SENSOR_TRACKER_BETA_Q8              32      // 0.125
+#define SENSOR_TRACKER_SPEED_MM_S           150     // walking slowly towards the sensor
+#define SENSOR_TRACKER_COAST_FRAMES         10
+
+/* Sensor watchdog, recovery attempts back off exponentially between these delays */
+#define SENSOR_RECOVERY_BACKOFF_MIN_MS      100
+#define SENSOR_RECOVERY_BACKOFF_MAX_MS      10000
+
+/* Idle frame rate. After SENSOR_IDLE_AFTER_SECONDS without a detection the sensor runs at no more
+ * than SENSOR_IDLE_FRAME_RATE frames per second, the first detection restores the full rate.
+ * 0 seconds keeps the full rate. */
+#define SENSOR_IDLE_AFTER_SECONDS           30
+#define SENSOR_IDLE_FRAME_RATE              2
+
+/* Boot preparation. After the discovery at boot the sensor task uploads the firmware and
+ * calibrates the oscillator while the BLE stack comes up, so the first start is fast. A prepared
+ * sensor that is not started within SENSOR_PREPARE_HOLD_MS is powered down again, 0 does not
+ * prepare the sensor. */
+#define SENSOR_PREPARE_HOLD_MS              60000
+
+#define MAIN_ASSERT(action, expected)                          \
+do{ \
+   if (action != expected) {                                  \
+     PORT_ASSERT_FAILED();} }                                        \
+while (0)
+
+/**
+ * @brief Snapshot of the most recent sensor frame.
+ *
+ * Published by the sensor task after every sensor interrupt and readable from any task or
+ * BLE callback through sensor_get_snapshot() without locking and without bus access.
+ * In normal operation mode no frame data is read out, so only the detection and presence state,
+ * the timestamp and a frame counter extrapolated from the frame rate are updated, first_bin
+ * stays at 0xff, zones at 0 and track invalid. In event mode (SENSOR_EVENT_MODE) every field is
+ * decoded from the frame that caused the interrupt. A snapshot is also published when the
+ * presence hysteresis completes between frames, it then repeats the last frame without zones.
+ */
+typedef struct
+{
+    bool     presence;                                  // presence state after the hysteresis
+    bool     detected;                                  // detection state of the sensor
+    uint8_t  first_bin;                                 // first bin above threshold, 0xff if none
+    uint16_t first_distance_mm;                         // distance to first_bin, 0 if none
+    uint32_t cluster_power[DISTANCE_CLUSTER_LENGTH];    // distance cluster power per bin
+    uint32_t frame_counter;                             // sensor frame counter
+    x4sensor_event_flags_t events;                      // events that caused the report, 0 in normal mode
+    uint8_t  zones;                                     // bit n set if zone n has a detection in this frame
+    x4sensor_track_t track;                             // tracked target, invalid unless tracking is enabled
+    uint32_t timestamp_us;                              // chipinterface time of the update
+} sensor_snapshot_t;
+
+/**
+ * @brief Distance zone, see sensor_set_zones().
+ */
+typedef struct
+{
+    uint16_t from_cm;                                   // start of the zone
+    uint16_t to_cm;                                     // end of the zone, exclusive
+} sensor_zone_t;
+
+#define SENSOR_MAX_ZONES 8
+
+/**
+ * @brief Sensor watchdog statistics, see sensor_get_health().
+ *
+ * The sensor task recovers the sensor after a failed start, a failed frame read or, in event
+ * mode, a missed periodic report. Downtime is counted from the last good frame or the failure
+ * until the sensor runs again.
+ */
+typedef struct
+{
+    uint32_t failures;                                  // detected failures
+    uint32_t recoveries;                                // successful recoveries
+    uint32_t downtime_ms;                               // total downtime of all recoveries
+    uint32_t last_downtime_ms;                          // downtime of the last recovery
+    bool     recovering;                                // a recovery is in progress
+} sensor_health_t;
+
+/**
+ * @brief Identity and oscillator calibration of the sensor, see sensor_restore().
+ *
+ * Known once the sensor was initialized, the oscillator correction once it was started.
+ */
+typedef struct
+{
+    uint32_t sample_id;                                 // serial number of the sensor, 0 if unknown
+    uint8_t  chip_revision;                             // revision of the sensor
+    uint32_t lposc_correction;                          // see x4sensor_get_lposc_correction(), 0 if unknown
+} sensor_metadata_t;
+
+/**
+ * @brief Type of a sensor task request, see sensor_done_callback.
+ */
+typedef enum
+{
+    SENSOR_EVENT_INIT,                                  // initialize the sensor
+    SENSOR_EVENT_START,                                 // start or restart the sensor
+    SENSOR_EVENT_STOP,                                  // stop the sensor
+    SENSOR_EVENT_CALIBRATE,                             // calibrate the detector
+    SENSOR_EVENT_DETECTOR,                              // apply the custom detector configuration
+    SENSOR_EVENT_PRESENCE,                              // apply the presence hysteresis
+} sensor_event_type_t;
+
+typedef void (*presence_callback)(const sensor_snapshot_t *snapshot);
+/* Completion of a request, runs in the sensor task */
+typedef void (*sensor_done_callback)(sensor_event_type_t type, x4sensor_error_t status);
+
+extern void sensor_init(sensor_done_callback callback);
+extern bool sensor_stop_remote(void);
+extern bool sensor_run_remote(uint8_t sensitivity, uint16_t range, presence_callback callback);
+extern bool sensor_get_snapshot(sensor_snapshot_t *snapshot);
+extern bool sensor_set_detector(const x4sensor_detector_config_t *detector);
+extern bool sensor_get_detector(x4sensor_detector_config_t *detector, bool *custom);
+extern void sensor_clear_detector(void);
+extern bool sensor_calibrate_remote(uint16_t seconds);
+extern bool sensor_set_zones(const sensor_zone_t *zones, uint8_t count);
+extern void sensor_set_tracking(bool enable);
+extern void sensor_get_health(sensor_health_t *health);
+extern uint8_t sensor_get_frame_rate(void);
+extern bool sensor_set_presence(const x4sensor_presence_setup_t *setup);
+extern void sensor_restore(const sensor_metadata_t *metadata, const x4sensor_detector_config_t *detector);
+extern void sensor_get_metadata(sensor_metadata_t *metadata);
+
+#endif /* NOVELDA_SENSOR_H_ */
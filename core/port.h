@@ -0,0 +1,47 @@
+/**
+ * @file port.h
+ * @brief Board port of the portable core.
+ *
+ * The core (proximity.c, novelda_sensor.c and the x4sensor driver) is shared by all boards. It
+ * runs on FreeRTOS and reaches the board only through this interface, the chip interface
+ * (novelda_chipinterface.h) and the board modules behind settings.h, trace.h and energy.h.
+ *
+ * Every board provides board_port.h on its include path with these macros:
+ * - PORT_LOG_INFO(...)   Log a printf style message from task context. At most six arguments,
+ *                        %s only for constant strings.
+ * - PORT_ASSERT_FAILED() Handle a failed MAIN_ASSERT() of the sensor module.
+ * - PORT_INIT_TIMERS()   Initialize the timer module of the board before the first software
+ *                        timer is created, empty where FreeRTOS timers need nothing else.
+ *
+ * and implements the functions below next to its chip interface.
+ */
+
+#ifndef PORT_H_
+#define PORT_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include <novelda_chipinterface.h>
+#include "board_port.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Time limit in microseconds of the interrupt waits below that never expires */
+#define PORT_WAIT_FOREVER_US    CHIPINTERFACE_WAIT_FOREVER
+
+/* Wait for the sensor interrupt, at most microseconds or PORT_WAIT_FOREVER_US, ended early by
+ * chipinterface_wake() */
+extern chipinterface_error_t chipinterface_wait_for_interrupt_or_wake(uint32_t microseconds);
+extern void chipinterface_wake(void);
+/* Interrupt on both edges of the sensor interrupt line while running in normal operation mode,
+ * on the rising edge only otherwise */
+extern void chipinterface_set_interrupt_edges(bool both_edges);
+/* Time since the scheduler started in microseconds, without wrap-around. Its low 32 bits are
+ * chipinterface_get_time_microseconds(), whose differences are exact for up to 71 minutes. */
+extern uint64_t chipinterface_get_time_microseconds_64(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORT_H_ */
@@ -0,0 +1,1510 @@
+/**
+ * @file proximity.c
+ * @brief Implementation of an proximity sensor module.
+ *
+ * This module implements an proximity sensor using the Novelda chip interface and FreeRTOS.
+ * It includes functions to start and stop the sensor, configure sensitivity, range, and timeout,
+ * and process sensor events.
+ */
+
+#include <unistd.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Driver Header files */
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <timers.h>
+#include <task.h>
+/* Driver configuration */
+#include <novelda_chipinterface.h>
+#include "novelda_sensor.h"
+#include "proximity.h"
+#include "settings.h"
+#include "trace.h"
+#include "energy.h"
+#include "port.h"
+
+
+
+
+volatile bool                  gpresence;
+volatile bool                  gSensorRunning = false;
+static uint8_t                 gSensitivity = DEFAULT_SENSITIVITY;
+static uint16_t                gRange = DEFAULT_RANGE;
+static uint16_t                gTimeout = PRESENCE_TIME_OUT_MS;
+static uint16_t                gEnterFrames = PRESENCE_ENTER_FRAMES;
+static uint16_t                gEnterMs = PRESENCE_ENTER_MS;
+static uint16_t                gExitFrames = PRESENCE_EXIT_FRAMES;
+TimerHandle_t                  configTimer;
+TimerHandle_t                  settingsTimer;
+TimerHandle_t                  scheduleTimer;
+QueueHandle_t                  appQueue;
+static bool                    gNotifiedPresence;
+static notifyLatency_t         gLatency;
+static uint64_t                gLatencyTotal;
+
+/* Configuration written but not applied yet, see configureRange() */
+#define CONFIG_CHANGE_RANGE         0x01
+#define CONFIG_CHANGE_SENSITIVITY   0x02
+#define CONFIG_CHANGE_TIMEOUT       0x04
+#define CONFIG_CHANGE_DETECTOR      0x08
+#define CONFIG_CHANGE_POLICY        0x10
+#define CONFIG_CHANGE_ZONES         0x20
+#define CONFIG_CHANGE_TRACKING      0x40
+static uint8_t                 gPendingChanges;
+static uint16_t                gPendingRange;
+static uint8_t                 gPendingSensitivity;
+static uint16_t                gPendingTimeout;
+static x4sensor_detector_config_t gPendingDetector;
+static proximityZone_t         gPendingZones[MAX_ZONES];
+static uint8_t                 gPendingZoneCount;
+static bool                    gPendingTracking;
+static uint8_t                 gPendingPolicy;
+
+/* Sensing policy, owned by the application task */
+static uint8_t                 gPolicy = SENSING_POLICY_DEFAULT;
+static bool                    gConnected;
+static bool                    gScheduleActive;
+
+/* Settings as last loaded from or saved to flash */
+static settings_t              gSavedSettings;
+
+/* Distance zones, none by default as they make the sensor report every frame. Written by the
+ * application task in critical sections. Only evaluated in event mode. */
+static proximityZone_t         gZones[MAX_ZONES];
+static uint8_t                 gZoneCount;
+static uint32_t                gZoneLastHit[MAX_ZONES];
+static volatile uint8_t        gZoneState;
+/* Target tracking, off by default as it makes the sensor report every frame. Owned by the
+ * application task. Only evaluated in event mode. */
+static bool                    gTracking;
+
+updateSensorValueCb_t updateSensorValCb;
+updateSensorValueCb_t updateZoneValCb;
+updateMotionValueCb_t updateMotionValCb;
+updateDetectorValueCb_t updateDetectorValCb;
+updateConfigValueCb_t updateConfigValCb;
+
+static void sensor_event_callback(const sensor_snapshot_t *snapshot);
+static void sensor_request_callback(sensor_event_type_t type, x4sensor_error_t status);
+
+
+/**
+ * @brief Queue an event for the application task.
+ *
+ * Never blocks, so it is safe in the sensor task and the timer service task. An event that does
+ * not fit into the queue is counted as dropped.
+ *
+ * @param[in] event Event to queue, copied.
+ */
+static void post_event(const proximityEvent_t *event)
+{
+    if(xQueueSend(appQueue, event, 0) != pdTRUE)
+    {
+        gLatency.dropped++;
+    }
+}
+
+/**
+ * @brief Encode a tracked target as motion characteristic value.
+ *
+ * @param[in]  track Tracked target.
+ * @param[out] value Destination for MOTION_VALUE_SIZE bytes.
+ */
+static void encode_motion(const x4sensor_track_t *track, uint8_t *value)
+{
+    value[0] = (uint8_t)track->direction;
+    value[1] = (uint8_t)track->distance_mm;
+    value[2] = (uint8_t)(track->distance_mm >> 8);
+    value[3] = (uint8_t)track->velocity_mm_s;
+    value[4] = (uint8_t)((uint16_t)track->velocity_mm_s >> 8);
+}
+
+
+/**
+ * @brief Pass the presence hysteresis to the sensor task.
+ *
+ * The exit hysteresis in milliseconds is the presence timeout.
+ */
+static void apply_presence(void)
+{
+    x4sensor_presence_setup_t setup;
+
+    setup.enter_frames = gEnterFrames;
+    setup.enter_ms = gEnterMs;
+    setup.exit_frames = gExitFrames;
+    setup.exit_ms = gTimeout;
+    sensor_set_presence(&setup);
+}
+
+/**
+ * @brief Check distance zones.
+ *
+ * @param[in] zones Zones.
+ * @param[in] count Number of zones.
+ * @return true if there are at most MAX_ZONES zones and each ends after it starts.
+ */
+static bool zones_valid(const proximityZone_t *zones, uint8_t count)
+{
+    if(count > MAX_ZONES)
+    {
+        return false;
+    }
+    for(uint8_t zone = 0; zone < count; zone++)
+    {
+        if(zones[zone].from_cm >= zones[zone].to_cm)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Pass the distance zones and target tracking to the sensor task.
+ *
+ * Both take effect at the next start of the sensor.
+ */
+static void set_sensor_features(void)
+{
+    sensor_zone_t zones[MAX_ZONES];
+
+    for(uint8_t zone = 0; zone < gZoneCount; zone++)
+    {
+        zones[zone].from_cm = gZones[zone].from_cm;
+        zones[zone].to_cm = gZones[zone].to_cm;
+    }
+    sensor_set_zones(zones, gZoneCount);
+    sensor_set_tracking(gTracking);
+}
+
+/**
+ * @brief Timer callback for the configuration debounce window.
+ *
+ * This callback is executed when no configuration was written for CONFIG_COMMIT_DELAY_MS and
+ * lets the application task apply the pending configuration.
+ *
+ * @param[in] arg0 Unused timer argument.
+ */
+void clkConfigCallback(TimerHandle_t arg0)
+{
+    (void)arg0;
+    proximityEvent_t event;
+
+    TRACE_RECORD(TRACE_TIMER, TRACE_TIMER_CONFIG, 0);
+    event.type = PROXIMITY_EVENT_CONFIG;
+    chipinterface_get_time_microseconds(&event.timestamp_us);
+    post_event(&event);
+}
+
+/**
+ * @brief Timer callback for the settings save delay.
+ *
+ * This callback is executed when the settings did not change for SETTINGS_SAVE_DELAY_MS and lets
+ * the application task save them.
+ *
+ * @param[in] arg0 Unused timer argument.
+ */
+void clkSettingsCallback(TimerHandle_t arg0)
+{
+    (void)arg0;
+    proximityEvent_t event;
+
+    TRACE_RECORD(TRACE_TIMER, TRACE_TIMER_SETTINGS, 0);
+    event.type = PROXIMITY_EVENT_SETTINGS;
+    chipinterface_get_time_microseconds(&event.timestamp_us);
+    post_event(&event);
+}
+
+/**
+ * @brief Restore the settings saved in flash.
+ *
+ * Called once before the sensor is initialized. Values out of range are replaced by the defaults.
+ */
+static void load_settings(void)
+{
+    settings_t settings;
+
+    if(!settings_load(&settings))
+    {
+        PORT_LOG_INFO("No saved settings, using defaults");
+        return;
+    }
+    gSavedSettings = settings;
+    if(settings.range >= MIN_RANGE_VALUE && settings.range <= MAX_RANGE_VALUE)
+    {
+        gRange = settings.range;
+    }
+    if(settings.sensitivity >= MIN_SENSITIVITY_VALUE && settings.sensitivity <= MAX_SENSITIVITY_VALUE)
+    {
+        gSensitivity = settings.sensitivity;
+    }
+    if(settings.timeout >= MIN_TIMEOUT_VALUE)
+    {
+        gTimeout = settings.timeout;
+    }
+    if(settings.sensing_policy < SENSING_POLICY_COUNT)
+    {
+        gPolicy = settings.sensing_policy;
+    }
+    if(zones_valid(settings.zones, settings.zone_count))
+    {
+        memcpy(gZones, settings.zones, settings.zone_count * sizeof(proximityZone_t));
+        gZoneCount = settings.zone_count;
+    }
+    gTracking = (settings.tracking != 0);
+    sensor_restore(&settings.sensor, settings.detector_custom ? &settings.detector : NULL);
+    PORT_LOG_INFO("Settings restored. Range: %u cm, sensitivity level: %u, timeout: %u ms, policy: %u%s",
+                  gRange, gSensitivity, gTimeout, gPolicy, settings.detector_custom ? ", custom detector" : "");
+}
+
+/**
+ * @brief Save the settings to flash if they changed.
+ *
+ * Called by the application task SETTINGS_SAVE_DELAY_MS after the last change, so a series of
+ * changes costs one flash write.
+ */
+static void save_settings(void)
+{
+    settings_t settings;
+    bool custom;
+
+    memset(&settings, 0, sizeof(settings));
+    settings.version = SETTINGS_VERSION;
+    settings.sensitivity = gSensitivity;
+    settings.range = gRange;
+    settings.timeout = gTimeout;
+    settings.sensing_policy = gPolicy;
+    settings.zone_count = gZoneCount;
+    memcpy(settings.zones, gZones, gZoneCount * sizeof(proximityZone_t));
+    settings.tracking = gTracking;
+    // only a detector written by the client is saved, the default one comes with the configuration
+    (void)sensor_get_detector(&settings.detector, &custom);
+    if(!custom)
+    {
+        memset(&settings.detector, 0, sizeof(settings.detector));
+    }
+    settings.detector_custom = custom;
+    sensor_get_metadata(&settings.sensor);
+    if(memcmp(&settings, &gSavedSettings, sizeof(settings)) == 0)
+    {
+        return;
+    }
+    if(!settings_store(&settings))
+    {
+        PORT_LOG_INFO("Settings save failed");
+        return;
+    }
+    gSavedSettings = settings;
+}
+
+/**
+ * @brief Save the settings once they did not change for SETTINGS_SAVE_DELAY_MS.
+ */
+static void schedule_save_settings(void)
+{
+    xTimerReset(settingsTimer, 0);
+}
+
+/**
+ * @brief Timer callback for the sensing schedule.
+ *
+ * This callback is executed at the end of every on and off phase of SENSING_POLICY_SCHEDULED and
+ * lets the application task switch the sensor.
+ *
+ * @param[in] arg0 Unused timer argument.
+ */
+void clkScheduleCallback(TimerHandle_t arg0)
+{
+    (void)arg0;
+    proximityEvent_t event;
+
+    TRACE_RECORD(TRACE_TIMER, TRACE_TIMER_SCHEDULE, 0);
+    event.type = PROXIMITY_EVENT_SCHEDULE;
+    chipinterface_get_time_microseconds(&event.timestamp_us);
+    post_event(&event);
+}
+
+/**
+ * @brief Start or stop the sensor as the sensing policy requires.
+ *
+ * Runs in the application task after every change of the policy, the connection state or the
+ * schedule phase. The sensor keeps running across connections unless the policy stops it, so a
+ * connecting central reads the current presence state right away.
+ */
+static void update_sensing(void)
+{
+    bool run;
+
+    switch(gPolicy)
+    {
+        case SENSING_POLICY_ALWAYS_ON:
+            run = true;
+            break;
+
+        case SENSING_POLICY_SCHEDULED:
+            run = gConnected || gScheduleActive;
+            break;
+
+        default:
+            run = gConnected;
+            break;
+    }
+    if(run)
+    {
+        startSensor();
+    }
+    else
+    {
+        stopSensor();
+    }
+}
+
+/**
+ * @brief Switch to a sensing policy.
+ *
+ * Runs in the application task. The schedule starts with an on phase.
+ *
+ * @param[in] policy New sensingPolicy_t.
+ */
+static void apply_policy(uint8_t policy)
+{
+    gPolicy = policy;
+    gScheduleActive = (policy == SENSING_POLICY_SCHEDULED);
+    if(gScheduleActive)
+    {
+        xTimerChangePeriod(scheduleTimer, pdMS_TO_TICKS(SENSING_SCHEDULE_ON_MS), 0);
+    }
+    else
+    {
+        xTimerStop(scheduleTimer, 0);
+    }
+    update_sensing();
+}
+
+/**
+ * @brief End the current phase of the sensing schedule.
+ *
+ * Runs in the application task. The sensor stays on while connected, the schedule keeps its
+ * phase so it continues seamlessly after the disconnect.
+ */
+static void advance_schedule(void)
+{
+    if(gPolicy != SENSING_POLICY_SCHEDULED)
+    {
+        return;
+    }
+    gScheduleActive = !gScheduleActive;
+    xTimerChangePeriod(scheduleTimer,
+                       pdMS_TO_TICKS(gScheduleActive ? SENSING_SCHEDULE_ON_MS :
+                                     SENSING_SCHEDULE_PERIOD_MS - SENSING_SCHEDULE_ON_MS),
+                       0);
+    update_sensing();
+}
+
+/**
+ * @brief Configure the clock and timers for sensor operations.
+ *
+ * This function initializes the timer module of the board and creates the configuration, settings
+ * and sensing schedule timers.
+ *
+ * @return 0 on success.
+ */
+int configure_clock()
+{
+    // Initialize timer module.
+    PORT_INIT_TIMERS();
+
+    // Create timers.
+    configTimer = xTimerCreate("CONFIG",
+                                 pdMS_TO_TICKS(CONFIG_COMMIT_DELAY_MS),
+                                 pdFALSE,
+                                 NULL,
+                                 clkConfigCallback);
+    settingsTimer = xTimerCreate("SETTINGS",
+                                   pdMS_TO_TICKS(SETTINGS_SAVE_DELAY_MS),
+                                   pdFALSE,
+                                   NULL,
+                                   clkSettingsCallback);
+    scheduleTimer = xTimerCreate("SCHEDULE",
+                                   pdMS_TO_TICKS(SENSING_SCHEDULE_ON_MS),
+                                   pdFALSE,
+                                   NULL,
+                                   clkScheduleCallback);
+
+    return 0;
+}
+
+/**
+ * @brief Start the proximity sensor.
+ *
+ * This function queues the start of the proximity sensor if it is not already running. The
+ * sensor task reports the result through processSensorEvent().
+ */
+void startSensor()
+{
+    if(!gSensorRunning)
+    {
+        set_sensor_features();
+        if(sensor_run_remote(gSensitivity, gRange, sensor_event_callback))
+        {
+            gSensorRunning = true;
+            energy_set_sensing(true);
+        }
+    }
+}
+
+/**
+ * @brief Stop the proximity sensor.
+ *
+ * This function queues the stop of the proximity sensor. A stopped sensor reports no presence,
+ * the presence state machine starts over at the next start.
+ */
+void stopSensor()
+{
+    if(gSensorRunning && sensor_stop_remote())
+    {
+        gSensorRunning = false;
+        energy_set_sensing(false);
+
+        if(gpresence)
+        {
+            proximityEvent_t event;
+
+            gpresence = false;
+            event.type = PROXIMITY_EVENT_PRESENCE;
+            chipinterface_get_time_microseconds(&event.timestamp_us);
+            event.payload.presence = false;
+            post_event(&event);
+        }
+    }
+}
+
+/**
+ * @brief Set the sensitivity of the proximity sensor.
+ *
+ * Takes effect at the next start and discards custom detector values.
+ *
+ * @param[in] sens Sensitivity value to set.
+ */
+void setSensitivity(uint8_t sens)
+{
+    gSensitivity = sens;
+    // a sensitivity level replaces custom detector values
+    sensor_clear_detector();
+}
+
+/**
+ * @brief Calibrate the detector to the empty scene.
+ *
+ * Stops the sensor, records the background for CALIBRATION_TIME_SECONDS and restarts the
+ * sensor with the calibrated thresholds if it was running. The thresholds stay active until
+ * the next sensitivity change.
+ */
+void calibrateSensor(void)
+{
+    bool running = gSensorRunning;
+
+    stopSensor();
+    sensor_calibrate_remote(CALIBRATION_TIME_SECONDS);
+    if(running)
+    {
+        startSensor();
+    }
+}
+
+/**
+ * @brief Set the range of the proximity sensor.
+ *
+ * @param[in] range Range value to set.
+ */
+void setRange(uint16_t range)
+{
+    gRange = range;
+}
+
+/**
+ * @brief Get the sensitivity of the proximity sensor.
+ *
+ * @return Current sensitivity value.
+ */
+uint8_t  getSensitivity(void)
+{
+    return gSensitivity;
+}
+
+/**
+ * @brief Get the range of the proximity sensor.
+ *
+ * @return Current range value.
+ */
+uint16_t getRange(void)
+{
+    return gRange;
+}
+
+/**
+ * @brief Get the timeout value for presence detection.
+ *
+ * @return Current timeout value.
+ */
+uint16_t getTimeout(void)
+{
+    return gTimeout;
+}
+
+/**
+ * @brief Change the range of the proximity sensor.
+ *
+ * This function increments the range value within a specified limit.
+ *
+ * @return New range value.
+ */
+uint16_t changeRange(void)
+{
+    gRange = (gRange + 100) % 500; // limit max range to 400cm
+    gRange = gRange == 0 ? 100 : gRange;
+    return gRange;
+}
+
+/**
+ * @brief Set the presence timeout value for the proximity sensor.
+ *
+ * The timeout is the exit hysteresis, presence ends once no frame had a detection for this
+ * time. Applied to a running sensor without a restart.
+ *
+ * @param[in] tmout New timeout value in ms.
+ */
+void setPresenceTimeout(uint16_t tmout)
+{
+    gTimeout = tmout;
+    apply_presence();
+}
+
+/**
+ * @brief Set the presence hysteresis in frames.
+ *
+ * Presence is reported once enterFrames consecutive frames had a detection for at least enterMs,
+ * and ends once exitFrames consecutive frames and the presence timeout had none. A value of 0
+ * disables that condition. Applied to a running sensor without a restart.
+ *
+ * @param[in] enterFrames Frames with detection before presence is reported.
+ * @param[in] enterMs     Time in ms the detection lasts before presence is reported.
+ * @param[in] exitFrames  Frames without detection before presence ends.
+ */
+void setPresenceHysteresis(uint16_t enterFrames, uint16_t enterMs, uint16_t exitFrames)
+{
+    gEnterFrames = enterFrames;
+    gEnterMs = enterMs;
+    gExitFrames = exitFrames;
+    apply_presence();
+}
+
+/**
+ * @brief Write the range of the proximity sensor.
+ *
+ * The range is validated right away and applied together with the other configuration written
+ * within CONFIG_COMMIT_DELAY_MS, or by commitConfig().
+ *
+ * @param[in] range Range value in cm.
+ * @return true if the range is valid, false otherwise. An invalid value is discarded.
+ */
+bool configureRange(uint16_t range)
+{
+    if(range < MIN_RANGE_VALUE || range > MAX_RANGE_VALUE)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    gPendingRange = range;
+    gPendingChanges |= CONFIG_CHANGE_RANGE;
+    taskEXIT_CRITICAL();
+    // restart the debounce window, writes in quick succession are applied together
+    xTimerReset(configTimer, 0);
+    return true;
+}
+
+/**
+ * @brief Write the sensitivity of the proximity sensor.
+ *
+ * Like configureRange(). Applying a sensitivity level also discards custom detector values.
+ *
+ * @param[in] sens Sensitivity level.
+ * @return true if the sensitivity is valid, false otherwise. An invalid value is discarded.
+ */
+bool configureSensitivity(uint8_t sens)
+{
+    if(sens < MIN_SENSITIVITY_VALUE || sens > MAX_SENSITIVITY_VALUE)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    gPendingSensitivity = sens;
+    gPendingChanges |= CONFIG_CHANGE_SENSITIVITY;
+    taskEXIT_CRITICAL();
+    xTimerReset(configTimer, 0);
+    return true;
+}
+
+/**
+ * @brief Write the presence timeout.
+ *
+ * Like configureRange(). The timeout alone is applied without restarting the sensor.
+ *
+ * @param[in] tmout Timeout in ms.
+ * @return true if the timeout is valid, false otherwise. An invalid value is discarded.
+ */
+bool configureTimeout(uint16_t tmout)
+{
+    if(tmout < MIN_TIMEOUT_VALUE)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    gPendingTimeout = tmout;
+    gPendingChanges |= CONFIG_CHANGE_TIMEOUT;
+    taskEXIT_CRITICAL();
+    xTimerReset(configTimer, 0);
+    return true;
+}
+
+/**
+ * @brief Apply the pending configuration without waiting for the debounce window.
+ */
+void commitConfig(void)
+{
+    xTimerStop(configTimer, 0);
+    clkConfigCallback(configTimer);
+}
+
+/**
+ * @brief Select when the sensor runs.
+ *
+ * Applied by the application task together with the pending configuration and saved with the
+ * settings.
+ *
+ * @param[in] policy Sensing policy.
+ * @return true if the policy is valid, false otherwise.
+ */
+bool setSensingPolicy(sensingPolicy_t policy)
+{
+    if(policy >= SENSING_POLICY_COUNT)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    gPendingPolicy = (uint8_t)policy;
+    gPendingChanges |= CONFIG_CHANGE_POLICY;
+    taskEXIT_CRITICAL();
+    commitConfig();
+    return true;
+}
+
+/**
+ * @brief Get the sensing policy.
+ *
+ * @return Current sensing policy.
+ */
+sensingPolicy_t getSensingPolicy(void)
+{
+    return (sensingPolicy_t)gPolicy;
+}
+
+/**
+ * @brief Report the connection state.
+ *
+ * Called by the BLE stack integration on every connect and disconnect, the application task then
+ * applies the sensing policy.
+ *
+ * @param[in] connected true while at least one central is connected.
+ */
+void setConnectionState(bool connected)
+{
+    proximityEvent_t event;
+
+    event.type = PROXIMITY_EVENT_CONNECTION;
+    chipinterface_get_time_microseconds(&event.timestamp_us);
+    event.payload.connected = connected;
+    post_event(&event);
+}
+
+/**
+ * @brief Request a dump of the event trace.
+ *
+ * The application task writes the trace to the UART, see trace_dump(). Does nothing but log a
+ * note unless the firmware is built with EVENT_TRACE.
+ */
+void dumpTrace(void)
+{
+    proximityEvent_t event;
+
+    event.type = PROXIMITY_EVENT_TRACE_DUMP;
+    chipinterface_get_time_microseconds(&event.timestamp_us);
+    post_event(&event);
+}
+
+/**
+ * @brief Apply the pending configuration.
+ *
+ * Runs in the application task. A new range or sensitivity restarts a running sensor once with
+ * all changes, a new timeout or new detector values are applied to the running sensor. Rewriting
+ * the current sensitivity only restarts to discard custom detector values.
+ */
+static void apply_config(void)
+{
+    x4sensor_detector_config_t detector;
+    uint8_t changes;
+    uint16_t range;
+    uint8_t sensitivity;
+    uint16_t timeout;
+    uint8_t policy;
+    uint8_t zoneState;
+    bool tracking;
+    bool custom = false;
+    bool level;
+    bool restart;
+
+    sensor_get_detector(&detector, &custom);
+    taskENTER_CRITICAL();
+    changes = gPendingChanges;
+    range = (changes & CONFIG_CHANGE_RANGE) ? gPendingRange : gRange;
+    sensitivity = (changes & CONFIG_CHANGE_SENSITIVITY) ? gPendingSensitivity : gSensitivity;
+    timeout = (changes & CONFIG_CHANGE_TIMEOUT) ? gPendingTimeout : gTimeout;
+    detector = gPendingDetector;
+    policy = (changes & CONFIG_CHANGE_POLICY) ? gPendingPolicy : gPolicy;
+    tracking = (changes & CONFIG_CHANGE_TRACKING) ? gPendingTracking : gTracking;
+    gPendingChanges = 0;
+    // custom detector values of the same transaction replace the level right away
+    level = (changes & CONFIG_CHANGE_SENSITIVITY) &&
+            (sensitivity != gSensitivity || (custom && !(changes & CONFIG_CHANGE_DETECTOR)));
+    restart = level || range != gRange || (changes & CONFIG_CHANGE_ZONES) || tracking != gTracking;
+    // the whole configuration becomes visible at once, see getConfigValue()
+    gRange = range;
+    gSensitivity = sensitivity;
+    gTimeout = timeout;
+    zoneState = gZoneState;
+    if(changes & CONFIG_CHANGE_ZONES)
+    {
+        memcpy(gZones, gPendingZones, sizeof(gZones));
+        gZoneCount = gPendingZoneCount;
+        gZoneState = 0;
+    }
+    taskEXIT_CRITICAL();
+
+    if(!changes)
+    {
+        return;
+    }
+    if(changes & CONFIG_CHANGE_TIMEOUT)
+    {
+        setPresenceTimeout(timeout);
+    }
+    if(level)
+    {
+        sensor_clear_detector();
+    }
+    if((changes & CONFIG_CHANGE_DETECTOR) && !sensor_set_detector(&detector))
+    {
+        PORT_LOG_INFO("Configuration detector values rejected");
+    }
+    if(changes & CONFIG_CHANGE_ZONES)
+    {
+        PORT_LOG_INFO("Zones set: %u", gZoneCount);
+        // the new zones start free
+        if(zoneState && updateZoneValCb)
+        {
+            updateZoneValCb(0);
+        }
+    }
+    if(tracking != gTracking)
+    {
+        PORT_LOG_INFO("Tracking %s", tracking ? "enabled" : "disabled");
+        gTracking = tracking;
+        // a disabled tracker reports no direction, the last notified one would stick otherwise
+        if(!tracking && updateMotionValCb)
+        {
+            uint8_t motion[MOTION_VALUE_SIZE] = {0};
+
+            updateMotionValCb(motion, MOTION_VALUE_SIZE);
+        }
+    }
+    if(changes & (CONFIG_CHANGE_ZONES | CONFIG_CHANGE_TRACKING))
+    {
+        set_sensor_features();
+    }
+    if(restart && gSensorRunning && !sensor_run_remote(gSensitivity, gRange, sensor_event_callback))
+    {
+        PORT_LOG_INFO("Configuration restart dropped");
+    }
+    if(policy != gPolicy)
+    {
+        apply_policy(policy);
+    }
+    PORT_LOG_INFO("Configuration applied. Range: %u cm, sensitivity level: %u, timeout: %u ms, policy: %u%s",
+                  gRange, gSensitivity, gTimeout, gPolicy, restart && gSensorRunning ? ", restarting" : "");
+    if(updateConfigValCb)
+    {
+        updateConfigValCb();
+    }
+    schedule_save_settings();
+}
+
+/**
+ * @brief Set the distance zones.
+ *
+ * Applied by the application task together with the pending configuration, restarts a running
+ * sensor and is saved with the settings. Zones need the distance of every frame and are
+ * therefore only available in event mode (SENSOR_EVENT_MODE), where the sensor then reports
+ * every frame while zones are set.
+ *
+ * @param[in] zones Zones, bit n of the zone value corresponds to zones[n].
+ * @param[in] count Number of zones, 0 to disable zones.
+ * @return true if the zones were accepted, false otherwise.
+ */
+bool setZones(const proximityZone_t *zones, uint8_t count)
+{
+#ifdef SENSOR_EVENT_MODE
+    if(!zones_valid(zones, count))
+    {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    memcpy(gPendingZones, zones, count * sizeof(proximityZone_t));
+    gPendingZoneCount = count;
+    gPendingChanges |= CONFIG_CHANGE_ZONES;
+    taskEXIT_CRITICAL();
+    commitConfig();
+    return true;
+#else
+    (void)zones;
+    return (count == 0);
+#endif
+}
+
+/**
+ * @brief Set the distance zones from a zones characteristic value.
+ *
+ * @param[in] value Value in the ZONES_VALUE_* format.
+ * @param[in] len   Length of the value.
+ * @return true if the zones were accepted, false otherwise. An invalid value changes nothing.
+ */
+bool setZonesValue(const uint8_t *value, uint16_t len)
+{
+    proximityZone_t zones[MAX_ZONES];
+    uint8_t count;
+
+    if(len < ZONES_VALUE_HEADER_SIZE)
+    {
+        return false;
+    }
+    count = value[0];
+    if(count > MAX_ZONES || len != ZONES_VALUE_HEADER_SIZE + count * ZONES_VALUE_ZONE_SIZE)
+    {
+        return false;
+    }
+    for(uint8_t zone = 0; zone < count; zone++)
+    {
+        const uint8_t *p = &value[ZONES_VALUE_HEADER_SIZE + zone * ZONES_VALUE_ZONE_SIZE];
+
+        zones[zone].from_cm = (uint16_t)(p[0] | (p[1] << 8));
+        zones[zone].to_cm = (uint16_t)(p[2] | (p[3] << 8));
+        zones[zone].timeout_ms = (uint16_t)(p[4] | (p[5] << 8));
+    }
+    return setZones(zones, count);
+}
+
+/**
+ * @brief Get the occupied zones.
+ *
+ * @return Bit n set if zone n is occupied.
+ */
+uint8_t getZoneValue(void)
+{
+    return gZoneState;
+}
+
+/**
+ * @brief Set the callback for zone changes.
+ *
+ * The callback runs in the application task whenever a zone becomes occupied or free and
+ * receives the zone value.
+ *
+ * @param[in] updateZoneCb Callback function for updating the zone value.
+ */
+void setZoneCallback(updateSensorValueCb_t updateZoneCb)
+{
+    updateZoneValCb = updateZoneCb;
+}
+
+/**
+ * @brief Enable tracking of the nearest target.
+ *
+ * Applied by the application task together with the pending configuration, restarts a running
+ * sensor and is saved with the settings. Tracking needs the distance of every frame and is
+ * therefore only available in event mode (SENSOR_EVENT_MODE), where the sensor then reports
+ * every frame while it is enabled. Disabled by default.
+ *
+ * @param[in] enable true to track the target, false otherwise.
+ * @return true if the setting was accepted, false otherwise.
+ */
+bool setTracking(bool enable)
+{
+#ifdef SENSOR_EVENT_MODE
+    taskENTER_CRITICAL();
+    gPendingTracking = enable;
+    gPendingChanges |= CONFIG_CHANGE_TRACKING;
+    taskEXIT_CRITICAL();
+    commitConfig();
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+/**
+ * @brief Enable or disable tracking from a written motion characteristic value.
+ *
+ * @param[in] value Written value, MOTION_TRACKING_ON or MOTION_TRACKING_OFF.
+ * @param[in] len   Length of the value.
+ * @return true if the value was accepted, false otherwise.
+ */
+bool setMotionValue(const uint8_t *value, uint16_t len)
+{
+    if(len != 1 || (value[0] != MOTION_TRACKING_ON && value[0] != MOTION_TRACKING_OFF))
+    {
+        return false;
+    }
+    return setTracking(value[0] == MOTION_TRACKING_ON);
+}
+
+/**
+ * @brief Encode the tracked target as motion characteristic value.
+ *
+ * @param[out] value  Destination for the value: direction, distance in mm and radial velocity
+ *                    in mm/s, both little endian.
+ * @param[in]  maxLen Size of the destination.
+ * @return Length of the value, 0 if the destination is too small.
+ */
+uint16_t getMotionValue(uint8_t *value, uint16_t maxLen)
+{
+    sensor_snapshot_t snapshot;
+
+    if(maxLen < MOTION_VALUE_SIZE)
+    {
+        return 0;
+    }
+    if(!sensor_get_snapshot(&snapshot))
+    {
+        memset(&snapshot, 0, sizeof(snapshot));
+    }
+    encode_motion(&snapshot.track, value);
+    return MOTION_VALUE_SIZE;
+}
+
+/**
+ * @brief Set the callback for direction changes.
+ *
+ * The callback runs in the application task whenever the tracked target starts approaching,
+ * starts leaving or stops moving radially, and receives the motion value.
+ *
+ * @param[in] updateMotionCb Callback function for updating the motion value.
+ */
+void setMotionCallback(updateMotionValueCb_t updateMotionCb)
+{
+    updateMotionValCb = updateMotionCb;
+}
+
+/**
+ * @brief Advance the zone state machines by one frame.
+ *
+ * Runs in the sensor task. A zone with a detection in the frame becomes occupied and restarts
+ * its timeout, an occupied zone without one becomes free once its timeout has elapsed. The
+ * cost is constant per zone as the zones are mapped to detector bins by the sensor module.
+ *
+ * @param[in] snapshot Sensor frame published by the sensor task.
+ * @return true if the zone value changed, false otherwise.
+ */
+static bool update_zones(const sensor_snapshot_t *snapshot)
+{
+    uint8_t state = gZoneState;
+
+    for(uint8_t zone = 0; zone < gZoneCount; zone++)
+    {
+        uint8_t bit = (uint8_t)(1 << zone);
+
+        if(snapshot->zones & bit)
+        {
+            state |= bit;
+            gZoneLastHit[zone] = snapshot->timestamp_us;
+        }
+        else if((state & bit) &&
+                (uint32_t)(snapshot->timestamp_us - gZoneLastHit[zone]) >= gZones[zone].timeout_ms * 1000u)
+        {
+            state &= (uint8_t)~bit;
+        }
+    }
+    if(state == gZoneState)
+    {
+        return false;
+    }
+    gZoneState = state;
+    return true;
+}
+
+/**
+ * @brief Sensor event callback function.
+ *
+ * This callback is triggered when a sensor event occurs, and it queues any presence, zone or
+ * direction change for further processing. The presence state comes from the state machine of
+ * the sensor task, which applies the enter and exit hysteresis to the detection state of every
+ * frame, the interrupt line in normal mode or the decoded frame in event mode. All events of a
+ * frame carry the timestamp of the frame.
+ *
+ * @param[in] snapshot Sensor frame published by the sensor task.
+ */
+void sensor_event_callback(const sensor_snapshot_t *snapshot)
+{
+    proximityEvent_t event;
+
+    event.timestamp_us = snapshot->timestamp_us;
+    if(snapshot->presence != gpresence)
+    {
+        gpresence = snapshot->presence;
+        event.type = PROXIMITY_EVENT_PRESENCE;
+        event.payload.presence = snapshot->presence;
+        post_event(&event);
+    }
+    if(update_zones(snapshot))
+    {
+        event.type = PROXIMITY_EVENT_ZONES;
+        event.payload.zones = gZoneState;
+        post_event(&event);
+    }
+    // the tracker runs every frame, only direction changes reach the radio
+    if(snapshot->track.direction_changed)
+    {
+        event.type = PROXIMITY_EVENT_MOTION;
+        encode_motion(&snapshot->track, event.payload.motion);
+        post_event(&event);
+    }
+}
+
+/**
+ * @brief Get the sensor value (presence status).
+ *
+ * @return 1 if the sensor is active (presence detected), 0 otherwise.
+ */
+uint8_t getSensorValue()
+{
+    return (uint8_t)gpresence;
+}
+
+/**
+ * @brief Get the event to notification latency statistics.
+ *
+ * @param[out] latency Destination for the statistics.
+ */
+void getNotifyLatency(notifyLatency_t *latency)
+{
+    *latency = gLatency;
+}
+
+/**
+ * @brief Apply a detector characteristic value.
+ *
+ * The value holds M0, N0, M1, N1, the index of the first threshold and up to
+ * X4SENSOR_MAX_RANGE_BINS little endian uint16 thresholds. The M-of-N values are always applied,
+ * the thresholds replace the current ones starting at the given index. This way the whole
+ * threshold vector can be loaded in several writes with the default ATT MTU. The result is
+ * queued for the sensor task and applied to the running sensor without a restart, the detector
+ * callback runs once it is applied.
+ *
+ * @param[in] value Characteristic value.
+ * @param[in] len   Length of the value.
+ * @return true if the value was valid and queued, false otherwise.
+ */
+bool setDetectorValue(const uint8_t *value, uint16_t len)
+{
+    x4sensor_detector_config_t detector;
+    uint8_t first;
+    uint8_t count;
+
+    if(len < DETECTOR_VALUE_HEADER_SIZE || len > DETECTOR_VALUE_MAX_SIZE ||
+       ((len - DETECTOR_VALUE_HEADER_SIZE) % sizeof(uint16_t)) != 0)
+    {
+        return false;
+    }
+    if(!sensor_get_detector(&detector, NULL))
+    {
+        return false;
+    }
+    first = value[4];
+    count = (len - DETECTOR_VALUE_HEADER_SIZE) / sizeof(uint16_t);
+    if(first + count > detector.threshold_count)
+    {
+        return false;
+    }
+    detector.M[0] = value[0];
+    detector.N[0] = value[1];
+    detector.M[1] = value[2];
+    detector.N[1] = value[3];
+    for(uint8_t i = 0; i < count; i++)
+    {
+        const uint8_t *threshold = &value[DETECTOR_VALUE_HEADER_SIZE + i * sizeof(uint16_t)];
+        detector.thresholds[first + i] = (uint16_t)(threshold[0] | (threshold[1] << 8));
+    }
+    return sensor_set_detector(&detector);
+}
+
+/**
+ * @brief Encode the active detector configuration as characteristic value.
+ *
+ * @param[out] value  Destination for the value, in the format of setDetectorValue() with all
+ *                    thresholds starting at index 0.
+ * @param[in]  maxLen Size of the destination.
+ * @return Length of the value, 0 if the sensor is not initialized.
+ */
+uint16_t getDetectorValue(uint8_t *value, uint16_t maxLen)
+{
+    x4sensor_detector_config_t detector;
+    uint16_t len;
+
+    if(maxLen < DETECTOR_VALUE_MAX_SIZE || !sensor_get_detector(&detector, NULL))
+    {
+        return 0;
+    }
+    value[0] = detector.M[0];
+    value[1] = detector.N[0];
+    value[2] = detector.M[1];
+    value[3] = detector.N[1];
+    value[4] = 0;
+    len = DETECTOR_VALUE_HEADER_SIZE;
+    for(uint8_t i = 0; i < detector.threshold_count; i++)
+    {
+        value[len++] = (uint8_t)detector.thresholds[i];
+        value[len++] = (uint8_t)(detector.thresholds[i] >> 8);
+    }
+    return len;
+}
+
+/**
+ * @brief Apply a config characteristic value.
+ *
+ * The value holds all parameters in the format described at CONFIG_VALUE_VERSION. It is
+ * validated as a whole, an invalid value changes nothing. A valid one replaces any pending
+ * configuration and is committed right away, so all parameters take effect together with at most
+ * one restart. A version 1 value keeps the sensing policy.
+ *
+ * @param[in] value Characteristic value.
+ * @param[in] len   Length of the value.
+ * @return true if the value was valid and committed, false otherwise.
+ */
+bool setConfigValue(const uint8_t *value, uint16_t len)
+{
+    x4sensor_detector_config_t detector;
+    uint8_t sensitivity;
+    uint16_t range;
+    uint16_t timeout;
+    uint8_t count;
+    uint8_t header;
+
+    if(len < CONFIG_VALUE_V1_HEADER_SIZE ||
+       (value[0] != CONFIG_VALUE_VERSION && value[0] != 1))
+    {
+        return false;
+    }
+    header = (value[0] == 1) ? CONFIG_VALUE_V1_HEADER_SIZE : CONFIG_VALUE_HEADER_SIZE;
+    sensitivity = value[1];
+    range = (uint16_t)(value[2] | (value[3] << 8));
+    timeout = (uint16_t)(value[4] | (value[5] << 8));
+    count = value[10];
+    if(len != header + count * sizeof(uint16_t) ||
+       sensitivity < MIN_SENSITIVITY_VALUE || sensitivity > MAX_SENSITIVITY_VALUE ||
+       range < MIN_RANGE_VALUE || range > MAX_RANGE_VALUE || timeout < MIN_TIMEOUT_VALUE ||
+       (header == CONFIG_VALUE_HEADER_SIZE && value[11] >= SENSING_POLICY_COUNT))
+    {
+        return false;
+    }
+    if(count)
+    {
+        if(!sensor_get_detector(&detector, NULL) || count != detector.threshold_count)
+        {
+            return false;
+        }
+        for(uint8_t i = 0; i < 2; i++)
+        {
+            detector.M[i] = value[6 + 2 * i];
+            detector.N[i] = value[7 + 2 * i];
+            if(detector.M[i] == 0 || detector.M[i] > detector.N[i])
+            {
+                return false;
+            }
+        }
+        for(uint8_t i = 0; i < count; i++)
+        {
+            const uint8_t *threshold = &value[header + i * sizeof(uint16_t)];
+            detector.thresholds[i] = (uint16_t)(threshold[0] | (threshold[1] << 8));
+        }
+    }
+    taskENTER_CRITICAL();
+    gPendingSensitivity = sensitivity;
+    gPendingRange = range;
+    gPendingTimeout = timeout;
+    gPendingChanges = CONFIG_CHANGE_RANGE | CONFIG_CHANGE_SENSITIVITY | CONFIG_CHANGE_TIMEOUT;
+    if(header == CONFIG_VALUE_HEADER_SIZE)
+    {
+        gPendingPolicy = value[11];
+        gPendingChanges |= CONFIG_CHANGE_POLICY;
+    }
+    if(count)
+    {
+        gPendingDetector = detector;
+        gPendingChanges |= CONFIG_CHANGE_DETECTOR;
+    }
+    taskEXIT_CRITICAL();
+    commitConfig();
+    return true;
+}
+
+/**
+ * @brief Encode the configuration as config characteristic value.
+ *
+ * @param[out] value  Destination for the value, in the format of setConfigValue(). Thresholds are
+ *                    only included while custom detector values are in use.
+ * @param[in]  maxLen Size of the destination.
+ * @return Length of the value, 0 if the destination is too small.
+ */
+uint16_t getConfigValue(uint8_t *value, uint16_t maxLen)
+{
+    x4sensor_detector_config_t detector;
+    bool custom = false;
+    uint16_t range;
+    uint16_t timeout;
+    uint16_t len;
+
+    if(maxLen < CONFIG_VALUE_MAX_SIZE)
+    {
+        return 0;
+    }
+    if(!sensor_get_detector(&detector, &custom))
+    {
+        memset(&detector, 0, sizeof(detector));
+    }
+    taskENTER_CRITICAL();
+    value[1] = gSensitivity;
+    range = gRange;
+    timeout = gTimeout;
+    taskEXIT_CRITICAL();
+    value[0] = CONFIG_VALUE_VERSION;
+    value[2] = (uint8_t)range;
+    value[3] = (uint8_t)(range >> 8);
+    value[4] = (uint8_t)timeout;
+    value[5] = (uint8_t)(timeout >> 8);
+    value[6] = detector.M[0];
+    value[7] = detector.N[0];
+    value[8] = detector.M[1];
+    value[9] = detector.N[1];
+    value[10] = custom ? detector.threshold_count : 0;
+    value[11] = gPolicy;
+    len = CONFIG_VALUE_HEADER_SIZE;
+    for(uint8_t i = 0; i < value[10]; i++)
+    {
+        value[len++] = (uint8_t)detector.thresholds[i];
+        value[len++] = (uint8_t)(detector.thresholds[i] >> 8);
+    }
+    return len;
+}
+
+/**
+ * @brief Set the callback for configuration changes.
+ *
+ * The callback runs in the application task whenever a pending configuration was applied, so
+ * the range, sensitivity and timeout characteristics can be refreshed.
+ *
+ * @param[in] updateConfigCb Callback function for updating the configuration values.
+ */
+void setConfigCallback(updateConfigValueCb_t updateConfigCb)
+{
+    updateConfigValCb = updateConfigCb;
+}
+
+/**
+ * @brief Set the callback for detector changes.
+ *
+ * The callback runs in the application task whenever the sensor task changed the detector
+ * configuration, so the characteristic can be refreshed with getDetectorValue().
+ *
+ * @param[in] updateDetectorCb Callback function for updating the detector value.
+ */
+void setDetectorCallback(updateDetectorValueCb_t updateDetectorCb)
+{
+    updateDetectorValCb = updateDetectorCb;
+}
+
+/**
+ * @brief Sensor request completion callback.
+ *
+ * Runs in the sensor task once for every sensor request and queues the result for the
+ * application task.
+ *
+ * @param[in] type   Completed request.
+ * @param[in] status Result of the request.
+ */
+static void sensor_request_callback(sensor_event_type_t type, x4sensor_error_t status)
+{
+    proximityEvent_t event;
+
+    event.type = PROXIMITY_EVENT_SENSOR;
+    chipinterface_get_time_microseconds(&event.timestamp_us);
+    event.payload.sensor.request = (uint8_t)type;
+    event.payload.sensor.status = status;
+    post_event(&event);
+}
+
+/**
+ * @brief Record the latency of a detection notification.
+ *
+ * @param[in] event_us Time of the sensor event in microseconds.
+ */
+static void record_notify_latency(uint32_t event_us)
+{
+    uint32_t now_us;
+    uint32_t latency;
+
+    chipinterface_get_time_microseconds(&now_us);
+    latency = now_us - event_us;
+    if(!gLatency.count || latency < gLatency.min_us)
+    {
+        gLatency.min_us = latency;
+    }
+    if(latency > gLatency.max_us)
+    {
+        gLatency.max_us = latency;
+    }
+    gLatency.count++;
+    gLatency.last_us = latency;
+    gLatencyTotal += latency;
+    gLatency.avg_us = (uint32_t)(gLatencyTotal / gLatency.count);
+    PORT_LOG_INFO("Notify latency: %u us (min %u, max %u, avg %u, n %u)",
+                  latency, gLatency.min_us, gLatency.max_us, gLatency.avg_us, gLatency.count);
+}
+
+/**
+ * @brief Initialize the proximity sensor module.
+ *
+ * This function initializes the proximity sensor module, configures the clock and timers,
+ * restores the saved settings and sets the callback function for updating the sensor value. The
+ * sensor is started right away unless the sensing policy waits for a connection.
+ *
+ * @param[in] eventQueue    Queue of PROXIMITY_EVENT_QUEUE_LENGTH proximityEvent_t records, read by
+ *                          the application task and passed to processSensorEvent().
+ * @param[in] updateSensCb  Callback function for updating the sensor value.
+ */
+void proximityInit(void* eventQueue, updateSensorValueCb_t updateSensCb)
+{
+    appQueue = (QueueHandle_t)eventQueue;
+    configure_clock();
+    updateSensorValCb = updateSensCb;
+    load_settings();
+    // the bus trace hook has to be set before the sensor driver is initialized
+    trace_init();
+    sensor_init(sensor_request_callback);
+    apply_presence();
+    apply_policy(gPolicy);
+}
+
+
+/**
+ * @brief Process a sensor event.
+ *
+ * Called by the application task for every event received from the event queue and updates
+ * the sensor value using the callback functions.
+ *
+ * @param[in] event Event received from the event queue.
+ */
+void processSensorEvent(const proximityEvent_t *event)
+{
+    TRACE_RECORD(TRACE_EVENT_BEGIN, event->type, 0);
+    switch(event->type)
+    {
+        case PROXIMITY_EVENT_PRESENCE:
+        {
+            bool presence = event->payload.presence;
+
+            updateSensorValCb(presence);
+            // the detection characteristic is only notified when the value changes
+            if(presence != gNotifiedPresence)
+            {
+                record_notify_latency(event->timestamp_us);
+                gNotifiedPresence = presence;
+            }
+            break;
+        }
+
+        case PROXIMITY_EVENT_ZONES:
+            if(updateZoneValCb)
+            {
+                updateZoneValCb(event->payload.zones);
+            }
+            break;
+
+        case PROXIMITY_EVENT_MOTION:
+        {
+            const uint8_t *motion = event->payload.motion;
+
+            PORT_LOG_INFO("Direction %u, distance %u mm, velocity %d mm/s", motion[0],
+                          (uint16_t)(motion[1] | (motion[2] << 8)), (int16_t)(motion[3] | (motion[4] << 8)));
+            if(updateMotionValCb)
+            {
+                updateMotionValCb(motion, MOTION_VALUE_SIZE);
+            }
+            break;
+        }
+
+        case PROXIMITY_EVENT_SENSOR:
+            if(event->payload.sensor.status != X4SENSOR_SUCCESS)
+            {
+                PORT_LOG_INFO("Sensor request %u failed: %s", event->payload.sensor.request,
+                              x4sensor_convert_error_to_string(event->payload.sensor.status));
+            }
+            // all requests but a stop and the presence hysteresis may change the detector configuration
+            if(event->payload.sensor.request != SENSOR_EVENT_STOP &&
+               event->payload.sensor.request != SENSOR_EVENT_PRESENCE)
+            {
+                if(updateDetectorValCb)
+                {
+                    updateDetectorValCb();
+                }
+                // detector values and the sensor metadata are saved as well
+                schedule_save_settings();
+            }
+            break;
+
+        case PROXIMITY_EVENT_CONFIG:
+            apply_config();
+            break;
+
+        case PROXIMITY_EVENT_SETTINGS:
+            save_settings();
+            break;
+
+        case PROXIMITY_EVENT_CONNECTION:
+            gConnected = event->payload.connected;
+            update_sensing();
+            break;
+
+        case PROXIMITY_EVENT_SCHEDULE:
+            advance_schedule();
+            break;
+
+        case PROXIMITY_EVENT_TRACE_DUMP:
+            trace_dump();
+            break;
+
+        default:
+            break;
+    }
+    TRACE_RECORD(TRACE_EVENT_END, event->type, 0);
+}
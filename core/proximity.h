@@ -0,0 +1,203 @@
+/**
+ * @file proximity.h
+ * @brief Header file for the proximity sensor module.
+ *
+ * This header file defines the interface for the proximity sensor module, providing declarations for
+ * functions and data types related to proximity sensing. It is intended for use with the Novelda
+ * chip interface and FreeRTOS-based applications.
+ */
+
+#ifndef PROXIMITY_H_
+#define PROXIMITY_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include <novelda_x4sensor.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEFAULT_SENSITIVITY     3     // default sensitivity
+#define MIN_SENSITIVITY_VALUE 1
+#define MAX_SENSITIVITY_VALUE 6
+#define CALIBRATION_SENSITIVITY_VALUE 0   // writing this sensitivity calibrates the detector
+#define CALIBRATION_TIME_SECONDS 10        // background recording time of the calibration
+#define MIN_RANGE_VALUE 20
+#define MAX_RANGE_VALUE 200
+#define DEFAULT_RANGE 150   // default range 150cm
+#define MIN_TIMEOUT_VALUE 1
+
+
+#define PRESENCE_TIME_OUT_MS    10000 // 10s timeout to keep presence
+#define PRESENCE_ENTER_FRAMES   1     // frames with detection before presence is reported
+#define PRESENCE_ENTER_MS       0     // time the detection lasts before presence is reported
+#define PRESENCE_EXIT_FRAMES    1     // frames without detection before presence ends
+#define CONFIG_COMMIT_DELAY_MS  250   // configuration writes within this window are applied together
+#define SETTINGS_SAVE_DELAY_MS  5000  // changed settings are saved to flash after this quiet time
+
+#ifndef SENSING_POLICY_DEFAULT
+#define SENSING_POLICY_DEFAULT      SENSING_POLICY_CONNECTED // other policies are set through the Config characteristic
+#endif
+#define SENSING_SCHEDULE_ON_MS      10000 // sensing time of every schedule period while disconnected
+#define SENSING_SCHEDULE_PERIOD_MS  60000 // schedule period while disconnected
+
+#define MAX_ZONES               8     // distance zones, at most SENSOR_MAX_ZONES
+
+/* Detector characteristic value: M0, N0, M1, N1, index of the first threshold, then uint16 thresholds */
+#define DETECTOR_VALUE_HEADER_SIZE  5
+#define DETECTOR_VALUE_MAX_SIZE     (DETECTOR_VALUE_HEADER_SIZE + X4SENSOR_MAX_RANGE_BINS * sizeof(uint16_t))
+
+/* Zones characteristic value as written: zone count, then per zone uint16 from_cm, uint16 to_cm and uint16
+ * timeout_ms, see proximityZone_t. A count of 0 removes the zones. Read and notified as the occupied zones. */
+#define ZONES_VALUE_HEADER_SIZE     1
+#define ZONES_VALUE_ZONE_SIZE       6
+#define ZONES_VALUE_MAX_SIZE        (ZONES_VALUE_HEADER_SIZE + MAX_ZONES * ZONES_VALUE_ZONE_SIZE)
+
+/* Motion characteristic value: x4sensor_direction_t, uint16 distance in mm, int16 radial velocity in mm/s */
+#define MOTION_VALUE_SIZE           5
+/* Motion characteristic value as written, enables or disables target tracking */
+#define MOTION_TRACKING_OFF         0
+#define MOTION_TRACKING_ON          1
+
+/* Config characteristic value: version, sensitivity, uint16 range in cm, uint16 timeout in ms, M0, N0, M1, N1,
+ * threshold count, sensingPolicy_t, then uint16 thresholds. A threshold count of 0 selects the detector of the
+ * sensitivity level. Version 1 values have no sensing policy and are still accepted. */
+#define CONFIG_VALUE_VERSION        2
+#define CONFIG_VALUE_HEADER_SIZE    12
+#define CONFIG_VALUE_V1_HEADER_SIZE 11
+#define CONFIG_VALUE_MAX_SIZE       (CONFIG_VALUE_HEADER_SIZE + X4SENSOR_MAX_RANGE_BINS * sizeof(uint16_t))
+
+#define PROXIMITY_EVENT_QUEUE_LENGTH 16   // events buffered for the application task
+
+typedef void (*updateSensorValueCb_t)( uint8_t newValue );
+typedef void (*updateMotionValueCb_t)( const uint8_t *value, uint16_t len );
+typedef void (*updateDetectorValueCb_t)( void );
+typedef void (*updateConfigValueCb_t)( void );
+
+/**
+ * @brief Distance zone with its own presence timeout.
+ *
+ * A zone is occupied as soon as a frame has a detection within [from_cm, to_cm) and stays
+ * occupied until no frame had one for timeout_ms.
+ */
+typedef struct
+{
+    uint16_t from_cm;       // start of the zone
+    uint16_t to_cm;         // end of the zone, exclusive
+    uint16_t timeout_ms;    // time the zone stays occupied after the last detection
+} proximityZone_t;
+
+/**
+ * @brief Event to BLE notification latency statistics.
+ *
+ * Measured from the sensor interrupt, or the end of the exit hysteresis, to the return of the
+ * detection update callback. Timestamps come from chipinterface_get_time_microseconds() and
+ * have tick resolution, single values are therefore quantized while the average is unbiased.
+ */
+typedef struct
+{
+    uint32_t count;     // number of measured notifications
+    uint32_t last_us;   // latency of the last notification
+    uint32_t min_us;    // minimum latency
+    uint32_t max_us;    // maximum latency
+    uint32_t avg_us;    // average latency
+    uint32_t dropped;   // events lost to a full event queue
+} notifyLatency_t;
+
+/**
+ * @brief When the sensor runs, see setSensingPolicy().
+ */
+typedef enum
+{
+    SENSING_POLICY_CONNECTED,   // only while a central is connected
+    SENSING_POLICY_ALWAYS_ON,   // all the time, presence is tracked while disconnected
+    SENSING_POLICY_SCHEDULED,   // while connected, otherwise SENSING_SCHEDULE_ON_MS of every SENSING_SCHEDULE_PERIOD_MS
+    SENSING_POLICY_COUNT
+} sensingPolicy_t;
+
+/**
+ * @brief Type of a proximity event, selects the payload of proximityEvent_t.
+ */
+typedef enum
+{
+    PROXIMITY_EVENT_PRESENCE,   // presence state changed, payload.presence
+    PROXIMITY_EVENT_ZONES,      // zone value changed, payload.zones
+    PROXIMITY_EVENT_MOTION,     // direction of the tracked target changed, payload.motion
+    PROXIMITY_EVENT_SENSOR,     // sensor request completed, payload.sensor
+    PROXIMITY_EVENT_CONFIG,     // apply the pending configuration, no payload
+    PROXIMITY_EVENT_SETTINGS,   // save changed settings, no payload
+    PROXIMITY_EVENT_CONNECTION, // connection state changed, payload.connected
+    PROXIMITY_EVENT_SCHEDULE,   // sensing schedule phase ended, no payload
+    PROXIMITY_EVENT_TRACE_DUMP, // write the event trace to the UART, no payload
+} proximityEventType_t;
+
+/**
+ * @brief Event passed from the sensor task, the BLE stack and the timers to the application task.
+ *
+ * Events are queued by value, so each one is processed exactly once and in order, together with
+ * the state it was raised for. The timestamp is the chipinterface time of the sensor interrupt
+ * or the end of the presence hysteresis and is the start of the notification latency
+ * measurement.
+ */
+typedef struct
+{
+    uint8_t  type;                              // proximityEventType_t
+    uint32_t timestamp_us;                      // time of the sensor event
+    union
+    {
+        bool    presence;                       // presence state
+        bool    connected;                      // true while a central is connected
+        uint8_t zones;                          // bit n set if zone n is occupied
+        uint8_t motion[MOTION_VALUE_SIZE];      // motion characteristic value
+        struct
+        {
+            uint8_t request;                    // sensor_event_type_t
+            x4sensor_error_t status;            // result of the request
+        } sensor;
+    } payload;
+} proximityEvent_t;
+
+
+extern void proximityInit(void* eventQueue, updateSensorValueCb_t updateSensCb);
+extern void startSensor();
+extern void stopSensor();
+extern void setSensitivity(uint8_t sens);
+extern void calibrateSensor(void);
+extern void setRange(uint16_t range);
+extern uint8_t getSensitivity(void);
+extern uint16_t getRange(void);
+extern uint16_t getTimeout(void);
+extern uint16_t changeRange(void);
+extern void setPresenceTimeout(uint16_t tmout);
+extern void setPresenceHysteresis(uint16_t enterFrames, uint16_t enterMs, uint16_t exitFrames);
+extern bool configureRange(uint16_t range);
+extern bool configureSensitivity(uint8_t sens);
+extern bool configureTimeout(uint16_t tmout);
+extern void commitConfig(void);
+extern bool setSensingPolicy(sensingPolicy_t policy);
+extern sensingPolicy_t getSensingPolicy(void);
+extern void setConnectionState(bool connected);
+extern void dumpTrace(void);
+extern uint8_t getSensorValue();
+extern void getNotifyLatency(notifyLatency_t *latency);
+extern bool setZones(const proximityZone_t *zones, uint8_t count);
+extern bool setZonesValue(const uint8_t *value, uint16_t len);
+extern uint8_t getZoneValue(void);
+extern void setZoneCallback(updateSensorValueCb_t updateZoneCb);
+extern bool setTracking(bool enable);
+extern bool setMotionValue(const uint8_t *value, uint16_t len);
+extern uint16_t getMotionValue(uint8_t *value, uint16_t maxLen);
+extern void setMotionCallback(updateMotionValueCb_t updateMotionCb);
+extern bool setDetectorValue(const uint8_t *value, uint16_t len);
+extern uint16_t getDetectorValue(uint8_t *value, uint16_t maxLen);
+extern void setDetectorCallback(updateDetectorValueCb_t updateDetectorCb);
+extern bool setConfigValue(const uint8_t *value, uint16_t len);
+extern uint16_t getConfigValue(uint8_t *value, uint16_t maxLen);
+extern void setConfigCallback(updateConfigValueCb_t updateConfigCb);
+
+extern void processSensorEvent(const proximityEvent_t *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROXIMITY_H_ */
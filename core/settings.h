@@ -0,0 +1,47 @@
+/**
+ * @file settings.h
+ * @brief Persistent application settings.
+ *
+ * The settings are kept in flash with wear leveling and restored at boot, so the device starts
+ * with the last configuration without a central writing it again.
+ */
+
+#ifndef SETTINGS_H_
+#define SETTINGS_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include "novelda_sensor.h"
+#include "proximity.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SETTINGS_VERSION    4     // stored settings of another version are ignored
+
+/**
+ * @brief Settings stored in flash.
+ */
+typedef struct
+{
+    uint8_t  version;                           // SETTINGS_VERSION
+    uint8_t  sensitivity;                       // sensitivity level
+    uint16_t range;                             // range in cm
+    uint16_t timeout;                           // presence timeout in ms
+    uint8_t  detector_custom;                   // 1 if detector holds custom detector values
+    uint8_t  sensing_policy;                    // sensingPolicy_t
+    uint8_t  zone_count;                        // number of distance zones
+    proximityZone_t zones[MAX_ZONES];           // distance zones
+    uint8_t  tracking;                          // 1 if target tracking is enabled
+    x4sensor_detector_config_t detector;        // custom or calibrated detector values
+    sensor_metadata_t sensor;                   // identity and oscillator calibration of the sensor
+} settings_t;
+
+extern bool settings_init(void);
+extern bool settings_load(settings_t *settings);
+extern bool settings_store(const settings_t *settings);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SETTINGS_H_ */
@@ -0,0 +1,84 @@
+/**
+ * @file trace.h
+ * @brief Event trace recorder.
+ *
+ * Built with EVENT_TRACE defined, TRACE_RECORD() stores a record of 8 bytes with a microsecond
+ * timestamp in a RAM ring for the sensor interrupt, the bus transactions of the sensor driver,
+ * the semaphores of the chip interface, the timers and events of the proximity module and the
+ * notifications of the BLE service. The ring keeps the latest records. A dump writes them to
+ * the UART as TRACE_LINE_PREFIX lines, which tools/trace_export converts to a Chrome trace for
+ * viewing all of them on one timeline. Without EVENT_TRACE, TRACE_RECORD() compiles to nothing.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_LINE_PREFIX   "#TR"     // start of a dumped record on the UART
+#define TRACE_DUMP_COMMAND  0x01      // written to the Diagnostics characteristic to dump the trace
+
+/*
+ * Dumped record: TRACE_LINE_PREFIX, timestamp in us and event | arg << 8 | value << 16 as two
+ * 32 bit hex words. The records of a dump are in time order and end with a TRACE_DUMP_END record
+ * whose value is the number of records lost because the ring was full.
+ */
+typedef struct
+{
+    uint32_t timestamp_us;
+    uint8_t  event;                     // traceEvent_t
+    uint8_t  arg;
+    uint16_t value;
+} traceRecord_t;
+
+typedef enum
+{
+    TRACE_IRQ = 1,                      // sensor interrupt, arg 1
+    TRACE_BUS_BEGIN,                    // arg x4sensor_trace_op_t, value address or size
+    TRACE_BUS_END,                      // arg x4sensor_trace_op_t, value x4sensor_error_t
+    TRACE_SEM_GIVE,                     // arg traceSemaphore_t
+    TRACE_SEM_TAKE,                     // arg traceSemaphore_t, value 1 if taken, 0 on timeout
+    TRACE_TIMER,                        // arg traceTimer_t
+    TRACE_EVENT_BEGIN,                  // arg proximityEventType_t
+    TRACE_EVENT_END,                    // arg proximityEventType_t
+    TRACE_NOTIFY,                       // arg traceCharacteristic_t, value status of the BLE stack
+    TRACE_DUMP_END                      // value records lost
+} traceEvent_t;
+
+typedef enum
+{
+    TRACE_SEM_IRQ = 0,                  // sensor interrupt and wake-ups of the sensor task
+    TRACE_SEM_SPI                       // completion of an SPI transfer
+} traceSemaphore_t;
+
+typedef enum
+{
+    TRACE_TIMER_CONFIG = 0,
+    TRACE_TIMER_SETTINGS,
+    TRACE_TIMER_SCHEDULE
+} traceTimer_t;
+
+typedef enum
+{
+    TRACE_CHAR_DETECTION = 0,
+    TRACE_CHAR_ZONES,
+    TRACE_CHAR_MOTION
+} traceCharacteristic_t;
+
+#ifdef EVENT_TRACE
+#define TRACE_RECORD(event, arg, value) trace_record((event), (arg), (value))
+#else
+#define TRACE_RECORD(event, arg, value) ((void)0)
+#endif
+
+extern void trace_init(void);
+extern void trace_record(uint8_t event, uint8_t arg, uint16_t value);
+extern void trace_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H_ */
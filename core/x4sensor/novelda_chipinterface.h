@@ -204,7 +204,9 @@ chipinterface_error_t chipinterface_wait_us(uint32_t microseconds);
  * In order to achieve a correct frame rate and when no interrupt is used, the
  * elapsed time must be monitored. This function writes a monotonic increasing
  * counter value into the output parameter :c:var:`microseconds`. The
- * timestamps may wrap around.
+ * timestamps may wrap around, but only from 2^32 - 1 to 0, so that the
+ * unsigned difference of two timestamps is the elapsed time. Deriving them
+ * from a tick count in 32-bit arithmetic breaks this.
  *
  * It is enough if the underlying implementation to provide a resolution of 1 ms,
  * but it should not be less.
@@ -330,6 +332,42 @@ chipinterface_error_t chipinterface_set_clock_frequency(uint32_t frequencyHz);
 chipinterface_error_t chipinterface_transfer_spi(const uint8_t *wdata, size_t wlength,
                                                  uint8_t *rdata, size_t rlength);
 
+/**
+ * :brief: Starts an SPI transfer without waiting for its completion.
+ *
+ * This function performs the same bus transaction as
+ * :c:func:`chipinterface_transfer_spi`, but returns as soon as the transfer
+ * has been started, for instance by a DMA. Both buffers must stay valid until
+ * :c:func:`chipinterface_wait_transfer_spi` has returned. Only one transfer may
+ * be pending at a time.
+ *
+ * This function is only needed for pipelined recording reads via
+ * :c:func:`x4sensor_start_sensor_data_read`.
+ *
+ * :param wdata: pointer to the buffer containing data to write
+ * :param wlength: number of bytes to write
+ * :param rdata: pointer to the buffer where incoming data should be stored
+ * :param rlength: number of bytes to read
+ * :return: :c:var:`CHIPINTERFACE_SUCCESS` on success
+ */
+chipinterface_error_t chipinterface_transfer_spi_async(const uint8_t *wdata, size_t wlength,
+                                                       uint8_t *rdata, size_t rlength);
+
+/**
+ * :brief: Waits up to :c:var:`microseconds` for a pending SPI transfer
+ *
+ * A transfer that has not completed within the time limit is cancelled before
+ * this function returns, so the buffers may be reused in any case.
+ *
+ * :param microseconds: The time to wait or :c:var:`CHIPINTERFACE_WAIT_FOREVER`
+ * :return: :c:var:`CHIPINTERFACE_SUCCESS` when the transfer has completed,
+ *          :c:var:`CHIPINTERFACE_TIMEOUT` if it was cancelled, otherwise
+ *          :c:var:`CHIPINTERFACE_FAILURE`
+ *
+ * :See: :c:func:`chipinterface_transfer_spi_async`
+ */
+chipinterface_error_t chipinterface_wait_transfer_spi(uint32_t microseconds);
+
 /**
  * :brief: Reads the current state of the interrupt line.
  *
@@ -0,0 +1,1653 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+#ifndef NOVELDA_X4SENSOR_H
+#define NOVELDA_X4SENSOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "x4sensor_configuration.h"
+// For Novelda internal use only
+#if defined(BUILDING_NOVELDA_X4SENSOR) || defined(USING_NOVELDA_X4SENSOR)
+#include "x4_symbol_export.h"
+#endif
+
+#ifndef X4_SYMBOL_EXPORT
+#define X4_SYMBOL_EXPORT
+#endif
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * :file: novelda_x4sensor.h
+ *
+ * The X4Sensor C API interfaces a stand-alone detection algorithm running on
+ * the X4 hardware sensor to a bare metal host application. It takes care of
+ * the low-level communication with the sensor.
+ *
+ * The application life-cycle is as follows:
+ *
+ * 1. Initialize the library and the sensor with
+ *    :c:func:`x4sensor_initialize_i2c` or :c:func:`x4sensor_initialize_spi`.
+ *
+ * 2. Optionally configure the library with :c:func:`x4sensor_set_range_cm` and
+ *    :c:func:`x4sensor_set_sensitivity_level`.
+ *
+ * 3. Optionally prepare the sensor with :c:func:`x4sensor_prepare` ahead of
+ *    the start, then start the sensor operation
+ *
+ *    The sensor can operate in the following modes:
+ *
+ *    **Normal operation mode:**
+ *
+ *    - started by :c:func:`x4sensor_start_normal_mode`
+ *    - reports detections via a GPIO pin
+ *    - optimized for power consumption
+ *
+ *    **Event mode:**
+ *
+ *    - an event-based operation mode where the host is notified in case
+ *      of a subscribed event.
+ *    - started by :c:func:`x4sensor_start_event_mode`
+ *    - reports events by asserting a GPIO pin
+ *    - frame data must be read out via :c:func:`x4sensor_get_sensor_data`
+ *
+ *    **Recording mode:**
+ *
+ *    - reads out internal data from the hardware sensor and is used
+ *      for tests and validation.
+ *    - started by :c:func:`x4sensor_start_recording_mode`
+ *    - reports a new frame by asserting a GPIO pin
+ *    - frame data must be read out via :c:func:`x4sensor_get_sensor_data`
+ *
+ * 4. The sensor may be stopped by calling :c:func:`x4sensor_stop`.
+ *
+ */
+
+/**
+ * :brief: Error codes used in the X4Sensor API
+ */
+typedef int8_t x4sensor_error_t;
+/** The function call was successful */
+static const x4sensor_error_t X4SENSOR_SUCCESS = 0;
+/** An unspecified error happened */
+static const x4sensor_error_t X4SENSOR_FAILURE = -1;
+/** The blob size is wrong */
+static const x4sensor_error_t X4SENSOR_CONFIGURATION_INVALID_SIZE = -2;
+/** Blob data corrupted */
+static const x4sensor_error_t X4SENSOR_CONFIGURATION_INVALID_DATA = -3;
+/** Blob seems valid but has wrong type */
+static const x4sensor_error_t X4SENSOR_CONFIGURATION_INVALID_TYPE = -4;
+/** Blob data format is not compatible to this x4sensor build */
+static const x4sensor_error_t X4SENSOR_CONFIGURATION_INVALID_LAYOUT = -5;
+/** The X4 firmware interface is not compatible to this version of x4sensor lib. */
+static const x4sensor_error_t X4SENSOR_FIRMWARE_INCOMPATIBLE_INTERFACE_VERSION = -10;
+/** An error happened while verifying the firmware. Check the hardware connection. */
+static const x4sensor_error_t X4SENSOR_FIRMWARE_VERIFICATION_FAILED = -11;
+ /** An error happened in a call to a chipinterface function */
+static const x4sensor_error_t X4SENSOR_CHIPINTERFACE_ERROR = -12;
+/** Initial contact to the sensor failed, most likely a connection problem */
+static const x4sensor_error_t X4SENSOR_SENSOR_DISCOVERY_FAILED = -13;
+/** A function was called with one or more invalid parameter values */
+static const x4sensor_error_t X4SENSOR_INVALID_PARAMETER = -14;
+/** A function was called while it was not allowed */
+static const x4sensor_error_t X4SENSOR_NOT_ALLOWED = -15;
+/** The measured X4 oscillator frequency is outside the plausible range */
+static const x4sensor_error_t X4SENSOR_OSCILLATOR_FREQUENCY_NOT_PLAUSIBLE = -16;
+/** The feature is not configured/supported */
+static const x4sensor_error_t X4SENSOR_FEATURE_NOT_SUPPORTED = -17;
+/** The frame counter not increased */
+static const x4sensor_error_t X4SENSOR_FRAME_COUNTER_NOT_INCREASED = -18;
+/** The sensor data is not ready to be read*/
+static const x4sensor_error_t X4SENSOR_DATA_NOT_READY = -19;
+/** The host cannot keep up with the requested recording configuration */
+static const x4sensor_error_t X4SENSOR_BUDGET_EXCEEDED = -20;
+/** All configuration slots are in use */
+static const x4sensor_error_t X4SENSOR_CONFIGURATION_REGISTRY_FULL = -21;
+
+/**
+ * :brief: Number of configuration blobs that may be added with
+ *         :c:func:`x4sensor_add_configuration`
+ */
+#ifndef X4SENSOR_MAX_CONFIGURATIONS
+#define X4SENSOR_MAX_CONFIGURATIONS 4
+#endif
+
+/**
+ * :brief: A single event flag
+ *
+ * The event mode is started by :c:func:`x4sensor_start_event_mode`.
+ */
+typedef enum x4sensor_event_flag_t {
+    /**
+     * Enables periodic reports from the sensor. Can be used for keep-alive
+     * checks of the sensor hardware or just for periodic updates of the host.
+     * The report interval is configured with
+     * :c:func:`x4sensor_set_periodic_report_interval`.
+     */
+    X4SENSOR_EVENT_PERIODIC_REPORT = 1 << 0,
+
+    /**
+     * Enables notifications when the detetion state changes. Depending on the
+     * algorithm configuration this may be the proximity or occupancy state.
+     */
+    X4SENSOR_EVENT_STATE_CHANGE = 1 << 1
+} x4sensor_event_flag_t;
+
+/**
+ * :brief: A combination of :c:enum:`x4sensor_event_flag_t` event flags
+ */
+typedef uint8_t x4sensor_event_flags_t;
+
+/**
+ * :brief: Various test modes used in :c:func:`x4sensor_start_test_mode`.
+ */
+typedef enum x4_test_mode_t {
+    X4_TEST_MODE_M1 = 0,
+    X4_TEST_MODE_M2 = 1,
+    X4_TEST_MODE_M3 = 2,
+    X4_TEST_MODE_NORMAL = 3,
+    X4_TEST_MODE_FCC10_TX0 = 4,
+    X4_TEST_MODE_FCC10_TX3 = 5,
+    X4_TEST_MODE_M1_KCC = 6,
+    X4_TEST_MODE_M2_KCC = 7
+} x4_test_mode_t;
+
+/**
+ * :brief: Meta information about the sensor and the firmware
+ */
+typedef struct x4sensor_info_t {
+    /** The hardware sensor's serial number */
+    uint32_t sample_id;
+    /** The hardware sensor's revision id */
+    uint8_t  chip_revision;
+    /** Major, minor and patch number of the algorithm version */
+    uint8_t algorithm_version[3];
+    /** A firmware version identifier, little endian */
+    uint32_t firmware_version;
+    /** Identifies the algorithm version, little endian */
+    uint32_t algorithm_commit_hash;
+    /** Identifies the algorithm variant, little endian */
+    uint32_t algorithm_variant_hash;
+} x4sensor_info_t;
+
+
+/**
+ * :brief: A window of detection power values
+ *
+ * A distance cluster contains the signal power values per range bin around the
+ * first detector hit. A detector hit occurs when the processed radar signal
+ * exceeds the configured sensitivity threshold at a certain range bin.
+ *
+ * The distance cluster starts one range bin before the first hit and ends
+ * multiple bins later. The actual length of the distance cluster is
+ * preconfigured by the algorithm and can be obtained from
+ * :c:func:`x4sensor_get_distance_cluster_length`.
+ *
+ * The :c:member:`x4sensor_distance_cluster_t.first_detection_bin_distance_mm`
+ * member is the distance from the sensor to the range bin with the detection
+ * hit. That is the second entry in the cluster.
+ *
+ * :See: :c:func:`x4sensor_set_sensitivity_level`,
+ *       :c:func:`x4sensor_get_distance_cluster_length`
+ */
+typedef struct x4sensor_distance_cluster_t {
+    /** True if the cluster has power values above the threshold */
+    bool detector_hit;
+    /** Distance in mm to first bin above the threshold */
+    uint16_t first_detection_bin_distance_mm;
+    /** Signal power per range bin */
+    uint32_t bin_power[DISTANCE_CLUSTER_LENGTH];
+} x4sensor_distance_cluster_t;
+
+/**
+ * :brief: Column arrays filled by :c:func:`x4sensor_decode_payloads`
+ *
+ * Each array holds one entry per decoded frame. Arrays that are NULL are not
+ * decoded. :c:member:`x4sensor_payload_columns_t.bin_power` holds one array
+ * per distance cluster bin, so ``bin_power[bin][frame]`` corresponds to
+ * ``bin_power[bin]`` of :c:func:`x4sensor_get_distance_cluster` for that frame.
+ */
+typedef struct x4sensor_payload_columns_t {
+    /** Frame counters */
+    uint32_t *frame_counter;
+    /** Detection states */
+    bool *presence;
+    /** First distance cluster bin above the threshold, 0xff if none */
+    uint8_t *first_bin;
+    /** Signal power per distance cluster bin and frame */
+    uint32_t *bin_power[DISTANCE_CLUSTER_LENGTH];
+} x4sensor_payload_columns_t;
+
+/**
+ * :brief: Maximum number of detector range bins of any algorithm
+ */
+#define X4SENSOR_MAX_RANGE_BINS 24
+
+/**
+ * :brief: Detector thresholds and presence logic
+ *
+ * Used by :c:func:`x4sensor_set_detector_config` to replace the values
+ * selected by :c:func:`x4sensor_set_sensitivity_level`. The presence logic
+ * consists of two M-of-N stages.
+ */
+typedef struct x4sensor_detector_config_t {
+    /** Number of valid thresholds, see :c:func:`x4sensor_get_number_of_detector_bins` */
+    uint8_t threshold_count;
+    /** Detection threshold per detector range bin */
+    uint16_t thresholds[X4SENSOR_MAX_RANGE_BINS];
+    /** Number of detections required within N frames, per stage */
+    uint8_t M[2];
+    /** Window length in frames, per stage */
+    uint8_t N[2];
+} x4sensor_detector_config_t;
+
+/**
+ * :brief: Host interface to the hardware sensor
+ */
+typedef enum x4sensor_bus_t {
+    X4SENSOR_BUS_I2C = 0,
+    X4SENSOR_BUS_SPI = 1
+} x4sensor_bus_t;
+
+/**
+ * :brief: Action taken when recording mode exceeds the host budget
+ *
+ * :See: :c:func:`x4sensor_set_recording_budget_policy`
+ */
+typedef enum x4sensor_budget_policy_t {
+    /** Start recording mode regardless of the budget */
+    X4SENSOR_BUDGET_POLICY_IGNORE = 0,
+    /** Refuse to start with :c:var:`X4SENSOR_BUDGET_EXCEEDED` */
+    X4SENSOR_BUDGET_POLICY_REFUSE = 1,
+    /** Report only every Nth frame so that the host keeps up */
+    X4SENSOR_BUDGET_POLICY_DECIMATE = 2
+} x4sensor_budget_policy_t;
+
+/**
+ * :brief: Host interface operation reported to the trace hook
+ *
+ * :See: :c:func:`x4sensor_set_trace_hook`
+ */
+typedef enum x4sensor_trace_op_t {
+    X4SENSOR_TRACE_UPLOAD_FIRMWARE = 0,
+    X4SENSOR_TRACE_SET_RUN_MODE = 1,
+    X4SENSOR_TRACE_GET_REGISTER = 2,
+    X4SENSOR_TRACE_SET_REGISTER = 3,
+    X4SENSOR_TRACE_WRITE_CONFIG = 4,
+    X4SENSOR_TRACE_READ_DATA = 5,
+    X4SENSOR_TRACE_START_READ_DATA = 6,
+    X4SENSOR_TRACE_FINISH_READ_DATA = 7,
+    X4SENSOR_TRACE_DESTROY = 8,
+    X4SENSOR_TRACE_START_LPOSC_MEASUREMENT = 9,
+    X4SENSOR_TRACE_CLEAR_INTERRUPT = 10,
+    X4SENSOR_TRACE_DISCOVER_SENSOR = 11,
+    X4SENSOR_TRACE_OP_COUNT
+} x4sensor_trace_op_t;
+
+/**
+ * :brief: Called at the start and at the end of every host interface operation
+ *
+ * At the start :c:var:`value` is the register address, the run mode, the
+ * number of firmware bytes, the size of the read buffer or the number of LPOSC
+ * ticks, depending on the operation, otherwise 0. At the end it is the
+ * :c:type:`x4sensor_error_t` result of the operation. The hook is called in
+ * the context of the caller of the library and must return quickly.
+ *
+ * :See: :c:func:`x4sensor_set_trace_hook`
+ */
+typedef void (*x4sensor_trace_hook_t)(x4sensor_trace_op_t op, bool end, uint16_t value);
+
+/**
+ * :brief: Host side timing of recording mode frame reads
+ *
+ * Describes the properties of the host platform that are not known to the
+ * X4Sensor library.
+ *
+ * :See: :c:func:`x4sensor_set_recording_host_timing`
+ */
+typedef struct x4sensor_host_timing_t {
+    /** Resolution of :c:func:`chipinterface_wait_us` in us. Command waits are
+     *  rounded up to it. Tick based implementations wait at least one tick. */
+    uint32_t wait_resolution_us;
+    /** Driver and scheduling overhead per bus transaction in us */
+    uint32_t transaction_overhead_us;
+    /** Host processing time per frame in us */
+    uint32_t cpu_time_per_frame_us;
+    /** True if frames are read with :c:func:`x4sensor_start_sensor_data_read`
+     *  so that the radar data transfer overlaps the processing */
+    bool pipelined;
+} x4sensor_host_timing_t;
+
+/**
+ * :brief: Recording configuration evaluated by :c:func:`x4sensor_plan_recording`
+ */
+typedef struct x4sensor_recording_setup_t {
+    /** Host interface */
+    x4sensor_bus_t bus;
+    /** Actual bus clock in Hz */
+    uint32_t bus_frequency_hz;
+    /** Number of range bins in the recorded radar data */
+    uint8_t range_bins;
+    /** Frame rate of the sensor in frames per second */
+    uint8_t frame_rate;
+    /** Host side timing */
+    x4sensor_host_timing_t host;
+} x4sensor_recording_setup_t;
+
+/**
+ * :brief: Per-frame host budget of recording mode
+ *
+ * All times are per frame. :c:member:`x4sensor_recording_budget_t.frame_time_us`
+ * is the time the host is busy with one frame and must not exceed
+ * :c:member:`x4sensor_recording_budget_t.frame_period_us`.
+ */
+typedef struct x4sensor_recording_budget_t {
+    /** Time between two frames */
+    uint32_t frame_period_us;
+    /** Time the bus clocks data */
+    uint32_t bus_time_us;
+    /** Time spent in command waits including the wait resolution */
+    uint32_t wait_time_us;
+    /** Driver overhead of all bus transactions */
+    uint32_t overhead_time_us;
+    /** Host processing time */
+    uint32_t cpu_time_us;
+    /** Total host time, processing hidden behind transfers is not counted */
+    uint32_t frame_time_us;
+    /** Number of bus transactions */
+    uint16_t transactions;
+    /** Number of bytes on the bus */
+    uint16_t bytes;
+    /** Frame time relative to the frame period in 1/1000 */
+    uint16_t load_permille;
+    /** Smallest periodic report interval in frames the host keeps up with */
+    uint16_t min_report_interval;
+} x4sensor_recording_budget_t;
+
+/**
+ * :brief: Operations on the host interface since initialization
+ *
+ * The byte counts of commands and register accesses are nominal, the bus
+ * framing is added by :c:func:`x4sensor_estimate_energy`.
+ *
+ * :See: :c:func:`x4sensor_get_driver_stats`
+ */
+typedef struct x4sensor_driver_stats_t {
+    /** Number of host interface operations */
+    uint32_t transactions;
+    /** Number of bytes moved over the bus */
+    uint32_t bytes;
+    /** Number of firmware uploads */
+    uint32_t firmware_uploads;
+    /** Number of sensor data reads */
+    uint32_t data_reads;
+    /** Number of operations that failed */
+    uint32_t errors;
+    /** Host interface */
+    x4sensor_bus_t bus;
+    /** Actual bus clock in Hz */
+    uint32_t bus_frequency_hz;
+} x4sensor_driver_stats_t;
+
+/**
+ * :brief: Per-board calibration of the energy model
+ *
+ * Currents are in nA, charges in nC. All fields are 32 bit, so the structure
+ * can be logged as words and read back on a PC.
+ *
+ * :See: :c:func:`x4sensor_estimate_energy`
+ */
+typedef struct x4sensor_energy_coefficients_t {
+    /** Board current with the host asleep and the sensor disabled */
+    uint32_t idle_na;
+    /** Additional current while the sensor is enabled, between frames */
+    uint32_t sensor_on_na;
+    /** Sensor charge of one radar frame */
+    uint32_t sensor_frame_nc;
+    /** Sensor start-up charge of a firmware upload, without the bus time */
+    uint32_t firmware_upload_nc;
+    /** Additional current of the bus and the sensor interface while clocking */
+    uint32_t bus_active_na;
+    /** Host charge of one bus transaction besides the transfer */
+    uint32_t transaction_nc;
+    /** Additional current of the running CPU */
+    uint32_t cpu_active_na;
+    /** Charge of one CPU wake-up from sleep */
+    uint32_t wakeup_nc;
+    /** Radio charge of one empty connection event */
+    uint32_t connection_event_nc;
+    /** Additional radio charge of one notification */
+    uint32_t notification_nc;
+    /** Radio charge of one advertising event on all channels */
+    uint32_t advertising_event_nc;
+} x4sensor_energy_coefficients_t;
+
+/**
+ * :brief: Activity of the board over a period of time
+ *
+ * All fields are 32 bit, so the structure can be logged as words and read
+ * back on a PC.
+ *
+ * :See: :c:func:`x4sensor_estimate_energy`
+ */
+typedef struct x4sensor_energy_activity_t {
+    /** Length of the period in ms */
+    uint32_t duration_ms;
+    /** Time the sensor was enabled in ms */
+    uint32_t sensor_ms;
+    /** Frame rate of the sensor in frames per second */
+    uint32_t frame_rate;
+    /** Host interface, :c:type:`x4sensor_bus_t` */
+    uint32_t bus;
+    /** Actual bus clock in Hz */
+    uint32_t bus_frequency_hz;
+    /** Host interface operations in the period, see :c:type:`x4sensor_driver_stats_t` */
+    uint32_t transactions;
+    /** Bytes moved over the bus in the period */
+    uint32_t bytes;
+    /** Firmware uploads in the period */
+    uint32_t firmware_uploads;
+    /** Sensor data reads in the period */
+    uint32_t data_reads;
+    /** Failed host interface operations in the period */
+    uint32_t errors;
+    /** CPU wake-ups from sleep, 0 if not counted */
+    uint32_t wakeups;
+    /** CPU running time in ms, 0 if not measured */
+    uint32_t cpu_ms;
+    /** Time a central was connected in ms */
+    uint32_t connected_ms;
+    /** Connection interval in us */
+    uint32_t connection_interval_us;
+    /** Time spent advertising in ms */
+    uint32_t advertising_ms;
+    /** Advertising interval in us */
+    uint32_t advertising_interval_us;
+    /** Number of notifications sent */
+    uint32_t notifications;
+} x4sensor_energy_activity_t;
+
+/**
+ * :brief: Estimated average currents over a period, in nA
+ *
+ * :See: :c:func:`x4sensor_estimate_energy`
+ */
+typedef struct x4sensor_energy_estimate_t {
+    /** Board floor */
+    uint32_t idle_na;
+    /** Sensor, radar frames and firmware uploads */
+    uint32_t sensor_na;
+    /** Bus transfers and transactions */
+    uint32_t bus_na;
+    /** CPU running and wake-ups */
+    uint32_t cpu_na;
+    /** Connection events, notifications and advertising */
+    uint32_t radio_na;
+    /** Sum of all parts */
+    uint32_t total_na;
+    /** Time the bus clocked data in us */
+    uint32_t bus_time_us;
+} x4sensor_energy_estimate_t;
+
+/**
+ * :brief: Parameters of a background calibration
+ *
+ * :See: :c:func:`x4sensor_calibration_init`
+ */
+typedef struct x4sensor_calibration_setup_t {
+    /** Number of frames to accumulate, at least 2 */
+    uint16_t frames;
+    /** Right shift from squared radar sample units to detector threshold units */
+    uint8_t power_shift;
+    /** Margin above the mean power in standard deviations, Q4 */
+    uint8_t sigma_q4;
+    /** Scale applied to the resulting thresholds in percent, 100 for none */
+    uint16_t margin_percent;
+} x4sensor_calibration_setup_t;
+
+/**
+ * :brief: State of a background calibration
+ *
+ * Holds running power statistics per detector range bin. No frame history is
+ * stored, the size is independent of the number of calibration frames. The
+ * members are private to the X4Sensor library.
+ */
+typedef struct x4sensor_calibration_t {
+    x4sensor_calibration_setup_t setup;
+    uint8_t radar_bins;
+    uint8_t detector_bins;
+    uint8_t decimation;
+    uint16_t frames;
+    size_t frame_size;
+    /** Static background per detector bin, I and Q in Q8 */
+    int32_t background[X4SENSOR_MAX_RANGE_BINS][2];
+    /** Running mean of the power per detector bin in Q8 */
+    int64_t power_mean[X4SENSOR_MAX_RANGE_BINS];
+    /** Running sum of squared power deviations per detector bin */
+    uint64_t power_m2[X4SENSOR_MAX_RANGE_BINS];
+} x4sensor_calibration_t;
+
+/**
+ * :brief: Radial direction of a tracked target
+ */
+typedef enum x4sensor_direction_t {
+    /** No target or no significant radial movement */
+    X4SENSOR_DIRECTION_NONE = 0,
+    /** The target moves towards the sensor */
+    X4SENSOR_DIRECTION_APPROACHING = 1,
+    /** The target moves away from the sensor */
+    X4SENSOR_DIRECTION_LEAVING = 2,
+} x4sensor_direction_t;
+
+/**
+ * :brief: Parameters of a target tracker
+ *
+ * :See: :c:func:`x4sensor_tracker_init`
+ */
+typedef struct x4sensor_tracker_setup_t {
+    /** Distance gain of the alpha-beta filter, Q8 in (0, 256] */
+    uint16_t alpha_q8;
+    /** Velocity gain of the alpha-beta filter, Q8 in (0, alpha_q8] */
+    uint16_t beta_q8;
+    /** Radial speed in mm/s above which a target approaches or leaves */
+    uint16_t speed_mm_s;
+    /** Number of frames without detection before the track is dropped */
+    uint8_t coast_frames;
+} x4sensor_tracker_setup_t;
+
+/**
+ * :brief: State of a target tracker
+ *
+ * The members are private to the X4Sensor library, the estimates are returned
+ * by :c:func:`x4sensor_tracker_update`.
+ */
+typedef struct x4sensor_tracker_t {
+    x4sensor_tracker_setup_t setup;
+    uint8_t frame_rate;
+    uint16_t bin_spacing_mm;
+    bool valid;
+    /** Frame counter of the last measurement */
+    uint32_t frame_counter;
+    /** Distance estimate in mm, Q8 */
+    int32_t distance_q8;
+    /** Radial velocity estimate in mm/s, Q8, negative when approaching */
+    int32_t velocity_q8;
+    x4sensor_direction_t direction;
+} x4sensor_tracker_t;
+
+/**
+ * :brief: Output of :c:func:`x4sensor_tracker_update`
+ */
+typedef struct x4sensor_track_t {
+    /** True while a target is tracked */
+    bool valid;
+    /** True if :c:member:`x4sensor_track_t.direction` changed with this frame */
+    bool direction_changed;
+    /** Classification of the radial movement */
+    x4sensor_direction_t direction;
+    /** Filtered distance in mm */
+    uint16_t distance_mm;
+    /** Filtered radial velocity in mm/s, negative when approaching */
+    int16_t velocity_mm_s;
+} x4sensor_track_t;
+
+/**
+ * :brief: State of a presence state machine
+ */
+typedef enum x4sensor_presence_state_t {
+    /** No presence */
+    X4SENSOR_PRESENCE_ABSENT = 0,
+    /** Detection seen, presence not reported yet */
+    X4SENSOR_PRESENCE_ENTERING = 1,
+    /** Presence */
+    X4SENSOR_PRESENCE_PRESENT = 2,
+    /** Detection lost, presence still reported */
+    X4SENSOR_PRESENCE_EXITING = 3,
+} x4sensor_presence_state_t;
+
+/**
+ * :brief: Parameters of a presence state machine
+ *
+ * A transition needs both the number of frames and the time, a value of 0
+ * disables that condition.
+ *
+ * :See: :c:func:`x4sensor_presence_configure`
+ */
+typedef struct x4sensor_presence_setup_t {
+    /** Consecutive frames with detection before presence is reported */
+    uint16_t enter_frames;
+    /** Time in ms the detection lasts before presence is reported */
+    uint16_t enter_ms;
+    /** Consecutive frames without detection before absence is reported */
+    uint16_t exit_frames;
+    /** Time in ms without detection before absence is reported */
+    uint16_t exit_ms;
+} x4sensor_presence_setup_t;
+
+/**
+ * :brief: Presence state machine
+ *
+ * The members are private to the X4Sensor library, the state is returned by
+ * :c:func:`x4sensor_presence_get_state`. A zero initialized state machine is
+ * absent and has to be configured before use.
+ */
+typedef struct x4sensor_presence_t {
+    x4sensor_presence_setup_t setup;
+    uint8_t frame_rate;
+    x4sensor_presence_state_t state;
+    /** Frame counter of the first frame of the pending transition */
+    uint32_t frame_counter;
+    /** Time in us of the first frame of the pending transition */
+    uint32_t time_us;
+} x4sensor_presence_t;
+
+/**
+ *  :brief: Set number of retransmition attemts
+ *
+ *  This function sets up the number of times the communication
+ *  will be retried before the read/write function returns error.
+ *  Default value of 5 is used if user doesn't set otherwise.
+ *
+ *  :param retry_count: a value of retry number
+ *  :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_set_retry_count(uint8_t retry_count);
+
+/**
+ *  :brief: Get number of retransmition attemts
+ *
+ *  This function returns the number of times the communication
+ *  will be retried before the read/write function returns error.
+ *
+ *  :return: number of retry attempts
+ */
+X4_SYMBOL_EXPORT uint8_t x4sensor_get_retry_count(void);
+
+/**
+ *  :brief: Get a total number of retransmition attemts made
+ *
+ *  This function returns the total number of retries that has been made
+ *  since X4 sensor initialization.
+ *
+ *  :return: number of retries made
+ */
+X4_SYMBOL_EXPORT uint32_t x4sensor_get_retries_total_count(void);
+
+/**
+ *  :brief: Sets the trace hook of the host interface
+ *
+ *  While a hook is set, every operation on the bus is reported to it, for
+ *  instance to record the bus transactions on a timeline.
+ *
+ *  This function may be called at any time.
+ *
+ *  :param hook: the hook, NULL to stop reporting
+ */
+X4_SYMBOL_EXPORT void x4sensor_set_trace_hook(x4sensor_trace_hook_t hook);
+
+/**
+ *  :brief: Gets the operations on the host interface
+ *
+ *  The counters start at 0 when the library is loaded and keep counting
+ *  across initializations. Differences of two readings are the operations in
+ *  between, also across a wrap of the counters.
+ *
+ *  This function may be called at any time. The counters are updated by the
+ *  caller of the library, a reading from another task may be one operation
+ *  behind.
+ *
+ *  :param stats: receives the counters
+ */
+X4_SYMBOL_EXPORT void x4sensor_get_driver_stats(x4sensor_driver_stats_t *stats);
+
+/**
+ *  :brief: Initializes and sets up the X4Sensor library for I2C communication
+ *
+ *  This function sets up the low-level chip interface and prepares the
+ *  hardware sensor for operation. It is the first function to be called.
+ *
+ *  :param configuration: a pointer to the configuration binary blob
+ *  :param configuration_size: the configuration size
+ *  :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_initialize_i2c(const uint8_t *configuration, size_t configuration_size);
+
+/**
+ * :brief: Initializes and sets up the X4Sensor library for SPI communication
+ *
+ * This function sets up the low-level chip interface and prepares the
+ * hardware sensor for operation. It is the first function to be called.
+ *
+ * :param configuration: a pointer to the configuration binary blob
+ * :param configuration_size: the configuration size
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_initialize_spi(const uint8_t *configuration, size_t configuration_size);
+
+/**
+ * :brief: Frees up all resources used by X4Sensor
+ *
+ * This function may be called when the X4Sensor is no longer needed. After
+ * that, one might start over again with :c:func:`x4sensor_initialize_i2c` or
+ * :c:func:`x4sensor_initialize_spi`. This function may be called at any time,
+ * even without stopping the sensor.
+ *
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_deinitialize();
+
+/**
+ * :brief: Re-initializes X4Sensor after an error
+ *
+ * This function disables the chip and discovers it again on the bus of the
+ * last initialization, like :c:func:`x4sensor_initialize_i2c` or
+ * :c:func:`x4sensor_initialize_spi` but without creating the chip interface.
+ * The registered configurations and the selected configuration are kept, the
+ * run-time parameters return to the defaults of that configuration. The
+ * firmware is uploaded again by the next start.
+ *
+ * Use this function to recover when :c:func:`x4sensor_get_sensor_data` or a
+ * start failed, which disables the sensor, or when the sensor stopped
+ * reporting. This function may be called at any time after a successful
+ * initialization.
+ *
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_reinitialize();
+
+/**
+ * :brief: Adds a configuration blob to the resident configurations
+ *
+ * The blob is validated and parsed once and the results, including the
+ * firmware hash, are kept for :c:func:`x4sensor_select_configuration`. The
+ * blob must stay valid for the lifetime of the library, usually it is a
+ * constant in flash. Adding the same blob again returns its existing index.
+ * The blob passed to :c:func:`x4sensor_initialize_i2c` or
+ * :c:func:`x4sensor_initialize_spi` is added automatically. This function may
+ * be called at any time.
+ *
+ * :param configuration: a pointer to the configuration binary blob
+ * :param configuration_size: the configuration size
+ * :param index: returns the index of the configuration
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_add_configuration(const uint8_t *configuration, size_t configuration_size, uint8_t *index);
+
+/**
+ * :brief: Switches to another resident configuration
+ *
+ * Range, sensitivity level and periodic report interval are reset to the
+ * defaults of the selected configuration. The firmware is uploaded by the
+ * next call to one of the start functions, no blob parsing is involved. May
+ * only be called while the sensor is stopped.
+ *
+ * :param index: index returned by :c:func:`x4sensor_add_configuration`
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_select_configuration(uint8_t index);
+
+/**
+ * :brief: Returns the index of the active configuration
+ */
+X4_SYMBOL_EXPORT uint8_t x4sensor_get_configuration_index();
+
+/**
+ * :brief: Returns the number of resident configurations
+ */
+X4_SYMBOL_EXPORT uint8_t x4sensor_get_configuration_count();
+
+/**
+ * :brief: Shows meta information about the sensor and the firmware
+ *
+ * This function returns a pointer to a struct with meta information about the
+ * sensor and its firmware. It may be called at any time after initializing
+ * the X4Sensor library.
+ *
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT const x4sensor_info_t *x4sensor_get_info();
+
+/**
+ * :brief: Returns the low power oscillator correction of the sensor
+ *
+ * The first start after a discovery of the sensor measures the frequency of
+ * the X4 low power oscillator, which takes a few hundred milliseconds. The
+ * resulting correction belongs to the chip and may be stored together with
+ * :c:member:`x4sensor_info_t.sample_id` and restored with
+ * :c:func:`x4sensor_set_lposc_correction` after the next discovery of the same
+ * chip.
+ *
+ * :return: the correction factor multiplied by 1000, 0 if not measured yet
+ */
+X4_SYMBOL_EXPORT uint32_t x4sensor_get_lposc_correction();
+
+/**
+ * :brief: Restores the low power oscillator correction of the sensor
+ *
+ * Skips the measurement of the low power oscillator at the next start. The
+ * correction is reset by every discovery of the sensor, call this function
+ * after initialization or :c:func:`x4sensor_reinitialize` while the sensor is
+ * stopped.
+ *
+ * :param factor_1000: a correction returned by
+ *                     :c:func:`x4sensor_get_lposc_correction` for this chip
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_set_lposc_correction(uint32_t factor_1000);
+
+/**
+ * :brief: Returns the configured detection range
+ *
+ * The value returned may differ from desired range inputted to
+ * :c:func:`x4sensor_set_range_cm` function.
+ * If no range has been configured, a default value is returned.
+ *
+ * :See: :c:func:`x4sensor_set_range_cm`
+ * :return: detection range in centimeters
+ */
+X4_SYMBOL_EXPORT uint16_t x4sensor_get_range_cm();
+
+/**
+ * :brief: Returns the configured sensitivity level
+ *
+ * If no sensitivity has been configured, a default value is returned.
+ *
+ * :return: sensitivity level, 0 if custom values have been set with
+ *          :c:func:`x4sensor_set_detector_config`
+ *
+ * :See: :c:func:`x4sensor_set_sensitivity_level`
+ */
+X4_SYMBOL_EXPORT uint8_t x4sensor_get_sensitivity_level();
+
+/**
+ * :brief: Returns the sensor frame rate
+ *
+ * :return: frame rate in frames per second
+ */
+X4_SYMBOL_EXPORT uint8_t x4sensor_get_frame_rate();
+
+/**
+ * :brief: Lowers the frame rate of the sensor by a whole divider
+ *
+ * The sweep period of the sensor is multiplied by the divider, the sensor
+ * measures :c:func:`x4sensor_get_frame_rate` / divider frames per second. The
+ * divider must divide the frame rate, so the lowered rate is a whole number
+ * of frames per second. All values counted in frames, such as the M-of-N
+ * windows of the detector and the periodic report interval, keep their
+ * number of frames and last divider times longer.
+ *
+ * While the sensor is running, the new sweep period is written to the sensor,
+ * which applies it from the next frame on. Otherwise the divider applies to
+ * the next start. Selecting a configuration resets the divider to 1.
+ *
+ * :param divider: frame rate divider, 1 for the full frame rate
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ *
+ * :See: :c:func:`x4sensor_get_detection_latency_us`
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_set_frame_rate_divider(uint8_t divider);
+
+/**
+ * :brief: Returns the frame rate divider
+ *
+ * This function may be called while the sensor is running.
+ *
+ * :return: frame rate divider, 0 on error
+ *
+ * :See: :c:func:`x4sensor_set_frame_rate_divider`
+ */
+X4_SYMBOL_EXPORT uint8_t x4sensor_get_frame_rate_divider();
+
+/**
+ * :brief: Returns the worst-case detection latency of the detector
+ *
+ * The time from the arrival of a target until the detector reports it, for a
+ * target that is detected in every frame: up to one frame until the first
+ * frame that sees it, and the frames that fill both M-of-N windows of the
+ * detector. The frame period is that of the current frame rate divider.
+ *
+ * This function may be called while the sensor is running.
+ *
+ * :return: latency in microseconds, 0 on error
+ *
+ * :See: :c:func:`x4sensor_set_frame_rate_divider`,
+ *       :c:func:`x4sensor_get_detector_config`
+ */
+X4_SYMBOL_EXPORT uint32_t x4sensor_get_detection_latency_us();
+
+/**
+ * :brief: Sets the maximum detection range
+ *
+ * This function allows the user to set the maximum detection range of the
+ * sensor. Since the radar sensor divides the detection zone in range bins,
+ * the observed range might not match the configured value exactly.
+ *
+ * This function may be called after initialization and while the sensor is
+ * stopped.
+ *
+ * :param centimeters: the desired maximum detection range in centimeters
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_set_range_cm(uint16_t centimeters);
+
+/**
+ * :brief: Sets the sensitivity level
+ *
+ * The sensitivity level configures the sensitivity of the sensor. Each
+ * firmware comes with a set of sensitivity thresholds. The meaning of the
+ * different levels depends on the actual firmware. A higher value means
+ * usually "more sensitive." The maximum value depends on the actual firmware
+ * and algorithm and can be obtained from the release documentation.
+ *
+ * This function may be called after initialization and while the sensor is
+ * stopped.
+ *
+ * :param level: a value greater than 0
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_set_sensitivity_level(uint8_t level);
+
+/**
+ * :brief: Returns the number of detector range bins
+ *
+ * This is the number of thresholds expected by
+ * :c:func:`x4sensor_set_detector_config`.
+ *
+ * :return: the number of bins or 0 if the library is not initialized
+ */
+X4_SYMBOL_EXPORT uint8_t x4sensor_get_number_of_detector_bins();
+
+/**
+ * :brief: Reads the active detector thresholds and presence logic
+ *
+ * :param detector: the destination
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_get_detector_config(x4sensor_detector_config_t *detector);
+
+/**
+ * :brief: Sets custom detector thresholds and presence logic
+ *
+ * This function replaces the thresholds and M-of-N values of the current
+ * sensitivity level, for instance to tune the detector per installation.
+ * :c:member:`x4sensor_detector_config_t.threshold_count` must match
+ * :c:func:`x4sensor_get_number_of_detector_bins` and every M must be between 1
+ * and its N. :c:func:`x4sensor_get_sensitivity_level` returns 0 afterwards
+ * until :c:func:`x4sensor_set_sensitivity_level` is called again.
+ *
+ * Unlike other settings this function may also be called while the sensor is
+ * running. The new values are then written to the sensor right away and
+ * become effective without restarting it.
+ *
+ * :param detector: the new detector configuration
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_set_detector_config(const x4sensor_detector_config_t *detector);
+
+/**
+ * :brief: Sets the interval length of periodic sensor reports
+ *
+ * This function sets the interval length of periodic sensor reports. The
+ * interval length is specified in number of frames. This option is only
+ * effective when the sensor is started in event mode with
+ * :c:member:`x4sensor_event_flag_t.X4SENSOR_EVENT_PERIODIC_REPORT` subscribed.
+ *
+ * This function may be called after initialization and while the sensor is
+ * stopped.
+ *
+ * :param frames: the interval length in frames
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ *
+ * :See: :c:func:`x4sensor_get_frame_rate`, :c:func:`x4sensor_start_event_mode`
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_set_periodic_report_interval(uint16_t frames);
+
+/**
+ * :brief: Gets the interval length of periodic sensor reports
+ *
+ * This function gets the interval length of periodic sensor reports.
+ *
+ * This function may be called while the sensor is running.
+ *
+ * :return: interval length in frames
+ *
+ * :See: :c:func:`x4sensor_set_periodic_report_interval`,
+ *       :c:func:`x4sensor_start_event_mode`
+ */
+X4_SYMBOL_EXPORT uint16_t x4sensor_get_periodic_report_interval();
+
+/**
+ * :brief: Prepares the stopped sensor for a fast start
+ *
+ * This function uploads the firmware of the selected configuration and
+ * measures the low power oscillator unless its correction is known, the two
+ * slow steps of every start. The sensor stays powered and idle with the
+ * firmware loaded, so the next start only writes the configuration. Call it
+ * while the host is busy otherwise, e.g. at boot, to take the steps off the
+ * time to the first frame.
+ *
+ * The firmware is discarded when the sensor is stopped, re-initialized or a
+ * different configuration is selected. Call :c:func:`x4sensor_stop` to power
+ * a prepared sensor down without starting it. On failure the sensor is
+ * disabled like after a failed start.
+ *
+ * This function may only be called while the sensor is stopped.
+ *
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ *
+ * :See: :c:func:`x4sensor_is_prepared`
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_prepare();
+
+/**
+ * :brief: Tells whether the stopped sensor holds the firmware
+ *
+ * :return: true after :c:func:`x4sensor_prepare` until the firmware is
+ *          discarded, false otherwise
+ */
+X4_SYMBOL_EXPORT bool x4sensor_is_prepared();
+
+/**
+ * :brief: Starts the hardware sensor in normal operation mode
+ *
+ * This function starts the sensor in normal operation mode and returns. The
+ * hardware sensor runs autonomously and reports detections by asserting an IO
+ * pin. Operation can be stopped using :c:func:`x4sensor_stop`.
+ *
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_start_normal_mode();
+
+/**
+ * :brief: Starts the hardware sensor in event mode
+ *
+ * This function starts the sensor in event mode and returns. Several events
+ * may be subscribed by specifying a combination of event flags.
+ *
+ * When a subscribed event occurs, the hardware sensor reports it by asserting
+ * the interrupt line. The frame data must then be read out using
+ * :c:func:`x4sensor_get_sensor_data` before the sensor is ready to acquire the
+ * next frame. The time between interrupt and reading out the frame data must
+ * be kept as short as possible.
+ *
+ * The implementation of interrupt handling is left to the integrator. It is
+ * for instance possible to use the :c:func:`chipinterface_wait_for_interrupt`
+ * function in chipinterface.
+ *
+ * :param events: a combination of event flags
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_start_event_mode(x4sensor_event_flags_t events);
+
+/**
+ * :brief: Starts the hardware sensor in recording mode
+ *
+ * This function starts the sensor in recording mode and returns. The hardware
+ * sensor reports each frame by asserting the interrupt line. The frame data
+ * must then be read out using :c:func:`x4sensor_get_sensor_data` before the
+ * sensor acquires the next frame. The time between interrupt and reading out
+ * the frame data must be kept as short as possible.
+ *
+ * The implementation of interrupt handling is left to the integrator. It is
+ * for instance possible to use the :c:func:`chipinterface_wait_for_interrupt`
+ * function in chipinterface.
+ *
+ * Before starting, the per-frame host budget is checked as configured with
+ * :c:func:`x4sensor_set_recording_budget_policy`. When frames are decimated,
+ * :c:func:`x4sensor_get_periodic_report_interval` returns the interval in use.
+ *
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_start_recording_mode();
+
+/**
+ * :brief: Computes the per-frame host budget of a recording configuration
+ *
+ * This function models the bus transactions and command waits of one
+ * recording mode frame read for the given configuration and compares the
+ * resulting host time to the frame period. It does not access the sensor and
+ * may be called at any time, also on a PC.
+ *
+ * :param setup: the recording configuration
+ * :param budget: receives the budget
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ *
+ * :See: :c:func:`x4sensor_get_recording_budget`
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_plan_recording(const x4sensor_recording_setup_t *setup, x4sensor_recording_budget_t *budget);
+
+/**
+ * :brief: Computes the per-frame host budget of recording mode
+ *
+ * This function evaluates :c:func:`x4sensor_plan_recording` for the loaded
+ * configuration, the initialized interface and the host timing set with
+ * :c:func:`x4sensor_set_recording_host_timing`.
+ *
+ * This function may be called after initialization.
+ *
+ * :param budget: receives the budget
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_get_recording_budget(x4sensor_recording_budget_t *budget);
+
+/**
+ * :brief: Estimates the average current of a board over a period
+ *
+ * Adds up the charge of the board floor, the enabled sensor and its radar
+ * frames, the firmware uploads, the bus transfers, the CPU and the radio over
+ * the period and divides it by its length. The bus time follows from the
+ * bytes, the transactions and the bus clock. If the CPU running time is not
+ * measured, the CPU is assumed to run while the bus is busy. If the wake-ups
+ * are not counted, every data read, connection event and advertising event is
+ * assumed to wake the CPU once. The function does not access the sensor and
+ * may be called at any time, also on a PC to compare configurations.
+ *
+ * :param coefficients: calibration of the board
+ * :param activity: activity of the board
+ * :param estimate: receives the estimate
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_estimate_energy(const x4sensor_energy_coefficients_t *coefficients,
+                                                           const x4sensor_energy_activity_t *activity,
+                                                           x4sensor_energy_estimate_t *estimate);
+
+/**
+ * :brief: Sets the host side timing used for the recording budget
+ *
+ * The default assumes a wait resolution of 1 ms, no transaction overhead, no
+ * host processing and serial reads.
+ *
+ * This function may be called at any time.
+ *
+ * :param timing: the host timing
+ * :param bus_frequency_hz: the actual bus clock in Hz or 0 for the clock
+ *                          requested by the library
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_set_recording_host_timing(const x4sensor_host_timing_t *timing, uint32_t bus_frequency_hz);
+
+/**
+ * :brief: Sets the action taken when recording mode exceeds the budget
+ *
+ * :c:func:`x4sensor_start_recording_mode` checks the budget returned by
+ * :c:func:`x4sensor_get_recording_budget` and either refuses to start or
+ * raises the periodic report interval so that only every Nth frame is read.
+ * The default is :c:member:`x4sensor_budget_policy_t.X4SENSOR_BUDGET_POLICY_REFUSE`.
+ *
+ * This function may be called at any time.
+ *
+ * :param policy: the budget policy
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_set_recording_budget_policy(x4sensor_budget_policy_t policy);
+
+/**
+ * :brief: Stops the current sensor operation
+ *
+ * This function stops the sensor and brings it into a power-down state. After
+ * calling this function, the sensor may be reconfigured and can be started
+ * again. A prepared sensor is powered down the same way.
+ *
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_stop();
+
+/**
+ * :brief: Returns the maximum buffer size needed for the frame in recording mode
+ *
+ * This function returns the estimated maximum buffer size needed for the call
+ * of :c:func:`x4sensor_get_sensor_data` so that the application can
+ * preallocate sufficient space. The utilized size may be less than that.
+ *
+ * :return: the maximum sensor data buffer size.
+ */
+X4_SYMBOL_EXPORT size_t x4sensor_get_max_sensor_data_size_recording_mode();
+
+/**
+ * :brief: Returns the maximum buffer size needed for the frame in event mode
+ *
+ * This function returns the estimated maximum buffer size needed for the call
+ * of :c:func:`x4sensor_get_sensor_data` so that the application can
+ * preallocate sufficient space. The utilized size may be less than that.
+ *
+ * :return: the maximum sensor data buffer size.
+ */
+X4_SYMBOL_EXPORT size_t x4sensor_get_max_sensor_data_size_event_mode();
+
+/**
+ * :brief: Reads out frame data and prepares the next sensor interval
+ *
+ * This function reads out frame data and prepares the next sensor interval.
+ * The frame data contains presence information and can be queried with
+ * :c:func:`x4sensor_get_detection`.
+ *
+ * Call this function after obtaining an interrupt in event mode or in
+ * recording mode. Do not call it in normal operation mode.
+ *
+ * Make sure to preallocate enough space in :c:var:`buffer`. In event mode, the
+ * maximum buffer size can be predicted with
+ * :c:func:`x4sensor_get_max_sensor_data_size_event_mode` or in recording mode
+ * with :c:func:`x4sensor_get_max_sensor_data_size_recording`, respectively.
+ *
+ * :param buffer: a pointer to the destination memory
+ * :param max_size: the maximum size of :c:var:`buffer`
+ * :return: the number of bytes written to :c:var:`buffer`
+ */
+X4_SYMBOL_EXPORT size_t x4sensor_get_sensor_data(uint8_t *buffer, size_t max_size);
+
+/**
+ * :brief: Starts reading out frame data without waiting for the radar data
+ *
+ * This function is the pipelined variant of :c:func:`x4sensor_get_sensor_data`.
+ * It reads the payload of the current frame and, in recording mode, starts
+ * the radar data transfer in the background if the interface supports it.
+ * The host may process the previous frame meanwhile and must then call
+ * :c:func:`x4sensor_finish_sensor_data_read` before touching :c:var:`buffer`
+ * or starting the next read. Using two buffers in turn, the transfer of frame
+ * N+1 overlaps the processing of frame N.
+ *
+ * Interfaces without background transfers read the complete frame in this
+ * function.
+ *
+ * :param buffer: a pointer to the destination memory
+ * :param max_size: the maximum size of :c:var:`buffer`
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ *
+ * :See: :c:func:`x4sensor_get_sensor_data`
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_start_sensor_data_read(uint8_t *buffer, size_t max_size);
+
+/**
+ * :brief: Completes a read started by x4sensor_start_sensor_data_read
+ *
+ * This function waits for the background transfer to complete and prepares
+ * the next sensor interval.
+ *
+ * :return: the number of bytes written to the buffer passed to
+ *          :c:func:`x4sensor_start_sensor_data_read`, 0 on error
+ */
+X4_SYMBOL_EXPORT size_t x4sensor_finish_sensor_data_read();
+
+/**
+ * :brief: Returns the error code of the last function call
+ *
+ * Most X4Sensor functions return an error code of type
+ * :c:type:`x4sensor_error_t`. Some functions return other values for
+ * convenience but may still produce an error. This function allows the user to
+ * retrieve the error that happened in the last function call regardless of
+ * which function was called.
+ *
+ * :return: the error code of the last function call
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_get_last_error();
+
+/**
+ * :brief: Converts an \a error code into a human-readable string
+ *
+ * This function converts a x4sensor_error_t error code into a human-readable
+ * C string. It is a convenience function that should be used with care.
+ * Calling it will have a significant impact on the code size and is only
+ * recommended if code size is not top priority.
+ *
+ * :param: error the error code
+ * :return: a C string with more information about the error
+ */
+X4_SYMBOL_EXPORT const char* x4sensor_convert_error_to_string(x4sensor_error_t error);
+
+/**
+ * :brief: Starts the hardware sensor in regulatory test mode
+ *
+ * This function starts the sensor in test mode and returns. In case of
+ * :c:member:`x4_test_mode_t.X4_TEST_MODE_M1` and
+ * :c:member:`x4_test_mode_t.X4_TEST_MODE_M2` mode the hardware sensor emits
+ * continuously and no further action is needed. In other test modes sensor
+ * behaves like in recording mode (see
+ * :c:func:`x4sensor_start_recording_mode`). :c:func:`x4sensor_stop` has to be
+ * called before starting another test mode.
+ *
+ * :param test_mode: a test mode index
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_start_test_mode(x4_test_mode_t test_mode);
+
+/**
+ * :brief: Extracts event flags from the frame data buffer
+ *
+ * This function returns the event flags that caused the sensor to report data.
+ * Events are subscribed to by :c:func:`x4sensor_start_event_mode`.
+ *
+ * :param buffer: data fetched by :c:func:`x4sensor_get_sensor_data`
+ * :return: the flags that caused the sensor to report data
+ */
+X4_SYMBOL_EXPORT x4sensor_event_flags_t x4sensor_get_events(const uint8_t *buffer);
+
+/**
+ * :brief: Extracts frame counter from the frame data buffer
+ *
+ * This function returns the frame counter from the data buffer.
+ * The frame counter is incremented for each processed frame.
+ *
+ * :param buffer: data fetched by :c:func:`x4sensor_get_sensor_data`
+ * :return: value of the frame counter
+ */
+X4_SYMBOL_EXPORT uint32_t x4sensor_get_frame_counter(const uint8_t *buffer);
+
+/**
+ * :brief: Extracts the detection state from a sensor data buffer
+ *
+ * :param buffer: data fetched by :c:func:`x4sensor_get_sensor_data`
+ * :return: true in case of proximity or occupancy depending on the algorithm,
+ *          otherwise false
+ */
+X4_SYMBOL_EXPORT bool x4sensor_get_detection_state(const uint8_t *buffer);
+
+/**
+ * :brief: Extracts distance cluster data from sensor data buffer
+ *
+ * :param buffer: data fetched by :c:func:`x4sensor_get_sensor_data`
+ * :param distance_cluster: pointer to where the cluster data is written to
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_get_distance_cluster(const uint8_t *buffer, x4sensor_distance_cluster_t* distance_cluster);
+
+/**
+ * :brief: Returns the number of range bins in a distance cluster
+ *
+ * The number of range bins is fixed and cannot be changed.
+ *
+ * :return: number of range bins in a distance cluster
+ */
+X4_SYMBOL_EXPORT uint8_t x4sensor_get_distance_cluster_length();
+
+/**
+ * :brief: Returns the number of the first bin in a distance cluster
+ *
+ * :param buffer: data fetched by :c:func:`x4sensor_get_sensor_data`
+ * :return: bin index to the first bin in a distance cluster
+ */
+X4_SYMBOL_EXPORT uint8_t x4sensor_get_distance_cluster_first_bin_number(const uint8_t *buffer);
+
+/**
+ * :brief: Returns the distance between adjacent range bins in mm
+ *
+ * The X4Sensor radar divides the detection zone into range bins with a certain
+ * length. This length is fixed and cannot be changed.
+ *
+ * :return: The distance between adjacent range bins in mm
+ */
+X4_SYMBOL_EXPORT uint16_t x4sensor_get_distance_between_bins_mm();
+
+/**
+ * :brief: Returns the detector range bins within a distance interval
+ *
+ * This function maps a distance interval to detector range bins once, so that
+ * frames can be tested against it with
+ * :c:func:`x4sensor_get_detection_bin_mask` at the cost of a single AND. Bit n
+ * of :c:var:`mask` is set if the distance of detector range bin n lies within
+ * [:c:var:`from_cm`, :c:var:`to_cm`). The mapping depends on the selected
+ * configuration.
+ *
+ * This function may be called after initialization.
+ *
+ * :param from_cm: start of the interval in cm
+ * :param to_cm: end of the interval in cm, exclusive
+ * :param mask: receives the bin mask, 0 if no bin lies within the interval
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_get_range_bin_mask(uint16_t from_cm, uint16_t to_cm, uint32_t *mask);
+
+/**
+ * :brief: Returns the detector range bins above the threshold in a frame
+ *
+ * Bit n of the result is set if detector range bin n of the distance cluster
+ * is above its detection threshold. Only bins covered by the distance cluster
+ * are reported, bins further than
+ * :c:func:`x4sensor_get_distance_cluster_length` bins from the first hit are
+ * not known to the host.
+ *
+ * :param buffer: data fetched by :c:func:`x4sensor_get_sensor_data`
+ * :return: the detection bin mask, 0 if the detector had no hit
+ */
+X4_SYMBOL_EXPORT uint32_t x4sensor_get_detection_bin_mask(const uint8_t *buffer);
+
+/**
+ * :brief: Decodes a batch of frames into column arrays
+ *
+ * This function decodes :c:var:`count` frames stored back to back in
+ * :c:var:`buffer` into the arrays of :c:var:`columns`. It is equivalent to
+ * calling :c:func:`x4sensor_get_frame_counter`,
+ * :c:func:`x4sensor_get_detection_state`,
+ * :c:func:`x4sensor_get_distance_cluster_first_bin_number` and
+ * :c:func:`x4sensor_get_distance_cluster` for every frame, but much faster for
+ * large batches. It does not need an initialized sensor and may be used
+ * offline on recorded data.
+ *
+ * :param buffer: frames fetched by :c:func:`x4sensor_get_sensor_data`
+ * :param stride: distance between two frames in bytes, at least
+ *                :c:func:`x4sensor_get_max_sensor_data_size_event_mode`
+ * :param count: number of frames
+ * :param cluster_length: number of distance cluster bins to decode, usually
+ *                        :c:func:`x4sensor_get_distance_cluster_length`
+ * :param columns: the destination arrays
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_decode_payloads(const uint8_t *buffer, size_t stride, size_t count, uint8_t cluster_length, const x4sensor_payload_columns_t *columns);
+
+/**
+ * :brief: Prepares a background calibration
+ *
+ * A background calibration derives detector thresholds from recording mode
+ * frames of the empty scene. For every detector range bin, the radar samples
+ * are decimated, the static background is removed and the mean and variance
+ * of the remaining power are accumulated. The threshold of a bin is the mean
+ * power plus :c:member:`x4sensor_calibration_setup_t.sigma_q4` standard
+ * deviations, scaled by :c:member:`x4sensor_calibration_setup_t.margin_percent`.
+ *
+ * Decimation averages adjacent range bins and the background follows the
+ * running mean, both approximate the processing of the X4 firmware.
+ * :c:member:`x4sensor_calibration_setup_t.power_shift` converts to the units
+ * of the detector thresholds.
+ *
+ * This function does not access the sensor and may be called at any time,
+ * also on a PC. :c:func:`x4sensor_begin_calibration` takes the bin counts from
+ * the loaded configuration.
+ *
+ * :param calibration: the calibration state
+ * :param setup: the calibration parameters
+ * :param radar_bins: number of range bins in the recorded radar data
+ * :param detector_bins: number of detector range bins, a divisor of
+ *                       :c:var:`radar_bins`
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_calibration_init(x4sensor_calibration_t *calibration, const x4sensor_calibration_setup_t *setup, uint8_t radar_bins, uint8_t detector_bins);
+
+/**
+ * :brief: Prepares a background calibration for the loaded configuration
+ *
+ * This function may be called after initialization. Frames are then read in
+ * recording mode and passed to :c:func:`x4sensor_calibration_add_frame`.
+ *
+ * :param calibration: the calibration state
+ * :param setup: the calibration parameters
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_begin_calibration(x4sensor_calibration_t *calibration, const x4sensor_calibration_setup_t *setup);
+
+/**
+ * :brief: Accumulates one recording mode frame
+ *
+ * Frames beyond :c:member:`x4sensor_calibration_setup_t.frames` are ignored.
+ *
+ * :param calibration: the calibration state
+ * :param buffer: a frame fetched by :c:func:`x4sensor_get_sensor_data` in
+ *                recording mode
+ * :param size: the size of the frame in bytes
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_calibration_add_frame(x4sensor_calibration_t *calibration, const uint8_t *buffer, size_t size);
+
+/**
+ * :brief: Returns true once all calibration frames are accumulated
+ *
+ * :param calibration: the calibration state
+ * :return: true if the calibration is complete
+ */
+X4_SYMBOL_EXPORT bool x4sensor_calibration_is_complete(const x4sensor_calibration_t *calibration);
+
+/**
+ * :brief: Computes the detector thresholds of a calibration
+ *
+ * This function fills the thresholds and the threshold count of
+ * :c:var:`detector` and leaves the M-of-N values untouched. Obtain the active
+ * values with :c:func:`x4sensor_get_detector_config` first and apply the
+ * result with :c:func:`x4sensor_set_detector_config`.
+ *
+ * :param calibration: the calibration state
+ * :param detector: receives the thresholds
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_calibration_get_thresholds(const x4sensor_calibration_t *calibration, x4sensor_detector_config_t *detector);
+
+/**
+ * :brief: Prepares a target tracker
+ *
+ * The tracker follows the nearest target with an alpha-beta filter on the
+ * distance. The measurement of a frame is
+ * :c:member:`x4sensor_distance_cluster_t.first_detection_bin_distance_mm`
+ * corrected by the power centroid of the distance cluster, which resolves
+ * movements below the bin spacing. The filtered radial velocity classifies
+ * the target as approaching or leaving once it exceeds
+ * :c:member:`x4sensor_tracker_setup_t.speed_mm_s`, and as neither once it
+ * falls below half of it.
+ *
+ * This function does not access the sensor and may be called at any time,
+ * also on a PC. :c:func:`x4sensor_begin_tracking` takes the frame rate and bin
+ * spacing from the loaded configuration.
+ *
+ * :param tracker: the tracker state
+ * :param setup: the tracker parameters
+ * :param frame_rate: frame rate in frames per second
+ * :param bin_spacing_mm: distance between detector range bins, see
+ *                        :c:func:`x4sensor_get_distance_between_bins_mm`
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_tracker_init(x4sensor_tracker_t *tracker, const x4sensor_tracker_setup_t *setup, uint8_t frame_rate, uint16_t bin_spacing_mm);
+
+/**
+ * :brief: Prepares a target tracker for the loaded configuration
+ *
+ * This function may be called after initialization.
+ *
+ * :param tracker: the tracker state
+ * :param setup: the tracker parameters
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_begin_tracking(x4sensor_tracker_t *tracker, const x4sensor_tracker_setup_t *setup);
+
+/**
+ * :brief: Advances a target tracker by one frame
+ *
+ * Frames may be skipped, the prediction uses the difference of the frame
+ * counters. The cost per frame is constant, one pass over the distance cluster
+ * and a fixed number of multiplications and divisions.
+ *
+ * :param tracker: the tracker state
+ * :param cluster: the distance cluster of the frame, see
+ *                 :c:func:`x4sensor_get_distance_cluster`
+ * :param frame_counter: the frame counter of the frame, see
+ *                       :c:func:`x4sensor_get_frame_counter`
+ * :param track: receives the estimates after this frame
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_tracker_update(x4sensor_tracker_t *tracker, const x4sensor_distance_cluster_t *cluster, uint32_t frame_counter, x4sensor_track_t *track);
+
+/**
+ * :brief: Configures a presence state machine
+ *
+ * The state machine turns the detection state of each frame into a presence
+ * state with separate enter and exit hysteresis. Presence is reported once
+ * the detection lasted :c:member:`x4sensor_presence_setup_t.enter_frames` and
+ * :c:member:`x4sensor_presence_setup_t.enter_ms`, and ends once it was lost
+ * for :c:member:`x4sensor_presence_setup_t.exit_frames` and
+ * :c:member:`x4sensor_presence_setup_t.exit_ms`. A frame with the opposite
+ * detection state cancels a pending transition.
+ *
+ * The current state is kept, so the parameters may be changed at any time.
+ * This function does not access the sensor and may be called at any time,
+ * also on a PC.
+ *
+ * :param presence: the state machine
+ * :param setup: the hysteresis parameters
+ * :param frame_rate: frame rate in frames per second, see
+ *                    :c:func:`x4sensor_get_frame_rate`
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_presence_configure(x4sensor_presence_t *presence, const x4sensor_presence_setup_t *setup, uint8_t frame_rate);
+
+/**
+ * :brief: Resets a presence state machine to absent
+ *
+ * :param presence: the state machine
+ */
+X4_SYMBOL_EXPORT void x4sensor_presence_reset(x4sensor_presence_t *presence);
+
+/**
+ * :brief: Advances a presence state machine
+ *
+ * Called with the detection state of every frame. Frames may be skipped, for
+ * instance when the sensor only reports state changes. The state machine is
+ * then advanced again with the last detection state and the current time
+ * once :c:func:`x4sensor_presence_get_remaining_us` has passed, with the frame
+ * counter extrapolated from the frame rate. A frame counter that goes back,
+ * after a restart of the sensor, restarts the frame count of a pending
+ * transition.
+ *
+ * :param presence: the state machine
+ * :param detected: detection state of the frame, see
+ *                  :c:func:`x4sensor_get_detection_state`
+ * :param frame_counter: the frame counter of the frame, see
+ *                       :c:func:`x4sensor_get_frame_counter`
+ * :param time_us: time of the frame in microseconds, may wrap from 2^32 - 1 to 0
+ * :return: :c:var:`X4SENSOR_SUCCESS` on success, otherwise an error code
+ */
+X4_SYMBOL_EXPORT x4sensor_error_t x4sensor_presence_update(x4sensor_presence_t *presence, bool detected, uint32_t frame_counter, uint32_t time_us);
+
+/**
+ * :brief: Returns the state of a presence state machine
+ *
+ * :param presence: the state machine
+ * :return: the state
+ */
+X4_SYMBOL_EXPORT x4sensor_presence_state_t x4sensor_presence_get_state(const x4sensor_presence_t *presence);
+
+/**
+ * :brief: Returns true while presence is reported
+ *
+ * :param presence: the state machine
+ * :return: true if the state is present or exiting
+ */
+X4_SYMBOL_EXPORT bool x4sensor_presence_is_present(const x4sensor_presence_t *presence);
+
+/**
+ * :brief: Returns the time until a pending transition may complete
+ *
+ * :param presence: the state machine
+ * :param time_us: current time in microseconds
+ * :return: the remaining time in microseconds, 0 if the transition is due,
+ *          UINT32_MAX if no transition is pending
+ */
+X4_SYMBOL_EXPORT uint32_t x4sensor_presence_get_remaining_us(const x4sensor_presence_t *presence, uint32_t time_us);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NOVELDA_X4CONTROLLER_H
+
@@ -29,6 +29,7 @@ extern "C"
 	X4SENSOR_CHECK(condition, x4_stat = error_code; return x4_stat)
 
 typedef x4sensor_error_t (*read_recording_data_func)(uint8_t *buffer, size_t max_size, size_t* bytes_read);
+typedef x4sensor_error_t (*finish_read_recording_data_func)(void);
 typedef x4sensor_error_t (*set_run_mode_func)(x4_run_mode_t mode, x4sensor_event_flags_t events);
 typedef x4sensor_error_t (*get_register_func)(uint16_t addres, uint8_t *value);
 typedef x4sensor_error_t (*set_register_func)(uint16_t addres, uint8_t value);
@@ -50,6 +51,8 @@ typedef struct {
 	set_register_func set_register;
 	write_config_func write_config;
 	read_recording_data_func read_recording_data;
+	read_recording_data_func start_read_recording_data; // optional, NULL if not supported
+	finish_read_recording_data_func finish_read_recording_data; // optional, NULL if not supported
 	destroy_chipinterface_func destroy_chipinterface;
 	start_lposc_measurement_func start_lposc_measurement;
 	clear_interrupt_func clear_interrupt;
@@ -80,6 +83,12 @@ X4_PACK_END();
 extern const x4sensor_vtable_t x4sensor_vtable_i2c;
 extern const x4sensor_vtable_t x4sensor_vtable_spi;
 
+// Returns the vtable to use for an interface, a copy that counts the operations
+// and reports them to the trace hook
+const x4sensor_vtable_t *x4sensor_trace_vtable(const x4sensor_vtable_t *vtable);
+// Fills the operation counters of the driver statistics
+void x4sensor_trace_get_counts(x4sensor_driver_stats_t *stats);
+
 X4_SYMBOL_EXPORT const x4sensor_configuration_t *x4sensor_get_configuration();
 X4_SYMBOL_EXPORT bool x4sensor_is_recording();
 X4_SYMBOL_EXPORT uint8_t x4sensor_get_number_of_radar_bins();
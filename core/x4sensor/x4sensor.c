@@ -15,6 +15,7 @@
 #define I2C_FREQUENCY 400000
 #define SPI_FREQUENCY (32000000/1)
 #define DEFAULT_COMM_RETRY 5
+#define DEFAULT_WAIT_RESOLUTION_US 1000
 
 #define NVA_MIN(i, j) (((i) < (j)) ? (i) : (j))
 #define NVA_MAX(i, j) (((i) > (j)) ? (i) : (j))
@@ -39,6 +40,8 @@ static x4_run_mode_t run_mode;
 static x4_runstage_t run_stage;
 static const x4sensor_vtable_t *vtable;
 static uint32_t lposc_correction_factor_1000;
+static uint8_t frame_rate_divider = 1;
+static bool firmware_loaded;
 static x4sensor_error_t x4_stat;
 static const int16_t *range_lut;
 static uint8_t range_bins;
@@ -49,6 +52,18 @@ static const uint8_t *M_values;
 static const uint8_t *N_values;
 static const uint16_t *Range_cm;
 static bool is_recording;
+static bool is_read_pending;
+static size_t pending_bytes_read;
+static x4sensor_bus_t bus;
+static bool interface_created;
+static uint32_t bus_frequency_hz;
+static uint32_t host_bus_frequency_hz;
+static x4sensor_host_timing_t host_timing = {
+    .wait_resolution_us = DEFAULT_WAIT_RESOLUTION_US
+};
+static x4sensor_budget_policy_t budget_policy = X4SENSOR_BUDGET_POLICY_REFUSE;
+
+X4_STATIC_ASSERT(X4SENSOR_MAX_RANGE_BINS == X4_MAX_RANGE_BINS, public_range_bin_limit_must_match_interface);
 
 x4sensor_error_t x4sensor_set_retry_count(uint8_t retry_count){
     comm_retry = retry_count;
@@ -68,11 +83,14 @@ static x4sensor_error_t
 disable_x4()
 {
     run_stage = X4_RUN_STAGE_DISABLED;
+    firmware_loaded = false;
     chipinterface_error_t chip_stat = chipinterface_set_chip_enabled(false);
     X4SENSOR_CHECK_OR_RETURN(chip_stat == CHIPINTERFACE_SUCCESS, X4SENSOR_CHIPINTERFACE_ERROR);
     return X4SENSOR_SUCCESS;
 }
 
+#define LPOSC_MAX_MARGIN_1000 350 // = (30+5)% * 1000
+
 //
 // The lposc on the X4 might be up to +- 30% off. We let the X4 run
 // for a certain amount of ticks and measure the actual time that
@@ -93,7 +111,6 @@ measure_lposc()
                                                   // the whole procedure takes longer.
     const int32_t time_per_tick_us = 29127;
     const int32_t expected_time_us = time_per_tick_us * calibration_duration_ticks;
-    const uint32_t max_margin_1000 = 350; // = (30+5)% * 1000
     const uint32_t max_measurement_time_us = 250000;
 
     for (attempts_left = 3; attempts_left > 0; --attempts_left) {
@@ -111,9 +128,9 @@ measure_lposc()
         lposc_correction_factor_1000 = 1000u - ((actual_time_us - expected_time_us) * 1000 / expected_time_us);
 
         // Check resulting factor for plausibility
-        if (lposc_correction_factor_1000 < 1000 - max_margin_1000)
+        if (lposc_correction_factor_1000 < 1000 - LPOSC_MAX_MARGIN_1000)
             continue;
-        if (lposc_correction_factor_1000 > 1000 + max_margin_1000)
+        if (lposc_correction_factor_1000 > 1000 + LPOSC_MAX_MARGIN_1000)
             continue;
         // Next attempt if necessary
         break;
@@ -129,8 +146,47 @@ measure_lposc()
     return X4SENSOR_SUCCESS;
 }
 
+//
+// Parse results of a configuration blob. Blobs are parsed once when they are
+// added and switching between them only copies the cached values.
+//
+typedef struct {
+    const uint8_t *blob;
+    const x4sensor_configuration_t *config;
+    const int16_t *range_lut;
+    const uint16_t *threshold_vectors;
+    const uint8_t *sensitivity_levels_indexes;
+    const uint8_t *M_values;
+    const uint8_t *N_values;
+    const uint16_t *Range_cm;
+    const uint8_t *firmware_data;
+    size_t firmware_size;
+    uint32_t algorithm_variant_hash;
+    uint32_t firmware_version;
+    uint32_t algorithm_commit_hash;
+    uint8_t algorithm_version[3];
+    uint8_t range_bins;
+    uint8_t sensitivity_levels;
+    uint8_t firmware_hash;
+} parsed_configuration_t;
+
+static parsed_configuration_t configurations[X4SENSOR_MAX_CONFIGURATIONS];
+static uint8_t configuration_count;
+static uint8_t configuration_index;
+static uint8_t firmware_hash;
+
+static uint8_t
+make_firmware_hash(const uint8_t *data, size_t size)
+{
+    uint8_t val = 0;
+    for (size_t i = 0; i < size; ++i) {
+        val = (val ^ data[i]) + 47;
+    }
+    return val;
+}
+
 static x4sensor_error_t
-parse_config_blob(const uint8_t *buffer, size_t nbytes)
+parse_config_blob(const uint8_t *buffer, size_t nbytes, parsed_configuration_t *parsed)
 {
     const x4sensor_blob_header_t* header = (const x4sensor_blob_header_t*)buffer;
 
@@ -145,45 +201,107 @@ parse_config_blob(const uint8_t *buffer, size_t nbytes)
     if (header->configuration_format_hash != CONFIGURATION_FORMAT_HASH)
         return X4SENSOR_CONFIGURATION_INVALID_LAYOUT;
 
-    info.algorithm_variant_hash = header->algorithm_variant_hash;
-    info.firmware_version = header->firmware_commit_hash;
+    memset(parsed, 0, sizeof(*parsed));
+    parsed->blob = buffer;
+    parsed->algorithm_variant_hash = header->algorithm_variant_hash;
+    parsed->firmware_version = header->firmware_commit_hash;
     if (header->header_version == 1) {
-        info.algorithm_commit_hash = header->algorithm_commit_hash;
+        parsed->algorithm_commit_hash = header->algorithm_commit_hash;
     } else if (header->header_version == 2) {
-        info.algorithm_version[0] = header->algorithm_version[0];
-        info.algorithm_version[1] = header->algorithm_version[1];
-        info.algorithm_version[2] = header->algorithm_version[2];
+        parsed->algorithm_version[0] = header->algorithm_version[0];
+        parsed->algorithm_version[1] = header->algorithm_version[1];
+        parsed->algorithm_version[2] = header->algorithm_version[2];
     }
     const uint8_t* data = buffer + sizeof(x4sensor_blob_header_t);
     const uint16_t initial_offset = *(const uint16_t*)data;
-    config = (const x4sensor_configuration_t*)(&data[initial_offset]);
-
-    range_bins = config->FrameConfig_RangeBins / config->range_decimation_DecimFactor;
-    range_lut = (const int16_t*)(&data[config->detector_RangeLookUpTable.offset]);
-    threshold_vectors = (const uint16_t*)(&data[config->detector_DetectorThresholds.offset]);
-    M_values = (const uint8_t*)(&data[config->app_logic_M.offset]);
-    N_values = (const uint8_t*)(&data[config->app_logic_N.offset]);
-    sensitivity_levels = config->detector_DetectorThresholds.length / range_bins;
-    sensitivity_levels_indexes = (const uint8_t*)(&data[config->PublicParameters_SensitivityLevel.offset]);
-    Range_cm = (const uint16_t*)(&data[config->PublicParameters_Range_cm.offset]);
-    firmware_data = &data[config->firmware.offset];
-    firmware_size = config->firmware.length;
+    const x4sensor_configuration_t *blob_config = (const x4sensor_configuration_t*)(&data[initial_offset]);
+
+    parsed->config = blob_config;
+    if (blob_config->range_decimation_DecimFactor == 0)
+        return X4SENSOR_FAILURE;
+    parsed->range_bins = blob_config->FrameConfig_RangeBins / blob_config->range_decimation_DecimFactor;
+    if (parsed->range_bins > X4_MAX_RANGE_BINS)
+        return X4SENSOR_CONFIGURATION_INVALID_DATA;
+    // every sensitivity level holds one threshold per range bin
+    if (parsed->range_bins == 0 ||
+        blob_config->detector_DetectorThresholds.length % parsed->range_bins != 0)
+        return X4SENSOR_FAILURE;
+    parsed->range_lut = (const int16_t*)(&data[blob_config->detector_RangeLookUpTable.offset]);
+    parsed->threshold_vectors = (const uint16_t*)(&data[blob_config->detector_DetectorThresholds.offset]);
+    parsed->M_values = (const uint8_t*)(&data[blob_config->app_logic_M.offset]);
+    parsed->N_values = (const uint8_t*)(&data[blob_config->app_logic_N.offset]);
+    parsed->sensitivity_levels = blob_config->detector_DetectorThresholds.length / parsed->range_bins;
+    parsed->sensitivity_levels_indexes = (const uint8_t*)(&data[blob_config->PublicParameters_SensitivityLevel.offset]);
+    parsed->Range_cm = (const uint16_t*)(&data[blob_config->PublicParameters_Range_cm.offset]);
+    parsed->firmware_data = &data[blob_config->firmware.offset];
+    parsed->firmware_size = blob_config->firmware.length;
+    parsed->firmware_hash = make_firmware_hash(parsed->firmware_data, parsed->firmware_size);
 
     return X4SENSOR_SUCCESS;
 }
 
+static void
+apply_configuration(const parsed_configuration_t *parsed)
+{
+    info.algorithm_variant_hash = parsed->algorithm_variant_hash;
+    info.firmware_version = parsed->firmware_version;
+    info.algorithm_commit_hash = parsed->algorithm_commit_hash;
+    memcpy(info.algorithm_version, parsed->algorithm_version, sizeof(info.algorithm_version));
+
+    config = parsed->config;
+    range_bins = parsed->range_bins;
+    range_lut = parsed->range_lut;
+    threshold_vectors = parsed->threshold_vectors;
+    M_values = parsed->M_values;
+    N_values = parsed->N_values;
+    sensitivity_levels = parsed->sensitivity_levels;
+    sensitivity_levels_indexes = parsed->sensitivity_levels_indexes;
+    Range_cm = parsed->Range_cm;
+    firmware_data = parsed->firmware_data;
+    firmware_size = parsed->firmware_size;
+    firmware_hash = parsed->firmware_hash;
+}
+
+//
+// Resets the run-time parameters to the defaults of the active
+// configuration.
+//
 static x4sensor_error_t
-init_common(const uint8_t *configuration_blob, size_t configuration_blob_size)
+apply_configuration_defaults()
+{
+    x4_stat = x4sensor_set_sensitivity_level(config->detector_SensitivityLevel);
+    X4SENSOR_CHECK_OR_RETURN(x4_stat == X4SENSOR_SUCCESS, x4_stat);
+
+    x4_stat = x4sensor_set_range_cm(config->detector_Range_cm);
+    X4SENSOR_CHECK_OR_RETURN(x4_stat == X4SENSOR_SUCCESS, x4_stat);
+
+    // Set default value to 10s
+    x4_stat = x4sensor_set_periodic_report_interval(10 * x4sensor_get_frame_rate());
+    X4SENSOR_CHECK_OR_RETURN(x4_stat == X4SENSOR_SUCCESS, x4_stat);
+
+    frame_rate_divider = 1;
+
+    return X4SENSOR_SUCCESS;
+}
+
+//
+// Brings the sensor from disabled to stopped with the given registered
+// configuration. The chip interface must exist.
+//
+static x4sensor_error_t
+discover_common(uint8_t index)
 {
     run_mode = X4_RUN_MODE_STOP;
     run_stage = X4_RUN_STAGE_DISABLED;
     is_recording = false;
+    is_read_pending = false;
+    firmware_loaded = false;
     lposc_correction_factor_1000 = 0;
     config = NULL;
     memset(&info, 0, sizeof(info));
 
-    x4_stat = parse_config_blob(configuration_blob, configuration_blob_size);
-    X4SENSOR_CHECK_OR_GOTO(x4_stat == X4SENSOR_SUCCESS, end);
+    configuration_index = index;
+    apply_configuration(&configurations[configuration_index]);
 
     x4_stat = vtable->discover_sensor(&info);
 
@@ -196,15 +314,7 @@ init_common(const uint8_t *configuration_blob, size_t configuration_blob_size)
 
     run_stage = X4_RUN_STAGE_STOPPED;
 
-    x4_stat = x4sensor_set_sensitivity_level(config->detector_SensitivityLevel);
-    X4SENSOR_CHECK_OR_GOTO(x4_stat == X4SENSOR_SUCCESS, end);
-
-    x4_stat = x4sensor_set_range_cm(config->detector_Range_cm);
-    X4SENSOR_CHECK_OR_GOTO(x4_stat == X4SENSOR_SUCCESS, end);
-
-    // Set default value to 10s
-    x4_stat = x4sensor_set_periodic_report_interval(10 * x4sensor_get_frame_rate());
-    X4SENSOR_CHECK_OR_GOTO(x4_stat == X4SENSOR_SUCCESS, end);
+    x4_stat = apply_configuration_defaults();
 
 end:
     if (x4_stat != X4SENSOR_SUCCESS)
@@ -212,6 +322,48 @@ end:
     return x4_stat;
 }
 
+static x4sensor_error_t
+init_common(const uint8_t *configuration_blob, size_t configuration_blob_size)
+{
+    uint8_t index;
+
+    run_stage = X4_RUN_STAGE_DISABLED;
+    x4_stat = x4sensor_add_configuration(configuration_blob, configuration_blob_size, &index);
+    X4SENSOR_CHECK_OR_RETURN(x4_stat == X4SENSOR_SUCCESS, x4_stat);
+    return discover_common(index);
+}
+
+//
+// Sweep period in ticks of the X4 low power oscillator for the frame rate of
+// the configuration divided by the frame rate divider. The divider divides the
+// frame rate, the period is at most one second and fits the register.
+//
+static uint16_t
+get_sweep_period()
+{
+    return (uint16_t)(TicksPerSecond * lposc_correction_factor_1000 / config->ChipX4_FPS / 1000 * frame_rate_divider);
+}
+
+//
+// Uploads the firmware of the selected configuration and measures the lposc
+// unless a correction is known. The firmware stays loaded until the chip is
+// disabled, the next start only writes the configuration.
+//
+static x4sensor_error_t
+load_firmware()
+{
+    if (firmware_loaded)
+        return X4SENSOR_SUCCESS;
+    x4_stat = vtable->upload_firmware(firmware_data, firmware_size);
+    X4SENSOR_CHECK_OR_RETURN(x4_stat == X4SENSOR_SUCCESS, x4_stat);
+    if (lposc_correction_factor_1000 == 0) {
+        x4_stat = measure_lposc();
+        X4SENSOR_CHECK_OR_RETURN(x4_stat == X4SENSOR_SUCCESS, x4_stat);
+    }
+    firmware_loaded = true;
+    return X4SENSOR_SUCCESS;
+}
+
 static x4sensor_error_t
 configure_and_start_x4(x4_run_mode_t mode, x4sensor_event_flags_t events)
 {
@@ -221,18 +373,12 @@ configure_and_start_x4(x4_run_mode_t mode, x4sensor_event_flags_t events)
         X4SENSOR_CHECK_OR_RETURN(false, X4SENSOR_NOT_ALLOWED);
         break;
     case X4_RUN_STAGE_STOPPED:
-        x4_stat = vtable->upload_firmware(firmware_data, firmware_size);
+        x4_stat = load_firmware();
         if (x4_stat != X4SENSOR_SUCCESS){
             goto disable_chip;
         }
-        if (lposc_correction_factor_1000 == 0) {
-            x4_stat = measure_lposc();
-            if (x4_stat != X4SENSOR_SUCCESS){
-                goto disable_chip;
-            }
-        }
 
-        algorithm_config.sweep_period = TicksPerSecond * lposc_correction_factor_1000 / config->ChipX4_FPS / 1000;
+        algorithm_config.sweep_period = get_sweep_period();
         for(int attempts = x4sensor_get_retry_count(); attempts > 0; --attempts){
             x4_stat = vtable->write_config(&algorithm_config);
             if(x4_stat == X4SENSOR_SUCCESS){
@@ -258,7 +404,9 @@ x4sensor_initialize_i2c(const uint8_t *configuration_blob, size_t configuration_
 {
     X4SENSOR_CHECK_OR_RETURN(run_stage == X4_RUN_STAGE_DISABLED, X4SENSOR_NOT_ALLOWED);
     chipinterface_error_t chip_stat;
-    vtable = &x4sensor_vtable_i2c;
+    vtable = x4sensor_trace_vtable(&x4sensor_vtable_i2c);
+    bus = X4SENSOR_BUS_I2C;
+    bus_frequency_hz = I2C_FREQUENCY;
     chip_stat = chipinterface_create_i2c(I2C_FREQUENCY, I2C_X4_SLAVE_ADDRESS);
     X4SENSOR_CHECK_OR_RETURN(chip_stat == CHIPINTERFACE_SUCCESS, X4SENSOR_CHIPINTERFACE_ERROR);
 
@@ -266,6 +414,7 @@ x4sensor_initialize_i2c(const uint8_t *configuration_blob, size_t configuration_
     if (x4_stat != X4SENSOR_SUCCESS)
         goto error;
 
+    interface_created = true;
     return X4SENSOR_SUCCESS;
 error:
     chipinterface_delete_i2c();
@@ -277,7 +426,9 @@ x4sensor_initialize_spi(const uint8_t *configuration_blob, size_t configuration_
 {
     X4SENSOR_CHECK_OR_RETURN(run_stage == X4_RUN_STAGE_DISABLED, X4SENSOR_NOT_ALLOWED);
     chipinterface_error_t chip_stat;
-    vtable = &x4sensor_vtable_spi;
+    vtable = x4sensor_trace_vtable(&x4sensor_vtable_spi);
+    bus = X4SENSOR_BUS_SPI;
+    bus_frequency_hz = SPI_FREQUENCY;
     chip_stat = chipinterface_create_spi(SPI_FREQUENCY, &chipinterface_default_x4_spi_config);
     X4SENSOR_CHECK_OR_RETURN(chip_stat == CHIPINTERFACE_SUCCESS, X4SENSOR_CHIPINTERFACE_ERROR);
 
@@ -285,6 +436,7 @@ x4sensor_initialize_spi(const uint8_t *configuration_blob, size_t configuration_
     if (x4_stat != X4SENSOR_SUCCESS)
         goto error;
 
+    interface_created = true;
     return X4SENSOR_SUCCESS;
 error:
     chipinterface_delete_spi();
@@ -297,6 +449,7 @@ x4sensor_deinitialize()
     chipinterface_error_t chip_stat;
 
     firmware_data = NULL;
+    firmware_loaded = false;
 
     switch (run_stage) {
     case X4_RUN_STAGE_RUNNING:
@@ -311,24 +464,102 @@ x4sensor_deinitialize()
         break;
     }
     run_stage = X4_RUN_STAGE_DISABLED;
+    interface_created = false;
 
     return X4SENSOR_SUCCESS;
 error:
     return x4_stat;
 }
 
+x4sensor_error_t
+x4sensor_reinitialize()
+{
+    X4SENSOR_CHECK_OR_RETURN(interface_created, X4SENSOR_NOT_ALLOWED);
+
+    // Power cycle the chip, the firmware is uploaded again by the next start
+    if (run_stage != X4_RUN_STAGE_DISABLED)
+        disable_x4();
+    x4_stat = discover_common(configuration_index);
+    return x4_stat;
+}
+
 const x4sensor_configuration_t *
 x4sensor_get_configuration()
 {
     return config;
 }
 
+x4sensor_error_t
+x4sensor_add_configuration(const uint8_t *configuration_blob, size_t configuration_blob_size, uint8_t *index)
+{
+    X4SENSOR_CHECK_OR_RETURN(configuration_blob != NULL && index != NULL, X4SENSOR_INVALID_PARAMETER);
+
+    // Blobs live in flash, so the same address is the same blob
+    for (uint8_t i = 0; i < configuration_count; i++) {
+        if (configurations[i].blob == configuration_blob) {
+            *index = i;
+            return X4SENSOR_SUCCESS;
+        }
+    }
+    X4SENSOR_CHECK_OR_RETURN(configuration_count < X4SENSOR_MAX_CONFIGURATIONS, X4SENSOR_CONFIGURATION_REGISTRY_FULL);
+
+    x4_stat = parse_config_blob(configuration_blob, configuration_blob_size, &configurations[configuration_count]);
+    X4SENSOR_CHECK_OR_RETURN(x4_stat == X4SENSOR_SUCCESS, x4_stat);
+    *index = configuration_count++;
+    return X4SENSOR_SUCCESS;
+}
+
+x4sensor_error_t
+x4sensor_select_configuration(uint8_t index)
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage == X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+    X4SENSOR_CHECK_OR_RETURN(index < configuration_count, X4SENSOR_INVALID_PARAMETER);
+    if (index == configuration_index)
+        return X4SENSOR_SUCCESS;
+
+    // The lposc correction factor belongs to the chip and is kept. The new
+    // firmware is uploaded by the next start.
+    firmware_loaded = false;
+    configuration_index = index;
+    apply_configuration(&configurations[index]);
+    return apply_configuration_defaults();
+}
+
+uint8_t
+x4sensor_get_configuration_index()
+{
+    return configuration_index;
+}
+
+uint8_t
+x4sensor_get_configuration_count()
+{
+    return configuration_count;
+}
+
 const x4sensor_info_t *
 x4sensor_get_info()
 {
     X4SENSOR_CHECK(run_stage >= X4_RUN_STAGE_STOPPED, x4_stat = X4SENSOR_NOT_ALLOWED; return NULL);
     return &info;
 }
+
+uint32_t
+x4sensor_get_lposc_correction()
+{
+    return lposc_correction_factor_1000;
+}
+
+x4sensor_error_t
+x4sensor_set_lposc_correction(uint32_t factor_1000)
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage == X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+    // Same plausibility range as the measurement
+    X4SENSOR_CHECK_OR_RETURN(factor_1000 >= 1000 - LPOSC_MAX_MARGIN_1000 && factor_1000 <= 1000 + LPOSC_MAX_MARGIN_1000,
+                             X4SENSOR_INVALID_PARAMETER);
+    lposc_correction_factor_1000 = factor_1000;
+    return X4SENSOR_SUCCESS;
+}
 static uint8_t
 x4sensor_cm_to_bin_conv(int16_t range_cm, int16_t length, const int16_t *LUT)
 {
@@ -402,6 +633,70 @@ x4sensor_set_sensitivity_level(uint8_t level)
     return X4SENSOR_SUCCESS;
 }
 
+uint8_t
+x4sensor_get_number_of_detector_bins()
+{
+    X4SENSOR_CHECK(run_stage >= X4_RUN_STAGE_STOPPED, x4_stat = X4SENSOR_NOT_ALLOWED; goto error;);
+    return range_bins;
+error:
+    return 0;
+}
+
+x4sensor_error_t
+x4sensor_get_detector_config(x4sensor_detector_config_t *detector)
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage >= X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+    X4SENSOR_CHECK_OR_RETURN(detector != NULL, X4SENSOR_INVALID_PARAMETER);
+    memset(detector, 0, sizeof(*detector));
+    detector->threshold_count = range_bins;
+    memcpy(detector->thresholds, algorithm_config.detector_thresholds, sizeof(uint16_t) * range_bins);
+    memcpy(detector->M, algorithm_config.app_logic_M, sizeof(detector->M));
+    memcpy(detector->N, algorithm_config.app_logic_N, sizeof(detector->N));
+    return X4SENSOR_SUCCESS;
+}
+
+//
+// Writes the parameters to a running sensor. The X4 firmware picks them up
+// with the next frame. Does nothing while the sensor is stopped since
+// configure_and_start_x4() writes them anyway.
+//
+static x4sensor_error_t
+write_config_live()
+{
+    if (run_stage != X4_RUN_STAGE_RUNNING)
+        return X4SENSOR_SUCCESS;
+
+    for(int attempts = x4sensor_get_retry_count(); attempts > 0; --attempts){
+        x4_stat = vtable->write_config(&algorithm_config);
+        if(x4_stat == X4SENSOR_SUCCESS){
+            break;
+        }
+    }
+    if (x4_stat != X4SENSOR_SUCCESS)
+        disable_x4();
+    return x4_stat;
+}
+
+x4sensor_error_t
+x4sensor_set_detector_config(const x4sensor_detector_config_t *detector)
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage >= X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+    // A pipelined read has the data pointer of the sensor set to the frame
+    X4SENSOR_CHECK_OR_RETURN(!is_read_pending, X4SENSOR_NOT_ALLOWED);
+    X4SENSOR_CHECK_OR_RETURN(detector != NULL, X4SENSOR_INVALID_PARAMETER);
+    X4SENSOR_CHECK_OR_RETURN(detector->threshold_count == range_bins, X4SENSOR_INVALID_PARAMETER);
+    for (int i = 0; i < 2; i++) {
+        X4SENSOR_CHECK_OR_RETURN(detector->M[i] > 0 && detector->M[i] <= detector->N[i], X4SENSOR_INVALID_PARAMETER);
+    }
+
+    memcpy(&algorithm_config.detector_thresholds, detector->thresholds, sizeof(uint16_t) * range_bins);
+    memcpy(&algorithm_config.app_logic_M, detector->M, 2);
+    memcpy(&algorithm_config.app_logic_N, detector->N, 2);
+    sensitivity_level = 0;
+
+    return write_config_live();
+}
+
 x4sensor_error_t
 x4sensor_set_periodic_report_interval(uint16_t period_frames)
 {
@@ -431,22 +726,116 @@ x4sensor_start_event_mode(x4sensor_event_flags_t events)
     return configure_and_start_x4(X4_RUN_MODE_EVENT, events);
 }
 
-x4sensor_error_t
-x4sensor_start_recording_mode()
+static x4sensor_error_t
+start_recording(uint16_t report_interval)
 {
     is_recording = true;
-    x4sensor_set_periodic_report_interval(1);
+    x4sensor_set_periodic_report_interval(report_interval);
     return configure_and_start_x4(X4_RUN_MODE_EVENT, X4SENSOR_EVENT_PERIODIC_REPORT);
 }
 
+x4sensor_error_t
+x4sensor_start_recording_mode()
+{
+    x4sensor_recording_budget_t budget;
+    uint16_t report_interval = 1;
+
+    if (budget_policy != X4SENSOR_BUDGET_POLICY_IGNORE) {
+        x4_stat = x4sensor_get_recording_budget(&budget);
+        X4SENSOR_CHECK_OR_RETURN(x4_stat == X4SENSOR_SUCCESS, x4_stat);
+        if (budget.min_report_interval > 1) {
+            X4SENSOR_CHECK_OR_RETURN(budget_policy == X4SENSOR_BUDGET_POLICY_DECIMATE, X4SENSOR_BUDGET_EXCEEDED);
+            report_interval = budget.min_report_interval;
+        }
+    }
+    return start_recording(report_interval);
+}
+
+x4sensor_error_t
+x4sensor_get_recording_budget(x4sensor_recording_budget_t *budget)
+{
+    x4sensor_recording_setup_t setup;
+
+    X4SENSOR_CHECK_OR_RETURN(run_stage >= X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+    setup.bus = bus;
+    setup.bus_frequency_hz = host_bus_frequency_hz ? host_bus_frequency_hz : bus_frequency_hz;
+    setup.range_bins = config->FrameConfig_RangeBins;
+    setup.frame_rate = config->ChipX4_FPS;
+    setup.host = host_timing;
+    x4_stat = x4sensor_plan_recording(&setup, budget);
+    return x4_stat;
+}
+
+x4sensor_error_t
+x4sensor_begin_calibration(x4sensor_calibration_t *calibration, const x4sensor_calibration_setup_t *setup)
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage >= X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+    x4_stat = x4sensor_calibration_init(calibration, setup, config->FrameConfig_RangeBins, range_bins);
+    return x4_stat;
+}
+
+x4sensor_error_t
+x4sensor_begin_tracking(x4sensor_tracker_t *tracker, const x4sensor_tracker_setup_t *setup)
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage >= X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+    x4_stat = x4sensor_tracker_init(tracker, setup, config->ChipX4_FPS, x4sensor_get_distance_between_bins_mm());
+    return x4_stat;
+}
+
+void
+x4sensor_get_driver_stats(x4sensor_driver_stats_t *stats)
+{
+    if (stats == NULL)
+        return;
+    x4sensor_trace_get_counts(stats);
+    stats->bus = bus;
+    stats->bus_frequency_hz = host_bus_frequency_hz ? host_bus_frequency_hz : bus_frequency_hz;
+}
+
+x4sensor_error_t
+x4sensor_set_recording_host_timing(const x4sensor_host_timing_t *timing, uint32_t frequency_hz)
+{
+    X4SENSOR_CHECK_OR_RETURN(timing != NULL, X4SENSOR_INVALID_PARAMETER);
+    host_timing = *timing;
+    host_bus_frequency_hz = frequency_hz;
+    return X4SENSOR_SUCCESS;
+}
+
+x4sensor_error_t
+x4sensor_set_recording_budget_policy(x4sensor_budget_policy_t policy)
+{
+    X4SENSOR_CHECK_OR_RETURN(policy <= X4SENSOR_BUDGET_POLICY_DECIMATE, X4SENSOR_INVALID_PARAMETER);
+    budget_policy = policy;
+    return X4SENSOR_SUCCESS;
+}
+
+x4sensor_error_t
+x4sensor_prepare()
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage == X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+
+    x4_stat = load_firmware();
+    if (x4_stat != X4SENSOR_SUCCESS)
+        disable_x4();
+    return x4_stat;
+}
+
+bool
+x4sensor_is_prepared()
+{
+    return run_stage == X4_RUN_STAGE_STOPPED && firmware_loaded;
+}
+
 x4sensor_error_t
 x4sensor_stop()
 {
     chipinterface_error_t chip_stat;
-    X4SENSOR_CHECK_OR_RETURN(run_stage == X4_RUN_STAGE_RUNNING, X4SENSOR_NOT_ALLOWED);
+    X4SENSOR_CHECK_OR_RETURN(run_stage == X4_RUN_STAGE_RUNNING || firmware_loaded, X4SENSOR_NOT_ALLOWED);
 
     run_stage = X4_RUN_STAGE_STOPPED;
+    firmware_loaded = false;
     is_recording = false;
+    is_read_pending = false;
     chip_stat = chipinterface_set_chip_enabled(false);
     X4SENSOR_CHECK_OR_RETURN(chip_stat == CHIPINTERFACE_SUCCESS, X4SENSOR_CHIPINTERFACE_ERROR);
 
@@ -458,6 +847,7 @@ x4sensor_get_sensor_data(uint8_t *buffer, size_t max_size)
 {
     X4SENSOR_CHECK(run_stage == X4_RUN_STAGE_RUNNING, x4_stat = X4SENSOR_NOT_ALLOWED; goto error;);
     X4SENSOR_CHECK(run_mode == X4_RUN_MODE_EVENT, x4_stat = X4SENSOR_NOT_ALLOWED; goto error;);
+    X4SENSOR_CHECK(!is_read_pending, x4_stat = X4SENSOR_NOT_ALLOWED; goto error;);
     if(x4sensor_is_recording()){
         X4SENSOR_CHECK(max_size >= x4sensor_get_max_sensor_data_size_recording_mode(), x4_stat = X4SENSOR_INVALID_PARAMETER; goto error;);
     }else{
@@ -481,6 +871,56 @@ error:
     return 0;
 }
 
+x4sensor_error_t
+x4sensor_start_sensor_data_read(uint8_t *buffer, size_t max_size)
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage == X4_RUN_STAGE_RUNNING, X4SENSOR_NOT_ALLOWED);
+    X4SENSOR_CHECK_OR_RETURN(run_mode == X4_RUN_MODE_EVENT, X4SENSOR_NOT_ALLOWED);
+    X4SENSOR_CHECK_OR_RETURN(!is_read_pending, X4SENSOR_NOT_ALLOWED);
+    if(x4sensor_is_recording()){
+        X4SENSOR_CHECK_OR_RETURN(max_size >= x4sensor_get_max_sensor_data_size_recording_mode(), X4SENSOR_INVALID_PARAMETER);
+    }else{
+        X4SENSOR_CHECK_OR_RETURN(max_size >= x4sensor_get_max_sensor_data_size_event_mode(), X4SENSOR_INVALID_PARAMETER);
+    }
+    // Interfaces without background transfers read the whole frame right away
+    read_recording_data_func read_data = vtable->start_read_recording_data;
+    if (read_data == NULL)
+        read_data = vtable->read_recording_data;
+
+    pending_bytes_read = 0;
+    for(int attempts = x4sensor_get_retry_count(); attempts > 0; --attempts){
+        x4_stat = read_data(buffer, max_size, &pending_bytes_read);
+        if((x4_stat == X4SENSOR_SUCCESS) || (x4_stat == X4SENSOR_FRAME_COUNTER_NOT_INCREASED)){
+            break;
+        }
+    }
+    if (x4_stat != X4SENSOR_SUCCESS){
+        disable_x4();
+        return x4_stat;
+    }
+    is_read_pending = true;
+    return X4SENSOR_SUCCESS;
+}
+
+size_t
+x4sensor_finish_sensor_data_read()
+{
+    X4SENSOR_CHECK(is_read_pending, x4_stat = X4SENSOR_NOT_ALLOWED; goto error;);
+    is_read_pending = false;
+    if (vtable->finish_read_recording_data != NULL) {
+        x4_stat = vtable->finish_read_recording_data();
+        if (x4_stat != X4SENSOR_SUCCESS){
+            disable_x4();
+            goto error;
+        }
+    }
+    x4_stat = vtable->clear_interrupt();
+    X4SENSOR_CHECK(x4_stat == X4SENSOR_SUCCESS, goto error);
+    return pending_bytes_read;
+error:
+    return 0;
+}
+
 x4sensor_error_t x4sensor_get_distance_cluster(const uint8_t *buffer, x4sensor_distance_cluster_t* dist_cluster){
     if(x4sensor_get_distance_cluster_length() == 0){
         x4_stat = X4SENSOR_FEATURE_NOT_SUPPORTED;
@@ -522,6 +962,45 @@ uint16_t x4sensor_get_distance_between_bins_mm(){
     return (uint16_t)config->FrameConfig_RangeBinLength_mm*config->range_decimation_DecimFactor;
 }
 
+X4_STATIC_ASSERT(X4_MAX_RANGE_BINS <= 32, range_bin_masks_are_32_bit);
+
+x4sensor_error_t
+x4sensor_get_range_bin_mask(uint16_t from_cm, uint16_t to_cm, uint32_t *mask)
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage >= X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+    X4SENSOR_CHECK_OR_RETURN(mask != NULL && from_cm < to_cm, X4SENSOR_INVALID_PARAMETER);
+    *mask = 0;
+    for (uint8_t bin = 0; bin < range_bins; bin++) {
+        int16_t bin_cm = x4sensor_bin_to_cm_conv(bin, range_lut);
+        if (bin_cm >= (int32_t)from_cm && bin_cm < (int32_t)to_cm)
+            *mask |= (uint32_t)1 << bin;
+    }
+    return X4SENSOR_SUCCESS;
+}
+
+uint32_t
+x4sensor_get_detection_bin_mask(const uint8_t *buffer)
+{
+    const payload_t *payload = (const payload_t *)buffer;
+    uint8_t first_bin = payload->distanceClusterFirstBinAboveThresholdIndex;
+    uint32_t mask = 0;
+
+    if (first_bin == 0xff || first_bin >= range_bins)
+        return 0;
+    mask = (uint32_t)1 << first_bin;
+
+    // The cluster starts one bin before the first hit, entries behind
+    // distanceClusterIndex are not valid
+    for (int i = 0; i < config->detector_DistanceClusterLength && i <= payload->distanceClusterIndex; i++) {
+        int bin = first_bin - 1 + i;
+        if (bin < 0 || bin >= range_bins)
+            continue;
+        if (payload->distanceClusterBinsPower[i] >= algorithm_config.detector_thresholds[bin])
+            mask |= (uint32_t)1 << bin;
+    }
+    return mask;
+}
+
 
 bool
 x4sensor_get_detection_state(const uint8_t *buffer)
@@ -553,6 +1032,43 @@ error:
     return 0;
 }
 
+x4sensor_error_t
+x4sensor_set_frame_rate_divider(uint8_t divider)
+{
+    X4SENSOR_CHECK_OR_RETURN(run_stage >= X4_RUN_STAGE_STOPPED, X4SENSOR_NOT_ALLOWED);
+    // A pipelined read has the data pointer of the sensor set to the frame
+    X4SENSOR_CHECK_OR_RETURN(!is_read_pending, X4SENSOR_NOT_ALLOWED);
+    X4SENSOR_CHECK_OR_RETURN(divider > 0 && config->ChipX4_FPS % divider == 0, X4SENSOR_INVALID_PARAMETER);
+
+    if (divider == frame_rate_divider)
+        return X4SENSOR_SUCCESS;
+    frame_rate_divider = divider;
+    // the oscillator is measured at the first start, which sets the period
+    if (run_stage != X4_RUN_STAGE_RUNNING)
+        return X4SENSOR_SUCCESS;
+    algorithm_config.sweep_period = get_sweep_period();
+    return write_config_live();
+}
+
+uint8_t
+x4sensor_get_frame_rate_divider()
+{
+    X4SENSOR_CHECK(run_stage >= X4_RUN_STAGE_STOPPED, x4_stat = X4SENSOR_NOT_ALLOWED; goto error;);
+    return frame_rate_divider;
+error:
+    return 0;
+}
+
+uint32_t
+x4sensor_get_detection_latency_us()
+{
+    X4SENSOR_CHECK(run_stage >= X4_RUN_STAGE_STOPPED, x4_stat = X4SENSOR_NOT_ALLOWED; goto error;);
+    uint32_t frames = 1u + algorithm_config.app_logic_N[0] + algorithm_config.app_logic_N[1];
+    return (uint32_t)((uint64_t)frames * frame_rate_divider * 1000000u / config->ChipX4_FPS);
+error:
+    return 0;
+}
+
 static x4sensor_error_t
 set_test_mode(x4_test_mode_t mode)
 {
@@ -673,7 +1189,8 @@ error:
 x4sensor_error_t
 x4sensor_start_test_mode(x4_test_mode_t test_mode)
 {
-    X4SENSOR_CHECK(x4sensor_start_recording_mode() == X4SENSOR_SUCCESS, return x4_stat);
+    // Test modes always report every frame regardless of the recording budget
+    X4SENSOR_CHECK(start_recording(1) == X4SENSOR_SUCCESS, return x4_stat);
     X4SENSOR_CHECK_OR_RETURN(chipinterface_wait_for_interrupt(200000) == CHIPINTERFACE_SUCCESS, X4SENSOR_CHIPINTERFACE_ERROR);
     X4SENSOR_CHECK(set_test_mode(test_mode) == X4SENSOR_SUCCESS, return x4_stat);
     if ((test_mode != X4_TEST_MODE_M1) && (test_mode != X4_TEST_MODE_M2) && (test_mode != X4_TEST_MODE_M1_KCC) && (test_mode != X4_TEST_MODE_M2_KCC))
@@ -711,11 +1228,8 @@ x4sensor_is_recording()
 uint8_t
 x4sensor_make_firmware_hash()
 {
-    uint8_t val = 0;
-    for (size_t i = 0; i < firmware_size; ++i) {
-        val = (val ^ firmware_data[i]) + 47;
-    }
-    return val;
+    // Computed once per blob by parse_config_blob()
+    return firmware_hash;
 }
 
 x4sensor_error_t
@@ -759,6 +1273,10 @@ x4sensor_convert_error_to_string(x4sensor_error_t error)
         return "The frame counter has not increased.";
     else if (error == X4SENSOR_DATA_NOT_READY)
         return "Sensor data is not yet ready.";
+    else if (error == X4SENSOR_BUDGET_EXCEEDED)
+        return "The host cannot keep up with the recording frame rate on this interface.";
+    else if (error == X4SENSOR_CONFIGURATION_REGISTRY_FULL)
+        return "No more configuration blobs can be added.";
     else
        return "Invalid error code";
 }
@@ -0,0 +1,149 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+#include "novelda_x4sensor.h"
+#include "x4_algorithm_common.h"
+
+#include <string.h>
+
+// Host builds with SSE2 decode four frames at a time and transpose their
+// distance cluster powers in registers. Other builds decode frame by frame
+// with minimal code size.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define X4SENSOR_BATCH_SSE2
+X4_STATIC_ASSERT(DISTANCE_CLUSTER_LENGTH == 6, sse2_decoder_assumes_six_cluster_bins);
+#endif
+
+#define OFFSET_FRAME_COUNTER offsetof(payload_t, frame_counter)
+#define OFFSET_PRESENCE offsetof(payload_t, detection.presence)
+#define OFFSET_FIRST_BIN offsetof(payload_t, distanceClusterFirstBinAboveThresholdIndex)
+#define OFFSET_CLUSTER_INDEX offsetof(payload_t, distanceClusterIndex)
+#define OFFSET_BIN_POWER offsetof(payload_t, distanceClusterBinsPower)
+
+static inline uint32_t
+load_u32(const uint8_t *data)
+{
+    // payload_t is packed, memcpy is the portable unaligned load
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+//
+// Returns the last valid distance cluster bin, or -1 if the detector had no
+// hit. Bins behind a premature end of the cluster are reported as 0, as in
+// x4sensor_get_distance_cluster().
+//
+static inline int32_t
+last_cluster_bin(const uint8_t *payload)
+{
+    if (payload[OFFSET_FIRST_BIN] == 0xff)
+        return -1;
+    return payload[OFFSET_CLUSTER_INDEX];
+}
+
+static void
+decode_frame(const uint8_t *payload, size_t n, uint8_t cluster_length, const x4sensor_payload_columns_t *columns)
+{
+    if (columns->frame_counter)
+        columns->frame_counter[n] = load_u32(&payload[OFFSET_FRAME_COUNTER]);
+    if (columns->presence)
+        columns->presence[n] = payload[OFFSET_PRESENCE] != 0;
+    if (columns->first_bin)
+        columns->first_bin[n] = payload[OFFSET_FIRST_BIN];
+
+    int32_t last_bin = last_cluster_bin(payload);
+    for (uint8_t bin = 0; bin < cluster_length; bin++) {
+        if (columns->bin_power[bin] == NULL)
+            continue;
+        uint32_t power = load_u32(&payload[OFFSET_BIN_POWER + bin * sizeof(uint32_t)]);
+        columns->bin_power[bin][n] = (bin <= last_bin) ? power : 0;
+    }
+}
+
+#ifdef X4SENSOR_BATCH_SSE2
+static void
+decode_4_frames_sse2(const uint8_t *buffer, size_t stride, size_t n, uint8_t cluster_length,
+                     const x4sensor_payload_columns_t *columns)
+{
+    const uint8_t *p0 = &buffer[n * stride];
+    const uint8_t *p1 = p0 + stride;
+    const uint8_t *p2 = p1 + stride;
+    const uint8_t *p3 = p2 + stride;
+    __m128i bins[DISTANCE_CLUSTER_LENGTH];
+
+    if (columns->frame_counter) {
+        columns->frame_counter[n] = load_u32(&p0[OFFSET_FRAME_COUNTER]);
+        columns->frame_counter[n + 1] = load_u32(&p1[OFFSET_FRAME_COUNTER]);
+        columns->frame_counter[n + 2] = load_u32(&p2[OFFSET_FRAME_COUNTER]);
+        columns->frame_counter[n + 3] = load_u32(&p3[OFFSET_FRAME_COUNTER]);
+    }
+    if (columns->presence) {
+        columns->presence[n] = p0[OFFSET_PRESENCE] != 0;
+        columns->presence[n + 1] = p1[OFFSET_PRESENCE] != 0;
+        columns->presence[n + 2] = p2[OFFSET_PRESENCE] != 0;
+        columns->presence[n + 3] = p3[OFFSET_PRESENCE] != 0;
+    }
+    if (columns->first_bin) {
+        columns->first_bin[n] = p0[OFFSET_FIRST_BIN];
+        columns->first_bin[n + 1] = p1[OFFSET_FIRST_BIN];
+        columns->first_bin[n + 2] = p2[OFFSET_FIRST_BIN];
+        columns->first_bin[n + 3] = p3[OFFSET_FIRST_BIN];
+    }
+
+    // Bins 0-3 with one register per frame, transposed to one register per bin
+    __m128i r0 = _mm_loadu_si128((const __m128i*)&p0[OFFSET_BIN_POWER]);
+    __m128i r1 = _mm_loadu_si128((const __m128i*)&p1[OFFSET_BIN_POWER]);
+    __m128i r2 = _mm_loadu_si128((const __m128i*)&p2[OFFSET_BIN_POWER]);
+    __m128i r3 = _mm_loadu_si128((const __m128i*)&p3[OFFSET_BIN_POWER]);
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+    bins[0] = _mm_unpacklo_epi64(t0, t1);
+    bins[1] = _mm_unpackhi_epi64(t0, t1);
+    bins[2] = _mm_unpacklo_epi64(t2, t3);
+    bins[3] = _mm_unpackhi_epi64(t2, t3);
+
+    // Bins 4-5
+    r0 = _mm_loadl_epi64((const __m128i*)&p0[OFFSET_BIN_POWER + 4 * sizeof(uint32_t)]);
+    r1 = _mm_loadl_epi64((const __m128i*)&p1[OFFSET_BIN_POWER + 4 * sizeof(uint32_t)]);
+    r2 = _mm_loadl_epi64((const __m128i*)&p2[OFFSET_BIN_POWER + 4 * sizeof(uint32_t)]);
+    r3 = _mm_loadl_epi64((const __m128i*)&p3[OFFSET_BIN_POWER + 4 * sizeof(uint32_t)]);
+    t0 = _mm_unpacklo_epi32(r0, r1);
+    t1 = _mm_unpacklo_epi32(r2, r3);
+    bins[4] = _mm_unpacklo_epi64(t0, t1);
+    bins[5] = _mm_unpackhi_epi64(t0, t1);
+
+    __m128i last_bin = _mm_set_epi32(last_cluster_bin(p3), last_cluster_bin(p2),
+                                     last_cluster_bin(p1), last_cluster_bin(p0));
+    for (uint8_t bin = 0; bin < cluster_length; bin++) {
+        if (columns->bin_power[bin] == NULL)
+            continue;
+        __m128i invalid = _mm_cmpgt_epi32(_mm_set1_epi32(bin), last_bin);
+        _mm_storeu_si128((__m128i*)&columns->bin_power[bin][n], _mm_andnot_si128(invalid, bins[bin]));
+    }
+}
+#endif
+
+x4sensor_error_t
+x4sensor_decode_payloads(const uint8_t *buffer, size_t stride, size_t count, uint8_t cluster_length,
+                         const x4sensor_payload_columns_t *columns)
+{
+    size_t n = 0;
+
+    if (buffer == NULL || columns == NULL)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (stride < sizeof(payload_t) || cluster_length > DISTANCE_CLUSTER_LENGTH)
+        return X4SENSOR_INVALID_PARAMETER;
+
+#ifdef X4SENSOR_BATCH_SSE2
+    for (; n + 4 <= count; n += 4)
+        decode_4_frames_sse2(buffer, stride, n, cluster_length, columns);
+#endif
+    for (; n < count; n++)
+        decode_frame(&buffer[n * stride], n, cluster_length, columns);
+
+    return X4SENSOR_SUCCESS;
+}
@@ -0,0 +1,251 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+#include "novelda_x4sensor.h"
+#include "x4_algorithm_common.h"
+
+#include <string.h>
+
+// Must match the command wait times of x4sensor_i2c.c and x4sensor_spi.c
+#define I2C_COMMAND_WAIT_MICROSECONDS 60
+#define SPI_COMMAND_WAIT_MICROSECONDS 60
+#define SPI_MAX_READ_BYTES 8
+
+// An I2C transfer clocks 9 bits per byte plus the address byte, start and stop
+#define I2C_BITS_PER_BYTE 9
+#define I2C_FRAMING_BITS (I2C_BITS_PER_BYTE + 2)
+#define SPI_BITS_PER_BYTE 8
+
+typedef struct {
+    uint32_t bits;
+    uint32_t bulk_bits;
+    uint16_t transactions;
+    uint16_t bytes;
+    uint16_t waits;
+} bus_tally_t;
+
+static void
+add_i2c_transfer(bus_tally_t *tally, uint16_t nbytes)
+{
+    tally->bits += I2C_FRAMING_BITS + I2C_BITS_PER_BYTE * (uint32_t)nbytes;
+    tally->bytes += nbytes;
+    tally->transactions++;
+}
+
+static void
+add_i2c_command(bus_tally_t *tally, uint16_t nbytes)
+{
+    add_i2c_transfer(tally, nbytes);
+    tally->waits++;
+}
+
+static void
+add_spi_transfer(bus_tally_t *tally, uint16_t nbytes)
+{
+    tally->bits += SPI_BITS_PER_BYTE * (uint32_t)nbytes;
+    tally->bytes += nbytes;
+    tally->transactions++;
+}
+
+static void
+add_spi_command(bus_tally_t *tally, uint16_t nbytes)
+{
+    // write_data_spi() prepends ADDR_SPI_TO_CPU_WRITE_DATA_WE
+    add_spi_transfer(tally, nbytes + 1);
+    tally->waits++;
+}
+
+static void
+add_spi_read(bus_tally_t *tally, uint16_t nbytes)
+{
+    // read_data_spi() reads the CPU FIFO in chunks of SPI_MAX_READ_BYTES,
+    // each preceded by ADDR_SPI_FROM_CPU_READ_DATA_RE
+    for (uint16_t offset = 0; offset < nbytes; offset += SPI_MAX_READ_BYTES) {
+        uint16_t chunk = nbytes - offset;
+        if (chunk > SPI_MAX_READ_BYTES)
+            chunk = SPI_MAX_READ_BYTES;
+        add_spi_transfer(tally, chunk + 1);
+    }
+}
+
+//
+// Mirrors read_recording_data_i2c() in recording mode followed by
+// clear_interrupt_i2c().
+//
+static void
+tally_i2c(bus_tally_t *tally, uint16_t radar_bytes)
+{
+    add_i2c_command(tally, 2);                 // X4_COMMAND_SET_DPTR_TO_RESULT
+    add_i2c_transfer(tally, sizeof(payload_t));
+    add_i2c_command(tally, 2);                 // X4_COMMAND_SET_DPTR_TO_RADAR_DATA
+    uint32_t bits = tally->bits;
+    add_i2c_transfer(tally, radar_bytes);
+    tally->bulk_bits = tally->bits - bits;
+    add_i2c_command(tally, 1);                 // X4_COMMAND_CLEAR_INTERRUPT
+}
+
+//
+// Mirrors read_recording_data_spi() in recording mode followed by
+// clear_interrupt(), assuming empty FIFOs and the payload being ready at the
+// first poll.
+//
+static void
+tally_spi(bus_tally_t *tally, uint16_t radar_bytes)
+{
+    add_spi_transfer(tally, 2);                // ADDR_SPI_SPI_MB_FIFO_STATUS_R
+    add_spi_command(tally, 2);                 // X4_COMMAND_SET_DPTR_TO_RESULT
+    add_spi_transfer(tally, 2);                // ADDR_SPI_SPI_MB_FIFO_STATUS_R
+    add_spi_read(tally, sizeof(payload_t));
+    add_spi_command(tally, 5);                 // ADDR_PIF_FETCH_RADAR_DATA_SPI_W
+    uint32_t bits = tally->bits;
+    add_spi_transfer(tally, radar_bytes + 1);  // ADDR_SPI_RADAR_DATA_SPI_RE
+    tally->bulk_bits = tally->bits - bits;
+    add_spi_command(tally, 1);                 // X4_COMMAND_CLEAR_INTERRUPT
+}
+
+static uint32_t
+bits_to_us(uint32_t bits, uint32_t frequency_hz)
+{
+    return (uint32_t)(((uint64_t)bits * 1000000u + frequency_hz - 1) / frequency_hz);
+}
+
+x4sensor_error_t
+x4sensor_plan_recording(const x4sensor_recording_setup_t *setup, x4sensor_recording_budget_t *budget)
+{
+    bus_tally_t tally;
+    uint32_t command_wait_us;
+    uint32_t bulk_time_us;
+
+    if (setup == NULL || budget == NULL)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (setup->frame_rate == 0 || setup->bus_frequency_hz == 0)
+        return X4SENSOR_INVALID_PARAMETER;
+
+    memset(&tally, 0, sizeof(tally));
+    memset(budget, 0, sizeof(*budget));
+    uint16_t radar_bytes = (uint16_t)(setup->range_bins * sizeof(x4_sample_t));
+    if (setup->bus == X4SENSOR_BUS_I2C) {
+        tally_i2c(&tally, radar_bytes);
+        command_wait_us = I2C_COMMAND_WAIT_MICROSECONDS;
+    } else if (setup->bus == X4SENSOR_BUS_SPI) {
+        tally_spi(&tally, radar_bytes);
+        command_wait_us = SPI_COMMAND_WAIT_MICROSECONDS;
+    } else {
+        return X4SENSOR_INVALID_PARAMETER;
+    }
+
+    // chipinterface_wait_us() may only be able to wait in multiples of its
+    // resolution. Assume the worst case.
+    if (setup->host.wait_resolution_us > 1) {
+        uint32_t resolution = setup->host.wait_resolution_us;
+        command_wait_us = (command_wait_us + resolution - 1) / resolution * resolution;
+    }
+
+    budget->frame_period_us = 1000000u / setup->frame_rate;
+    budget->transactions = tally.transactions;
+    budget->bytes = tally.bytes;
+    budget->bus_time_us = bits_to_us(tally.bits, setup->bus_frequency_hz);
+    budget->wait_time_us = tally.waits * command_wait_us;
+    budget->overhead_time_us = tally.transactions * setup->host.transaction_overhead_us;
+    budget->cpu_time_us = setup->host.cpu_time_per_frame_us;
+
+    // When pipelined, the radar data of this frame is transferred while the
+    // previous frame is processed.
+    bulk_time_us = bits_to_us(tally.bulk_bits, setup->bus_frequency_hz);
+    uint32_t frame_time_us = budget->bus_time_us + budget->wait_time_us + budget->overhead_time_us;
+    if (setup->host.pipelined && setup->bus == X4SENSOR_BUS_SPI) {
+        if (budget->cpu_time_us > bulk_time_us)
+            frame_time_us += budget->cpu_time_us - bulk_time_us;
+    } else {
+        frame_time_us += budget->cpu_time_us;
+    }
+    budget->frame_time_us = frame_time_us;
+
+    uint32_t load_permille = (uint32_t)((uint64_t)frame_time_us * 1000u / budget->frame_period_us);
+    budget->load_permille = (load_permille > UINT16_MAX) ? UINT16_MAX : (uint16_t)load_permille;
+    uint32_t min_interval = (frame_time_us + budget->frame_period_us - 1) / budget->frame_period_us;
+    if (min_interval == 0)
+        min_interval = 1;
+    budget->min_report_interval = (min_interval > UINT16_MAX) ? UINT16_MAX : (uint16_t)min_interval;
+
+    return X4SENSOR_SUCCESS;
+}
+
+static uint32_t
+average_na(uint64_t charge_pc, uint32_t duration_ms)
+{
+    uint64_t current_na = charge_pc / duration_ms;
+    return (current_na > UINT32_MAX) ? UINT32_MAX : (uint32_t)current_na;
+}
+
+//
+// Charges are added up in pC, a current in nA over a time in ms or a charge
+// in nC times 1000.
+//
+x4sensor_error_t
+x4sensor_estimate_energy(const x4sensor_energy_coefficients_t *coefficients,
+                         const x4sensor_energy_activity_t *activity,
+                         x4sensor_energy_estimate_t *estimate)
+{
+    const x4sensor_energy_coefficients_t *c = coefficients;
+    const x4sensor_energy_activity_t *a = activity;
+    uint64_t bits;
+    uint64_t frames;
+    uint64_t connection_events = 0;
+    uint64_t advertising_events = 0;
+    uint64_t wakeups;
+    uint64_t cpu_us;
+
+    if (c == NULL || a == NULL || estimate == NULL)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (a->duration_ms == 0)
+        return X4SENSOR_INVALID_PARAMETER;
+
+    memset(estimate, 0, sizeof(*estimate));
+    // before the first initialization there is no bus and no bus clock
+    if (a->bytes == 0 && a->transactions == 0)
+        bits = 0;
+    else if (a->bus_frequency_hz == 0)
+        return X4SENSOR_INVALID_PARAMETER;
+    else if (a->bus == X4SENSOR_BUS_I2C)
+        bits = (uint64_t)a->bytes * I2C_BITS_PER_BYTE + (uint64_t)a->transactions * I2C_FRAMING_BITS;
+    else if (a->bus == X4SENSOR_BUS_SPI)
+        bits = (uint64_t)a->bytes * SPI_BITS_PER_BYTE;
+    else
+        return X4SENSOR_INVALID_PARAMETER;
+    uint64_t bus_time_us = bits ? (bits * 1000000u + a->bus_frequency_hz - 1) / a->bus_frequency_hz : 0;
+    estimate->bus_time_us = (bus_time_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)bus_time_us;
+
+    frames = (uint64_t)a->sensor_ms * a->frame_rate / 1000u;
+    if (a->connection_interval_us)
+        connection_events = (uint64_t)a->connected_ms * 1000u / a->connection_interval_us;
+    if (a->advertising_interval_us)
+        advertising_events = (uint64_t)a->advertising_ms * 1000u / a->advertising_interval_us;
+    wakeups = a->wakeups;
+    if (wakeups == 0)
+        wakeups = a->data_reads + connection_events + advertising_events;
+    cpu_us = (uint64_t)a->cpu_ms * 1000u;
+    if (cpu_us == 0)
+        cpu_us = bus_time_us;
+
+    uint64_t idle_pc = (uint64_t)c->idle_na * a->duration_ms;
+    uint64_t sensor_pc = (uint64_t)c->sensor_on_na * a->sensor_ms +
+                         frames * c->sensor_frame_nc * 1000u +
+                         (uint64_t)a->firmware_uploads * c->firmware_upload_nc * 1000u;
+    uint64_t bus_pc = (uint64_t)c->bus_active_na * bus_time_us / 1000u +
+                      (uint64_t)a->transactions * c->transaction_nc * 1000u;
+    uint64_t cpu_pc = (uint64_t)c->cpu_active_na * cpu_us / 1000u +
+                      wakeups * c->wakeup_nc * 1000u;
+    uint64_t radio_pc = connection_events * c->connection_event_nc * 1000u +
+                        (uint64_t)a->notifications * c->notification_nc * 1000u +
+                        advertising_events * c->advertising_event_nc * 1000u;
+
+    estimate->idle_na = average_na(idle_pc, a->duration_ms);
+    estimate->sensor_na = average_na(sensor_pc, a->duration_ms);
+    estimate->bus_na = average_na(bus_pc, a->duration_ms);
+    estimate->cpu_na = average_na(cpu_pc, a->duration_ms);
+    estimate->radio_na = average_na(radio_pc, a->duration_ms);
+    estimate->total_na = average_na(idle_pc + sensor_pc + bus_pc + cpu_pc + radio_pc, a->duration_ms);
+
+    return X4SENSOR_SUCCESS;
+}
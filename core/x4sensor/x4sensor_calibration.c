@@ -0,0 +1,143 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+#include "novelda_x4sensor.h"
+#include "x4_algorithm_common.h"
+
+#include <string.h>
+
+// Powers are saturated to the threshold range. This also bounds the sum of
+// squared deviations to 48 bits for the maximum of 65535 frames.
+#define CALIBRATION_MAX_POWER UINT16_MAX
+
+static int16_t
+load_i16(const uint8_t *data)
+{
+    // The radar samples follow the packed payload, memcpy is the portable unaligned load
+    int16_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint32_t
+isqrt64(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > value)
+        bit >>= 2;
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+x4sensor_error_t
+x4sensor_calibration_init(x4sensor_calibration_t *calibration, const x4sensor_calibration_setup_t *setup,
+                          uint8_t radar_bins, uint8_t detector_bins)
+{
+    if (calibration == NULL || setup == NULL)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (setup->frames < 2 || setup->margin_percent == 0)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (detector_bins == 0 || detector_bins > X4SENSOR_MAX_RANGE_BINS || radar_bins % detector_bins != 0)
+        return X4SENSOR_INVALID_PARAMETER;
+
+    memset(calibration, 0, sizeof(*calibration));
+    calibration->setup = *setup;
+    calibration->radar_bins = radar_bins;
+    calibration->detector_bins = detector_bins;
+    calibration->decimation = radar_bins / detector_bins;
+    calibration->frame_size = sizeof(payload_t) + radar_bins * sizeof(x4_sample_t);
+    return X4SENSOR_SUCCESS;
+}
+
+x4sensor_error_t
+x4sensor_calibration_add_frame(x4sensor_calibration_t *calibration, const uint8_t *buffer, size_t size)
+{
+    if (calibration == NULL || buffer == NULL)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (size < calibration->frame_size)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (x4sensor_calibration_is_complete(calibration))
+        return X4SENSOR_SUCCESS;
+
+    const uint8_t *samples = &buffer[sizeof(payload_t)];
+    uint16_t frame = ++calibration->frames;
+    for (uint8_t bin = 0; bin < calibration->detector_bins; bin++) {
+        int32_t *background = calibration->background[bin];
+        int32_t deviation[2];
+
+        for (int iq = 0; iq < 2; iq++) {
+            // Average of the radar bins of this detector bin in Q8
+            int32_t sum = 0;
+            for (uint8_t n = 0; n < calibration->decimation; n++) {
+                size_t offset = (bin * calibration->decimation + n) * sizeof(x4_sample_t) + iq * sizeof(int16_t);
+                sum += load_i16(&samples[offset]);
+            }
+            int32_t value = (int32_t)((int64_t)sum * 256 / calibration->decimation);
+
+            // Deviation from the background of the previous frames, Q4
+            deviation[iq] = (value - background[iq]) / 16;
+            background[iq] += (value - background[iq]) / frame;
+        }
+        if (frame == 1)
+            continue;
+
+        // Power per component, the squared Q4 deviations are Q8
+        uint64_t power = ((uint64_t)((int64_t)deviation[0] * deviation[0]) +
+                          (uint64_t)((int64_t)deviation[1] * deviation[1])) >> 9;
+        power >>= calibration->setup.power_shift;
+        if (power > CALIBRATION_MAX_POWER)
+            power = CALIBRATION_MAX_POWER;
+
+        // Welford update with the mean in Q8
+        int64_t count = frame - 1;
+        int64_t power_q8 = (int64_t)power << 8;
+        int64_t delta = power_q8 - calibration->power_mean[bin];
+        calibration->power_mean[bin] += delta / count;
+        calibration->power_m2[bin] += (uint64_t)(delta * (power_q8 - calibration->power_mean[bin])) >> 16;
+    }
+    return X4SENSOR_SUCCESS;
+}
+
+bool
+x4sensor_calibration_is_complete(const x4sensor_calibration_t *calibration)
+{
+    return calibration != NULL && calibration->frames >= calibration->setup.frames;
+}
+
+x4sensor_error_t
+x4sensor_calibration_get_thresholds(const x4sensor_calibration_t *calibration, x4sensor_detector_config_t *detector)
+{
+    if (calibration == NULL || detector == NULL)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (!x4sensor_calibration_is_complete(calibration))
+        return X4SENSOR_DATA_NOT_READY;
+
+    // The first frame only initializes the background
+    uint64_t count = calibration->frames - 1;
+    detector->threshold_count = calibration->detector_bins;
+    for (uint8_t bin = 0; bin < calibration->detector_bins; bin++) {
+        uint64_t variance_q8 = 0;
+        if (count > 1)
+            variance_q8 = (calibration->power_m2[bin] << 8) / (count - 1);
+        uint64_t std_q4 = isqrt64(variance_q8);
+        uint64_t threshold_q8 = (uint64_t)calibration->power_mean[bin] + calibration->setup.sigma_q4 * std_q4;
+
+        uint64_t threshold = (threshold_q8 * calibration->setup.margin_percent / 100 + 128) >> 8;
+        if (threshold < 1)
+            threshold = 1;
+        if (threshold > UINT16_MAX)
+            threshold = UINT16_MAX;
+        detector->thresholds[bin] = (uint16_t)threshold;
+    }
+    return X4SENSOR_SUCCESS;
+}
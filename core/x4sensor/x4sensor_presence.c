@@ -0,0 +1,127 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+#include "novelda_x4sensor.h"
+
+#include <string.h>
+
+static bool
+transition_due(x4sensor_presence_t *presence, uint16_t frames, uint16_t ms, uint32_t frame_counter, uint32_t time_us)
+{
+    // Wraps with the frame counter
+    int32_t elapsed_frames = (int32_t)(frame_counter - presence->frame_counter);
+
+    // The sensor was restarted, count the frames from here
+    if (elapsed_frames < 0) {
+        presence->frame_counter = frame_counter;
+        elapsed_frames = 0;
+    }
+    // The first frame of the transition counts
+    return (uint32_t)elapsed_frames + 1 >= frames && time_us - presence->time_us >= (uint32_t)ms * 1000;
+}
+
+static void
+begin_transition(x4sensor_presence_t *presence, x4sensor_presence_state_t state, uint32_t frame_counter,
+                 uint32_t time_us)
+{
+    presence->state = state;
+    presence->frame_counter = frame_counter;
+    presence->time_us = time_us;
+}
+
+x4sensor_error_t
+x4sensor_presence_configure(x4sensor_presence_t *presence, const x4sensor_presence_setup_t *setup, uint8_t frame_rate)
+{
+    if (presence == NULL || setup == NULL || frame_rate == 0)
+        return X4SENSOR_INVALID_PARAMETER;
+
+    presence->setup = *setup;
+    presence->frame_rate = frame_rate;
+    return X4SENSOR_SUCCESS;
+}
+
+void
+x4sensor_presence_reset(x4sensor_presence_t *presence)
+{
+    if (presence != NULL)
+        presence->state = X4SENSOR_PRESENCE_ABSENT;
+}
+
+x4sensor_error_t
+x4sensor_presence_update(x4sensor_presence_t *presence, bool detected, uint32_t frame_counter, uint32_t time_us)
+{
+    if (presence == NULL)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (presence->frame_rate == 0)
+        return X4SENSOR_NOT_ALLOWED;
+
+    switch (presence->state) {
+    case X4SENSOR_PRESENCE_ABSENT:
+        if (!detected)
+            break;
+        // Without enter hysteresis presence starts with this frame
+        begin_transition(presence, X4SENSOR_PRESENCE_ENTERING, frame_counter, time_us);
+        // fall through
+    case X4SENSOR_PRESENCE_ENTERING:
+        if (!detected)
+            presence->state = X4SENSOR_PRESENCE_ABSENT;
+        else if (transition_due(presence, presence->setup.enter_frames, presence->setup.enter_ms, frame_counter, time_us))
+            presence->state = X4SENSOR_PRESENCE_PRESENT;
+        break;
+    case X4SENSOR_PRESENCE_PRESENT:
+        if (detected)
+            break;
+        begin_transition(presence, X4SENSOR_PRESENCE_EXITING, frame_counter, time_us);
+        // fall through
+    case X4SENSOR_PRESENCE_EXITING:
+        if (detected)
+            presence->state = X4SENSOR_PRESENCE_PRESENT;
+        else if (transition_due(presence, presence->setup.exit_frames, presence->setup.exit_ms, frame_counter, time_us))
+            presence->state = X4SENSOR_PRESENCE_ABSENT;
+        break;
+    default:
+        presence->state = X4SENSOR_PRESENCE_ABSENT;
+        break;
+    }
+    return X4SENSOR_SUCCESS;
+}
+
+x4sensor_presence_state_t
+x4sensor_presence_get_state(const x4sensor_presence_t *presence)
+{
+    return presence->state;
+}
+
+bool
+x4sensor_presence_is_present(const x4sensor_presence_t *presence)
+{
+    return presence->state == X4SENSOR_PRESENCE_PRESENT || presence->state == X4SENSOR_PRESENCE_EXITING;
+}
+
+uint32_t
+x4sensor_presence_get_remaining_us(const x4sensor_presence_t *presence, uint32_t time_us)
+{
+    uint16_t frames;
+    uint16_t ms;
+
+    if (presence->state == X4SENSOR_PRESENCE_ENTERING) {
+        frames = presence->setup.enter_frames;
+        ms = presence->setup.enter_ms;
+    } else if (presence->state == X4SENSOR_PRESENCE_EXITING) {
+        frames = presence->setup.exit_frames;
+        ms = presence->setup.exit_ms;
+    } else {
+        return UINT32_MAX;
+    }
+    if (presence->frame_rate == 0)
+        return UINT32_MAX;
+
+    // Time of the last frame the transition needs, rounded up
+    uint32_t frames_us = (frames > 1) ? (uint32_t)(((uint64_t)(frames - 1) * 1000000 + presence->frame_rate - 1) /
+                                                   presence->frame_rate) : 0;
+    uint32_t target_us = (uint32_t)ms * 1000;
+    if (frames_us > target_us)
+        target_us = frames_us;
+    uint32_t elapsed_us = time_us - presence->time_us;
+    return (elapsed_us < target_us) ? target_us - elapsed_us : 0;
+}
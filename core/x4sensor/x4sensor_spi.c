@@ -16,10 +16,13 @@
 #define COMMAND_WAIT_MICROSECONDS 60
 #define SPI_MAX_WRITE_BYTES 8
 #define SPI_MAX_READ_BYTES 8
+#define RADAR_DATA_WAIT_MICROSECONDS 100000
 
 static uint32_t prev_frame_counter = 0;
 static uint8_t fw_hash = 0;
 static uint8_t com_buffer[MAX_TRANSFER_SIZE];
+static const uint8_t radar_data_address[] = {ADDR_SPI_RADAR_DATA_SPI_RE};
+static bool radar_data_pending = false;
 static x4sensor_error_t reset_sensor_spi();
 static x4sensor_error_t read_data_spi(uint8_t* data, size_t length_w, size_t length_r, bool direct);
 static x4sensor_error_t
@@ -432,8 +435,16 @@ end:
     return false;
 }
 
+//
+// Reads the payload and, in recording mode, the radar data of the current
+// frame. When async is set, the radar data bulk read is only started and runs
+// in the background until finish_read_recording_data_spi() is called. That
+// allows the host to process the previous frame while the radar data of this
+// frame is transferred. A chip interface that cannot start the transfer in the
+// background gets the blocking read instead.
+//
 static x4sensor_error_t
-read_recording_data_spi(uint8_t *buffer, size_t max_size, size_t *nbytes_read)
+read_recording_data_common(uint8_t *buffer, size_t max_size, size_t *nbytes_read, bool async)
 {
     x4sensor_error_t x4_stat;
     size_t bytes_to_read;
@@ -486,9 +497,14 @@ read_recording_data_spi(uint8_t *buffer, size_t max_size, size_t *nbytes_read)
         uint16_t fetch_data_pif_reg_address = ADDR_PIF_FETCH_RADAR_DATA_SPI_W | 0x8000;
         uint8_t data_fetch_radar_data[] = {X4_SPI_COMMAND_SET_DPTR_TO_MEMORY | 0x80, (uint8_t)(fetch_data_pif_reg_address >> 8), (uint8_t)fetch_data_pif_reg_address ,1 , 0xff};
         x4_stat = write_data_spi(data_fetch_radar_data, sizeof(data_fetch_radar_data), false);
+        X4SENSOR_CHECK(x4_stat == X4SENSOR_SUCCESS, goto end);
 
-        buffer[bytes_read] = ADDR_SPI_RADAR_DATA_SPI_RE;
-        x4_stat = read_data_spi(&buffer[bytes_read], 1, bytes_to_read, true);
+        radar_data_pending = async &&
+            chipinterface_transfer_spi_async(radar_data_address, sizeof(radar_data_address), &buffer[bytes_read], bytes_to_read) == CHIPINTERFACE_SUCCESS;
+        if (!radar_data_pending) {
+            buffer[bytes_read] = ADDR_SPI_RADAR_DATA_SPI_RE;
+            x4_stat = read_data_spi(&buffer[bytes_read], 1, bytes_to_read, true);
+        }
         bytes_read += bytes_to_read;
     }
 
@@ -497,6 +513,29 @@ end:
     return x4_stat;
 }
 
+static x4sensor_error_t
+read_recording_data_spi(uint8_t *buffer, size_t max_size, size_t *nbytes_read)
+{
+    return read_recording_data_common(buffer, max_size, nbytes_read, false);
+}
+
+static x4sensor_error_t
+start_read_recording_data_spi(uint8_t *buffer, size_t max_size, size_t *nbytes_read)
+{
+    return read_recording_data_common(buffer, max_size, nbytes_read, true);
+}
+
+static x4sensor_error_t
+finish_read_recording_data_spi(void)
+{
+    if (!radar_data_pending)
+        return X4SENSOR_SUCCESS;
+    radar_data_pending = false;
+    chipinterface_error_t chip_stat = chipinterface_wait_transfer_spi(RADAR_DATA_WAIT_MICROSECONDS);
+    X4SENSOR_CHECK(chip_stat == CHIPINTERFACE_SUCCESS, return X4SENSOR_CHIPINTERFACE_ERROR);
+    return X4SENSOR_SUCCESS;
+}
+
 
 static x4sensor_error_t
 deinitialize_interface_spi(void)
@@ -509,6 +548,8 @@ deinitialize_interface_spi(void)
 
 const x4sensor_vtable_t x4sensor_vtable_spi = {
     .read_recording_data = read_recording_data_spi,
+    .start_read_recording_data = start_read_recording_data_spi,
+    .finish_read_recording_data = finish_read_recording_data_spi,
     .upload_firmware = upload_firmware_spi,
     .write_config = write_config_spi,
     .set_run_mode = set_run_mode_spi,
@@ -0,0 +1,177 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+//
+// Statistics and trace hook of the host interface. The interface vtable is replaced by a copy
+// whose functions count every operation and report its start and end to the hook around the
+// call of the real function. Optional functions that the interface does not provide stay NULL.
+//
+#include "novelda_x4sensor.h"
+#include "novelda_x4sensor_private.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Nominal bytes of a command and of a register access, without the bus framing
+#define COMMAND_BYTES 2
+#define REGISTER_BYTES 3
+
+static x4sensor_trace_hook_t trace_hook;
+static const x4sensor_vtable_t *traced;
+static x4sensor_vtable_t tracing;
+static uint32_t transactions;
+static uint32_t bytes;
+static uint32_t firmware_uploads;
+static uint32_t data_reads;
+static uint32_t errors;
+
+static void
+trace_start(x4sensor_trace_op_t op, uint32_t value)
+{
+    x4sensor_trace_hook_t hook = trace_hook;
+
+    if (hook)
+        hook(op, false, value > UINT16_MAX ? UINT16_MAX : (uint16_t)value);
+}
+
+static x4sensor_error_t
+trace_end(x4sensor_trace_op_t op, x4sensor_error_t status, size_t nbytes)
+{
+    x4sensor_trace_hook_t hook = trace_hook;
+
+    transactions++;
+    bytes += (uint32_t)nbytes;
+    if (status != X4SENSOR_SUCCESS)
+        errors++;
+    if (hook)
+        hook(op, true, (uint16_t)status);
+    return status;
+}
+
+static x4sensor_error_t
+trace_upload_firmware(const uint8_t *firmware, size_t size)
+{
+    trace_start(X4SENSOR_TRACE_UPLOAD_FIRMWARE, size);
+    firmware_uploads++;
+    return trace_end(X4SENSOR_TRACE_UPLOAD_FIRMWARE, traced->upload_firmware(firmware, size), size);
+}
+
+static x4sensor_error_t
+trace_set_run_mode(x4_run_mode_t mode, x4sensor_event_flags_t events)
+{
+    trace_start(X4SENSOR_TRACE_SET_RUN_MODE, mode);
+    return trace_end(X4SENSOR_TRACE_SET_RUN_MODE, traced->set_run_mode(mode, events), COMMAND_BYTES);
+}
+
+static x4sensor_error_t
+trace_get_register(uint16_t address, uint8_t *value)
+{
+    trace_start(X4SENSOR_TRACE_GET_REGISTER, address);
+    return trace_end(X4SENSOR_TRACE_GET_REGISTER, traced->get_register(address, value), REGISTER_BYTES);
+}
+
+static x4sensor_error_t
+trace_set_register(uint16_t address, uint8_t value)
+{
+    trace_start(X4SENSOR_TRACE_SET_REGISTER, address);
+    return trace_end(X4SENSOR_TRACE_SET_REGISTER, traced->set_register(address, value), REGISTER_BYTES);
+}
+
+static x4sensor_error_t
+trace_write_config(const rw_config_t *config)
+{
+    trace_start(X4SENSOR_TRACE_WRITE_CONFIG, 0);
+    return trace_end(X4SENSOR_TRACE_WRITE_CONFIG, traced->write_config(config), sizeof(*config));
+}
+
+static x4sensor_error_t
+trace_read_recording_data(uint8_t *buffer, size_t max_size, size_t *bytes_read)
+{
+    x4sensor_error_t status;
+
+    trace_start(X4SENSOR_TRACE_READ_DATA, max_size);
+    status = traced->read_recording_data(buffer, max_size, bytes_read);
+    data_reads++;
+    return trace_end(X4SENSOR_TRACE_READ_DATA, status, status == X4SENSOR_SUCCESS ? *bytes_read : 0);
+}
+
+static x4sensor_error_t
+trace_start_read_recording_data(uint8_t *buffer, size_t max_size, size_t *bytes_read)
+{
+    x4sensor_error_t status;
+
+    trace_start(X4SENSOR_TRACE_START_READ_DATA, max_size);
+    status = traced->start_read_recording_data(buffer, max_size, bytes_read);
+    data_reads++;
+    return trace_end(X4SENSOR_TRACE_START_READ_DATA, status, status == X4SENSOR_SUCCESS ? *bytes_read : 0);
+}
+
+static x4sensor_error_t
+trace_finish_read_recording_data(void)
+{
+    trace_start(X4SENSOR_TRACE_FINISH_READ_DATA, 0);
+    return trace_end(X4SENSOR_TRACE_FINISH_READ_DATA, traced->finish_read_recording_data(), 0);
+}
+
+static x4sensor_error_t
+trace_destroy_chipinterface(void)
+{
+    trace_start(X4SENSOR_TRACE_DESTROY, 0);
+    return trace_end(X4SENSOR_TRACE_DESTROY, traced->destroy_chipinterface(), 0);
+}
+
+static x4sensor_error_t
+trace_start_lposc_measurement(uint8_t nticks)
+{
+    trace_start(X4SENSOR_TRACE_START_LPOSC_MEASUREMENT, nticks);
+    return trace_end(X4SENSOR_TRACE_START_LPOSC_MEASUREMENT, traced->start_lposc_measurement(nticks), COMMAND_BYTES);
+}
+
+static x4sensor_error_t
+trace_clear_interrupt(void)
+{
+    trace_start(X4SENSOR_TRACE_CLEAR_INTERRUPT, 0);
+    return trace_end(X4SENSOR_TRACE_CLEAR_INTERRUPT, traced->clear_interrupt(), COMMAND_BYTES);
+}
+
+static x4sensor_error_t
+trace_discover_sensor(x4sensor_info_t *info)
+{
+    trace_start(X4SENSOR_TRACE_DISCOVER_SENSOR, 0);
+    return trace_end(X4SENSOR_TRACE_DISCOVER_SENSOR, traced->discover_sensor(info), REGISTER_BYTES);
+}
+
+const x4sensor_vtable_t *
+x4sensor_trace_vtable(const x4sensor_vtable_t *vtable)
+{
+    traced = vtable;
+    tracing.upload_firmware = trace_upload_firmware;
+    tracing.set_run_mode = trace_set_run_mode;
+    tracing.get_register = trace_get_register;
+    tracing.set_register = trace_set_register;
+    tracing.write_config = trace_write_config;
+    tracing.read_recording_data = trace_read_recording_data;
+    tracing.start_read_recording_data = vtable->start_read_recording_data ? trace_start_read_recording_data : NULL;
+    tracing.finish_read_recording_data = vtable->finish_read_recording_data ? trace_finish_read_recording_data : NULL;
+    tracing.destroy_chipinterface = trace_destroy_chipinterface;
+    tracing.start_lposc_measurement = trace_start_lposc_measurement;
+    tracing.clear_interrupt = trace_clear_interrupt;
+    tracing.discover_sensor = trace_discover_sensor;
+    return &tracing;
+}
+
+void
+x4sensor_set_trace_hook(x4sensor_trace_hook_t hook)
+{
+    trace_hook = hook;
+}
+
+void
+x4sensor_trace_get_counts(x4sensor_driver_stats_t *stats)
+{
+    stats->transactions = transactions;
+    stats->bytes = bytes;
+    stats->firmware_uploads = firmware_uploads;
+    stats->data_reads = data_reads;
+    stats->errors = errors;
+}
@@ -0,0 +1,136 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+#include "novelda_x4sensor.h"
+
+#include <string.h>
+
+#define Q8_ONE 256
+
+static int32_t
+clamp_i32(int64_t value, int32_t min, int32_t max)
+{
+    if (value < min)
+        return min;
+    if (value > max)
+        return max;
+    return (int32_t)value;
+}
+
+static int32_t
+measure_distance_q8(const x4sensor_tracker_t *tracker, const x4sensor_distance_cluster_t *cluster)
+{
+    uint32_t max_power = 0;
+    uint32_t sum = 0;
+    uint32_t weighted = 0;
+    uint8_t shift = 0;
+
+    for (uint8_t i = 0; i < DISTANCE_CLUSTER_LENGTH; i++) {
+        if (cluster->bin_power[i] > max_power)
+            max_power = cluster->bin_power[i];
+    }
+    // Scale the powers to 16 bits so that the weighted sum in Q8 fits 32 bits
+    while ((max_power >> shift) > UINT16_MAX)
+        shift++;
+    for (uint8_t i = 0; i < DISTANCE_CLUSTER_LENGTH; i++) {
+        uint32_t power = cluster->bin_power[i] >> shift;
+        sum += power;
+        weighted += i * power;
+    }
+
+    int32_t distance_q8 = (int32_t)cluster->first_detection_bin_distance_mm * Q8_ONE;
+    if (sum == 0)
+        return distance_q8;
+
+    // The cluster starts one bin before the first hit
+    int32_t centroid_q8 = (int32_t)((weighted * Q8_ONE) / sum) - Q8_ONE;
+    distance_q8 += centroid_q8 * tracker->bin_spacing_mm;
+    return (distance_q8 < 0) ? 0 : distance_q8;
+}
+
+static x4sensor_direction_t
+classify(const x4sensor_tracker_t *tracker)
+{
+    int32_t enter_q8 = (int32_t)tracker->setup.speed_mm_s * Q8_ONE;
+    int32_t leave_q8 = enter_q8 / 2;
+    int32_t velocity_q8 = tracker->velocity_q8;
+
+    if (!tracker->valid)
+        return X4SENSOR_DIRECTION_NONE;
+    if (velocity_q8 <= -enter_q8)
+        return X4SENSOR_DIRECTION_APPROACHING;
+    if (velocity_q8 >= enter_q8)
+        return X4SENSOR_DIRECTION_LEAVING;
+    // Hysteresis, keep the direction until the speed has dropped to half the threshold
+    if (velocity_q8 > -leave_q8 && velocity_q8 < leave_q8)
+        return X4SENSOR_DIRECTION_NONE;
+    return tracker->direction;
+}
+
+x4sensor_error_t
+x4sensor_tracker_init(x4sensor_tracker_t *tracker, const x4sensor_tracker_setup_t *setup, uint8_t frame_rate,
+                      uint16_t bin_spacing_mm)
+{
+    if (tracker == NULL || setup == NULL)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (setup->alpha_q8 == 0 || setup->alpha_q8 > Q8_ONE || setup->beta_q8 == 0 || setup->beta_q8 > setup->alpha_q8)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (setup->coast_frames == 0 || frame_rate == 0 || bin_spacing_mm == 0)
+        return X4SENSOR_INVALID_PARAMETER;
+
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->setup = *setup;
+    tracker->frame_rate = frame_rate;
+    tracker->bin_spacing_mm = bin_spacing_mm;
+    tracker->direction = X4SENSOR_DIRECTION_NONE;
+    return X4SENSOR_SUCCESS;
+}
+
+x4sensor_error_t
+x4sensor_tracker_update(x4sensor_tracker_t *tracker, const x4sensor_distance_cluster_t *cluster, uint32_t frame_counter,
+                        x4sensor_track_t *track)
+{
+    if (tracker == NULL || cluster == NULL || track == NULL)
+        return X4SENSOR_INVALID_PARAMETER;
+    if (tracker->frame_rate == 0)
+        return X4SENSOR_NOT_ALLOWED;
+
+    // Wraps with the frame counter
+    uint32_t elapsed = frame_counter - tracker->frame_counter;
+    bool expired = !tracker->valid || elapsed == 0 || elapsed > tracker->setup.coast_frames;
+
+    if (!cluster->detector_hit) {
+        // Coast on the last estimates until the track expires
+        if (tracker->valid && expired) {
+            tracker->valid = false;
+            tracker->velocity_q8 = 0;
+        }
+    } else if (expired) {
+        tracker->valid = true;
+        tracker->frame_counter = frame_counter;
+        tracker->distance_q8 = measure_distance_q8(tracker, cluster);
+        tracker->velocity_q8 = 0;
+    } else {
+        int32_t measured_q8 = measure_distance_q8(tracker, cluster);
+        int32_t predicted_q8 = tracker->distance_q8 +
+                               (int32_t)((int64_t)tracker->velocity_q8 * elapsed / tracker->frame_rate);
+        int64_t residual_q8 = (int64_t)measured_q8 - predicted_q8;
+
+        tracker->frame_counter = frame_counter;
+        tracker->distance_q8 = clamp_i32(predicted_q8 + residual_q8 * tracker->setup.alpha_q8 / Q8_ONE,
+                                         0, UINT16_MAX * Q8_ONE);
+        tracker->velocity_q8 = clamp_i32(tracker->velocity_q8 + residual_q8 * tracker->setup.beta_q8 *
+                                         tracker->frame_rate / ((int64_t)Q8_ONE * elapsed),
+                                         INT16_MIN * Q8_ONE, INT16_MAX * Q8_ONE);
+    }
+
+    x4sensor_direction_t direction = classify(tracker);
+    track->direction_changed = (direction != tracker->direction);
+    tracker->direction = direction;
+
+    track->valid = tracker->valid;
+    track->direction = direction;
+    track->distance_mm = (uint16_t)((tracker->distance_q8 + Q8_ONE / 2) / Q8_ONE);
+    track->velocity_mm_s = (int16_t)(tracker->velocity_q8 / Q8_ONE);
+    return X4SENSOR_SUCCESS;
+}
@@ -0,0 +1,139 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+//
+// Host tool for the X4Sensor background calibration. Runs the calibration of
+// the firmware on a recording of the empty scene and prints the resulting
+// detector thresholds.
+//
+#include "novelda_x4sensor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+// Defaults of the demo applications, see SENSOR_CALIBRATION_* in novelda_sensor.h
+#define DEFAULT_POWER_SHIFT 4
+#define DEFAULT_SIGMA_Q4 64
+#define DEFAULT_MARGIN_PERCENT 150
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] RECORDING\n"
+            "  -n BINS     range bins, FrameConfig_RangeBins (required)\n"
+            "  -d BINS     detector range bins, FrameConfig_RangeBins / range_decimation_DecimFactor (required)\n"
+            "  -f FRAMES   number of frames to use (default: all)\n"
+            "  -s SHIFT    power shift to threshold units (default %u)\n"
+            "  -k SIGMA    margin in standard deviations (default %.2f)\n"
+            "  -m PERCENT  threshold scale in percent (default %u)\n"
+            "  -x          print the thresholds as little endian hex\n",
+            name, DEFAULT_POWER_SHIFT, DEFAULT_SIGMA_Q4 / 16.0, DEFAULT_MARGIN_PERCENT);
+}
+
+int
+main(int argc, char **argv)
+{
+    x4sensor_calibration_setup_t setup;
+    x4sensor_calibration_t calibration;
+    x4sensor_detector_config_t detector;
+    unsigned long radar_bins = 0;
+    unsigned long detector_bins = 0;
+    unsigned long frames = 0;
+    bool hex = false;
+    int opt;
+
+    memset(&setup, 0, sizeof(setup));
+    setup.power_shift = DEFAULT_POWER_SHIFT;
+    setup.sigma_q4 = DEFAULT_SIGMA_Q4;
+    setup.margin_percent = DEFAULT_MARGIN_PERCENT;
+
+    while ((opt = getopt(argc, argv, "n:d:f:s:k:m:xh")) != -1) {
+        switch (opt) {
+        case 'n':
+            radar_bins = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            detector_bins = strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            frames = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            setup.power_shift = (uint8_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'k':
+            setup.sigma_q4 = (uint8_t)(strtod(optarg, NULL) * 16 + 0.5);
+            break;
+        case 'm':
+            setup.margin_percent = (uint16_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'x':
+            hex = true;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1 || radar_bins == 0 || radar_bins > UINT8_MAX || detector_bins == 0 ||
+        detector_bins > UINT8_MAX || frames > UINT16_MAX) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *file = fopen(argv[optind], "rb");
+    if (file == NULL) {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    // The frame count is only known after init, start with the maximum
+    setup.frames = UINT16_MAX;
+    if (x4sensor_calibration_init(&calibration, &setup, (uint8_t)radar_bins, (uint8_t)detector_bins) != X4SENSOR_SUCCESS) {
+        fprintf(stderr, "Invalid configuration\n");
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+    size_t frame_size = calibration.frame_size;
+    fseek(file, 0, SEEK_END);
+    unsigned long available = (unsigned long)(ftell(file) / frame_size);
+    fseek(file, 0, SEEK_SET);
+    if (frames == 0 || frames > available)
+        frames = (available > UINT16_MAX) ? UINT16_MAX : available;
+    setup.frames = (uint16_t)frames;
+    if (x4sensor_calibration_init(&calibration, &setup, (uint8_t)radar_bins, (uint8_t)detector_bins) != X4SENSOR_SUCCESS) {
+        fprintf(stderr, "At least 2 frames of %zu bytes are required\n", frame_size);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    uint8_t *frame = malloc(frame_size);
+    if (frame == NULL) {
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+    while (!x4sensor_calibration_is_complete(&calibration) && fread(frame, frame_size, 1, file) == 1)
+        x4sensor_calibration_add_frame(&calibration, frame, frame_size);
+    free(frame);
+    fclose(file);
+
+    if (x4sensor_calibration_get_thresholds(&calibration, &detector) != X4SENSOR_SUCCESS) {
+        fprintf(stderr, "Recording ended early\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u frames, %u detector bins, shift %u, %.2f sigma, %u%%\n", calibration.frames,
+           detector.threshold_count, setup.power_shift, setup.sigma_q4 / 16.0, setup.margin_percent);
+    for (uint8_t bin = 0; bin < detector.threshold_count; bin++) {
+        if (hex)
+            printf("%02x%02x", detector.thresholds[bin] & 0xff, detector.thresholds[bin] >> 8);
+        else
+            printf("%s%u", bin ? " " : "", detector.thresholds[bin]);
+    }
+    printf("\n");
+
+    return EXIT_SUCCESS;
+}
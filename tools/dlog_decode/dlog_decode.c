@@ -0,0 +1,239 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+//
+// Host decoder for the deferred binary log of the CC2340R5 application. Reads
+// a capture of the UART output, replaces every record line with the text it
+// stands for and passes all other lines through. The format strings and
+// constant string arguments are read from the application image (ELF).
+//
+#include "dlog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ELF_HEADER_SIZE 52
+#define ELF_SECTION_SIZE 40
+#define SHT_NOBITS 8
+#define SHF_ALLOC 0x2
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    uint32_t shoff;
+    uint16_t shnum;
+    uint16_t shentsize;
+} image_t;
+
+static uint32_t
+read32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t
+read16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static int
+image_load(image_t *image, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    long size;
+
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    image->data = malloc(size > 0 ? (size_t)size : 1);
+    image->size = (size_t)size;
+    if (image->data == NULL || size < ELF_HEADER_SIZE || fread(image->data, image->size, 1, file) != 1) {
+        fprintf(stderr, "%s: cannot read\n", path);
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+
+    // 32 bit little endian ELF, as built for the Cortex-M0+
+    if (memcmp(image->data, "\177ELF", 4) != 0 || image->data[4] != 1 || image->data[5] != 1) {
+        fprintf(stderr, "%s: not a 32 bit little endian ELF file\n", path);
+        return -1;
+    }
+    image->shoff = read32(&image->data[32]);
+    image->shentsize = read16(&image->data[46]);
+    image->shnum = read16(&image->data[48]);
+    if (image->shentsize < ELF_SECTION_SIZE ||
+        image->shoff + (uint64_t)image->shnum * image->shentsize > image->size) {
+        fprintf(stderr, "%s: invalid section headers\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Returns the string at a target address, or NULL if the address is not in
+// an initialized section of the image
+static const char *
+image_string(const image_t *image, uint32_t address)
+{
+    for (uint16_t i = 0; i < image->shnum; i++) {
+        const uint8_t *section = &image->data[image->shoff + (size_t)i * image->shentsize];
+        uint32_t type = read32(&section[4]);
+        uint32_t flags = read32(&section[8]);
+        uint32_t addr = read32(&section[12]);
+        uint32_t offset = read32(&section[16]);
+        uint32_t size = read32(&section[20]);
+
+        if (type == SHT_NOBITS || !(flags & SHF_ALLOC) || address < addr || address - addr >= size ||
+            (uint64_t)offset + size > image->size)
+            continue;
+        const char *string = (const char *)&image->data[offset + (address - addr)];
+        if (memchr(string, '\0', size - (address - addr)) == NULL)
+            return NULL;
+        return string;
+    }
+    return NULL;
+}
+
+// Formats one record like printf() on the target, with 32 bit arguments
+static void
+print_record(const image_t *image, uint32_t format, const uint32_t *args, uint32_t nargs)
+{
+    const char *fmt = image_string(image, format);
+    uint32_t arg = 0;
+
+    if (fmt == NULL) {
+        printf("<unknown format 0x%08x>", format);
+        return;
+    }
+    while (*fmt) {
+        char spec[32];
+        size_t len = 0;
+
+        if (*fmt != '%') {
+            putchar(*fmt++);
+            continue;
+        }
+        spec[len++] = *fmt++;
+        if (*fmt == '%') {
+            putchar(*fmt++);
+            continue;
+        }
+        while (*fmt && strchr("-+ #0123456789.", *fmt) && len < sizeof(spec) - 2)
+            spec[len++] = *fmt++;
+        // every argument was stored as one word, length modifiers do not matter
+        while (*fmt && strchr("hlzjt", *fmt))
+            fmt++;
+        if (*fmt == '\0')
+            break;
+        spec[len++] = *fmt;
+        spec[len] = '\0';
+        if (arg >= nargs) {
+            printf("<missing>");
+            fmt++;
+            continue;
+        }
+        switch (*fmt++) {
+        case 'd':
+        case 'i':
+        case 'c':
+            printf(spec, (int)(int32_t)args[arg++]);
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            printf(spec, (unsigned int)args[arg++]);
+            break;
+        case 's': {
+            const char *string = image_string(image, args[arg]);
+            if (string)
+                printf(spec, string);
+            else
+                printf("<0x%08x>", args[arg]);
+            arg++;
+            break;
+        }
+        case 'p':
+            printf("0x%08x", args[arg++]);
+            break;
+        default:
+            printf("<%s>", spec);
+            arg++;
+            break;
+        }
+    }
+}
+
+// Decodes a record line, returns 0 if the line is not a valid record
+static int
+decode_line(const image_t *image, const char *line, int *sequence)
+{
+    uint32_t words[DLOG_HEADER_WORDS + DLOG_MAX_ARGS];
+    uint32_t count = 0;
+    const char *p = strstr(line, DLOG_LINE_PREFIX " ");
+    char *end;
+
+    if (p == NULL)
+        return 0;
+    p += strlen(DLOG_LINE_PREFIX);
+    while (count < DLOG_HEADER_WORDS + DLOG_MAX_ARGS) {
+        unsigned long word = strtoul(p, &end, 16);
+        if (end == p)
+            break;
+        words[count++] = (uint32_t)word;
+        p = end;
+    }
+    if (count < DLOG_HEADER_WORDS || (words[0] >> 24) != DLOG_MAGIC ||
+        ((words[0] >> 16) & 0xff) != count - DLOG_HEADER_WORDS)
+        return 0;
+
+    int current = (int)(words[0] & 0xffff);
+    if (*sequence >= 0 && current != ((*sequence + 1) & 0xffff))
+        printf("*** %d records dropped\n", (current - *sequence - 1) & 0xffff);
+    *sequence = current;
+
+    printf("[%u.%06u] ", words[1] / 1000000, words[1] % 1000000);
+    print_record(image, words[2], &words[DLOG_HEADER_WORDS], count - DLOG_HEADER_WORDS);
+    printf("\n");
+    return 1;
+}
+
+int
+main(int argc, char **argv)
+{
+    image_t image;
+    FILE *capture = stdin;
+    char line[1024];
+    int sequence = -1;
+
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s IMAGE.out [CAPTURE]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (image_load(&image, argv[1]) != 0)
+        return EXIT_FAILURE;
+    if (argc == 3) {
+        capture = fopen(argv[2], "r");
+        if (capture == NULL) {
+            perror(argv[2]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    while (fgets(line, sizeof(line), capture)) {
+        if (!decode_line(&image, line, &sequence))
+            fputs(line, stdout);
+        fflush(stdout);
+    }
+
+    if (capture != stdin)
+        fclose(capture);
+    free(image.data);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,389 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+//
+// Host replay of the energy estimate of the demo applications (energy.h).
+// Reads a capture of the UART output, picks the activity and coefficient lines
+// out of it and estimates the average current of every operating mode with
+// x4sensor_estimate_energy(), the same model as the firmware. Options change
+// the frame rate, the intervals, the bus clock or a coefficient, or read every
+// frame as the event mode does while zones or tracking are set, to compare
+// configurations before measuring them on the bench.
+//
+#include "energy.h"
+#include "novelda_x4sensor.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#define ACTIVITY_WORDS (sizeof(x4sensor_energy_activity_t) / sizeof(uint32_t))
+#define COEFFICIENT_WORDS (sizeof(x4sensor_energy_coefficients_t) / sizeof(uint32_t))
+#define MAX_COEFFICIENT_OVERRIDES 16
+
+static const char *const mode_names[ENERGY_MODE_COUNT] = {
+    [ENERGY_MODE_IDLE] = "idle",
+    [ENERGY_MODE_SENSING] = "sensing",
+    [ENERGY_MODE_CONNECTED] = "connected",
+    [ENERGY_MODE_CONNECTED_SENSING] = "connected sensing",
+};
+
+#define COEFFICIENT(name) { #name, offsetof(x4sensor_energy_coefficients_t, name) }
+
+static const struct {
+    const char *name;
+    size_t offset;
+} coefficient_names[] = {
+    COEFFICIENT(idle_na),
+    COEFFICIENT(sensor_on_na),
+    COEFFICIENT(sensor_frame_nc),
+    COEFFICIENT(firmware_upload_nc),
+    COEFFICIENT(bus_active_na),
+    COEFFICIENT(transaction_nc),
+    COEFFICIENT(cpu_active_na),
+    COEFFICIENT(wakeup_nc),
+    COEFFICIENT(connection_event_nc),
+    COEFFICIENT(notification_nc),
+    COEFFICIENT(advertising_event_nc),
+};
+typedef char coefficient_names_complete[sizeof(coefficient_names) / sizeof(coefficient_names[0]) == COEFFICIENT_WORDS ? 1 : -1];
+
+typedef struct {
+    uint32_t frame_rate;            // 0 keeps the recorded value
+    int every_frame;                // a frame read per frame in the sensing modes
+    uint32_t connection_interval_us;
+    uint32_t advertising_interval_us;
+    uint32_t bus_frequency_hz;
+    unsigned coefficient_count;
+    size_t coefficient_offsets[MAX_COEFFICIENT_OVERRIDES];
+    uint32_t coefficient_values[MAX_COEFFICIENT_OVERRIDES];
+} overrides_t;
+
+typedef struct {
+    // activity being read, by mode
+    uint32_t words[ENERGY_MODE_COUNT][ACTIVITY_WORDS];
+    uint32_t parts[ENERGY_MODE_COUNT];
+    // coefficients of the capture
+    uint32_t coefficient_words[COEFFICIENT_WORDS];
+    uint32_t coefficient_parts;
+    // complete activities
+    x4sensor_energy_activity_t *activities;
+    uint32_t *modes;
+    size_t count;
+    size_t capacity;
+} replay_t;
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] [CAPTURE]\n"
+            "  -r FPS        frame rate of the sensor (default: recorded)\n"
+            "  -c MS         connection interval (default: recorded)\n"
+            "  -a MS         advertising interval (default: recorded)\n"
+            "  -f HZ         bus clock (default: recorded)\n"
+            "  -e            read every frame, as with zones or tracking set\n"
+            "  -k NAME=VALUE coefficient of the board, see x4sensor_energy_coefficients_t\n"
+            "  -m MAH        battery capacity, prints the battery life\n",
+            name);
+}
+
+static int
+add_activity(replay_t *replay, uint32_t mode, const uint32_t *words)
+{
+    if (replay->count == replay->capacity) {
+        size_t capacity = replay->capacity ? 2 * replay->capacity : 64;
+        x4sensor_energy_activity_t *activities = realloc(replay->activities, capacity * sizeof(*activities));
+        uint32_t *modes = realloc(replay->modes, capacity * sizeof(*modes));
+
+        if (activities)
+            replay->activities = activities;
+        if (modes)
+            replay->modes = modes;
+        if (activities == NULL || modes == NULL)
+            return 0;
+        replay->capacity = capacity;
+    }
+    memcpy(&replay->activities[replay->count], words, sizeof(x4sensor_energy_activity_t));
+    replay->modes[replay->count] = mode;
+    replay->count++;
+    return 1;
+}
+
+// Reads the five words after the tag of a line, returns 0 if they are missing
+static int
+parse_words(const char *p, uint32_t *tag, uint32_t words[ENERGY_LINE_WORDS])
+{
+    char *end;
+
+    *tag = (uint32_t)strtoul(p, &end, 16);
+    if (end == p)
+        return 0;
+    for (int i = 0; i < ENERGY_LINE_WORDS; i++) {
+        p = end;
+        words[i] = (uint32_t)strtoul(p, &end, 16);
+        if (end == p)
+            return 0;
+    }
+    return 1;
+}
+
+// Reads a line of the capture, returns 0 if memory runs out
+static int
+replay_line(replay_t *replay, const char *line)
+{
+    const char *p;
+    uint32_t tag;
+    uint32_t words[ENERGY_LINE_WORDS];
+
+    if ((p = strstr(line, ENERGY_COEFFICIENTS_PREFIX " ")) != NULL) {
+        if (!parse_words(p + strlen(ENERGY_COEFFICIENTS_PREFIX), &tag, words))
+            return 1;
+        for (uint32_t i = 0; i < ENERGY_LINE_WORDS; i++)
+            if (tag * ENERGY_LINE_WORDS + i < COEFFICIENT_WORDS)
+                replay->coefficient_words[tag * ENERGY_LINE_WORDS + i] = words[i];
+        if (tag * ENERGY_LINE_WORDS < COEFFICIENT_WORDS)
+            replay->coefficient_parts |= 1u << tag;
+    } else if ((p = strstr(line, ENERGY_LINE_PREFIX " ")) != NULL) {
+        uint32_t mode;
+        uint32_t part;
+        uint32_t all = (1u << ((ACTIVITY_WORDS + ENERGY_LINE_WORDS - 1) / ENERGY_LINE_WORDS)) - 1;
+
+        if (!parse_words(p + strlen(ENERGY_LINE_PREFIX), &tag, words))
+            return 1;
+        mode = tag >> 8;
+        part = tag & 0xff;
+        if (mode >= ENERGY_MODE_COUNT || part * ENERGY_LINE_WORDS >= ACTIVITY_WORDS)
+            return 1;
+        // a window starts with part 0, a lost line drops the window of the mode
+        if (part == 0)
+            replay->parts[mode] = 0;
+        for (uint32_t i = 0; i < ENERGY_LINE_WORDS; i++)
+            if (part * ENERGY_LINE_WORDS + i < ACTIVITY_WORDS)
+                replay->words[mode][part * ENERGY_LINE_WORDS + i] = words[i];
+        replay->parts[mode] |= 1u << part;
+        if (replay->parts[mode] == all) {
+            replay->parts[mode] = 0;
+            return add_activity(replay, mode, replay->words[mode]);
+        }
+    }
+    return 1;
+}
+
+// Applies the options to a recorded activity
+static void
+override_activity(const overrides_t *overrides, x4sensor_energy_activity_t *activity)
+{
+    int events_changed = 0;
+
+    if (overrides->frame_rate && activity->sensor_ms && activity->frame_rate &&
+        overrides->frame_rate != activity->frame_rate) {
+        // the bus activity and the CPU time of a sensing mode follow the frames
+        double ratio = (double)overrides->frame_rate / activity->frame_rate;
+
+        activity->transactions = (uint32_t)(activity->transactions * ratio + 0.5);
+        activity->bytes = (uint32_t)(activity->bytes * ratio + 0.5);
+        activity->data_reads = (uint32_t)(activity->data_reads * ratio + 0.5);
+        activity->cpu_ms = (uint32_t)(activity->cpu_ms * ratio + 0.5);
+        activity->frame_rate = overrides->frame_rate;
+        events_changed = 1;
+    }
+    if (overrides->every_frame && activity->sensor_ms && activity->frame_rate) {
+        uint32_t frames = (uint32_t)((uint64_t)activity->sensor_ms * activity->frame_rate / 1000);
+
+        // the bus activity and the CPU time follow the reads, without reads there is nothing to scale
+        if (activity->data_reads && frames > activity->data_reads) {
+            double ratio = (double)frames / activity->data_reads;
+
+            activity->transactions = (uint32_t)(activity->transactions * ratio + 0.5);
+            activity->bytes = (uint32_t)(activity->bytes * ratio + 0.5);
+            activity->cpu_ms = (uint32_t)(activity->cpu_ms * ratio + 0.5);
+            activity->data_reads = frames;
+            events_changed = 1;
+        }
+    }
+    if (overrides->connection_interval_us && activity->connected_ms) {
+        activity->connection_interval_us = overrides->connection_interval_us;
+        events_changed = 1;
+    }
+    if (overrides->advertising_interval_us && activity->advertising_ms) {
+        activity->advertising_interval_us = overrides->advertising_interval_us;
+        events_changed = 1;
+    }
+    if (overrides->bus_frequency_hz)
+        activity->bus_frequency_hz = overrides->bus_frequency_hz;
+    // the recorded wake-ups no longer match, derive them from the events
+    if (events_changed)
+        activity->wakeups = 0;
+}
+
+static int
+parse_coefficient(overrides_t *overrides, const char *arg)
+{
+    const char *value = strchr(arg, '=');
+
+    if (value == NULL || overrides->coefficient_count == MAX_COEFFICIENT_OVERRIDES)
+        return 0;
+    for (size_t i = 0; i < sizeof(coefficient_names) / sizeof(coefficient_names[0]); i++) {
+        if (strlen(coefficient_names[i].name) == (size_t)(value - arg) &&
+            strncmp(coefficient_names[i].name, arg, value - arg) == 0) {
+            overrides->coefficient_offsets[overrides->coefficient_count] = coefficient_names[i].offset;
+            overrides->coefficient_values[overrides->coefficient_count] = (uint32_t)strtoul(value + 1, NULL, 0);
+            overrides->coefficient_count++;
+            return 1;
+        }
+    }
+    fprintf(stderr, "Unknown coefficient %.*s\n", (int)(value - arg), arg);
+    return 0;
+}
+
+static void
+print_current(const char *name, uint64_t charge_pc, uint64_t duration_ms)
+{
+    uint64_t current_na = duration_ms ? charge_pc / duration_ms : 0;
+
+    printf("%s%llu.%03llu uA", name, (unsigned long long)(current_na / 1000),
+           (unsigned long long)(current_na % 1000));
+}
+
+int
+main(int argc, char **argv)
+{
+    replay_t replay;
+    overrides_t overrides;
+    x4sensor_energy_coefficients_t coefficients;
+    FILE *capture = stdin;
+    char line[1024];
+    double capacity_mah = 0;
+    // charges in pC by mode and part: total, idle, sensor, bus, CPU, radio
+    uint64_t charge_pc[ENERGY_MODE_COUNT][6];
+    uint64_t duration_ms[ENERGY_MODE_COUNT];
+    // frame reads and frames of the sensor by mode
+    uint64_t reads[ENERGY_MODE_COUNT];
+    uint64_t frames[ENERGY_MODE_COUNT];
+    uint64_t total_pc = 0;
+    uint64_t total_ms = 0;
+    int opt;
+
+    memset(&replay, 0, sizeof(replay));
+    memset(&overrides, 0, sizeof(overrides));
+    while ((opt = getopt(argc, argv, "r:c:a:f:ek:m:h")) != -1) {
+        switch (opt) {
+        case 'r':
+            overrides.frame_rate = strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            overrides.connection_interval_us = (uint32_t)(strtod(optarg, NULL) * 1000 + 0.5);
+            break;
+        case 'a':
+            overrides.advertising_interval_us = (uint32_t)(strtod(optarg, NULL) * 1000 + 0.5);
+            break;
+        case 'f':
+            overrides.bus_frequency_hz = strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            overrides.every_frame = 1;
+            break;
+        case 'k':
+            if (!parse_coefficient(&overrides, optarg)) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'm':
+            capacity_mah = strtod(optarg, NULL);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (argc - optind > 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc - optind == 1) {
+        capture = fopen(argv[optind], "r");
+        if (capture == NULL) {
+            perror(argv[optind]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    while (fgets(line, sizeof(line), capture)) {
+        if (!replay_line(&replay, line)) {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
+    if (capture != stdin)
+        fclose(capture);
+    if (replay.count == 0 || replay.coefficient_parts != (1u << ((COEFFICIENT_WORDS + ENERGY_LINE_WORDS - 1) / ENERGY_LINE_WORDS)) - 1) {
+        fprintf(stderr, "No energy estimate in the capture, build the firmware with ENERGY_ESTIMATE\n");
+        return EXIT_FAILURE;
+    }
+
+    memcpy(&coefficients, replay.coefficient_words, sizeof(coefficients));
+    for (unsigned i = 0; i < overrides.coefficient_count; i++)
+        memcpy((uint8_t *)&coefficients + overrides.coefficient_offsets[i], &overrides.coefficient_values[i],
+               sizeof(uint32_t));
+
+    memset(charge_pc, 0, sizeof(charge_pc));
+    memset(duration_ms, 0, sizeof(duration_ms));
+    memset(reads, 0, sizeof(reads));
+    memset(frames, 0, sizeof(frames));
+    for (size_t i = 0; i < replay.count; i++) {
+        x4sensor_energy_activity_t *activity = &replay.activities[i];
+        x4sensor_energy_estimate_t estimate;
+        uint32_t mode = replay.modes[i];
+
+        override_activity(&overrides, activity);
+        if (x4sensor_estimate_energy(&coefficients, activity, &estimate) != X4SENSOR_SUCCESS)
+            continue;
+        charge_pc[mode][0] += (uint64_t)estimate.total_na * activity->duration_ms;
+        charge_pc[mode][1] += (uint64_t)estimate.idle_na * activity->duration_ms;
+        charge_pc[mode][2] += (uint64_t)estimate.sensor_na * activity->duration_ms;
+        charge_pc[mode][3] += (uint64_t)estimate.bus_na * activity->duration_ms;
+        charge_pc[mode][4] += (uint64_t)estimate.cpu_na * activity->duration_ms;
+        charge_pc[mode][5] += (uint64_t)estimate.radio_na * activity->duration_ms;
+        duration_ms[mode] += activity->duration_ms;
+        reads[mode] += activity->data_reads;
+        frames[mode] += (uint64_t)activity->sensor_ms * activity->frame_rate / 1000;
+        total_pc += (uint64_t)estimate.total_na * activity->duration_ms;
+        total_ms += activity->duration_ms;
+    }
+    if (total_ms == 0) {
+        fprintf(stderr, "No valid activity in the capture\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%zu windows, %llu s\n", replay.count, (unsigned long long)(total_ms / 1000));
+    for (int mode = 0; mode < ENERGY_MODE_COUNT; mode++) {
+        if (duration_ms[mode] == 0)
+            continue;
+        printf("%-18s", mode_names[mode]);
+        print_current("", charge_pc[mode][0], duration_ms[mode]);
+        printf(", %llu.%llu%% of the time\n", (unsigned long long)(duration_ms[mode] * 100 / total_ms),
+               (unsigned long long)(duration_ms[mode] * 1000 / total_ms % 10));
+        print_current("  idle ", charge_pc[mode][1], duration_ms[mode]);
+        print_current(", sensor ", charge_pc[mode][2], duration_ms[mode]);
+        print_current(", bus ", charge_pc[mode][3], duration_ms[mode]);
+        print_current(", CPU ", charge_pc[mode][4], duration_ms[mode]);
+        print_current(", radio ", charge_pc[mode][5], duration_ms[mode]);
+        printf("\n");
+        if (frames[mode])
+            printf("  %llu frame reads in %llu frames\n", (unsigned long long)reads[mode],
+                   (unsigned long long)frames[mode]);
+    }
+    print_current("Average: ", total_pc, total_ms);
+    printf("\n");
+    if (capacity_mah > 0)
+        printf("Battery life with %g mAh: %.0f days\n", capacity_mah,
+               capacity_mah * 1e6 / ((double)total_pc / total_ms) / 24);
+
+    free(replay.activities);
+    free(replay.modes);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+//
+// Host tool for the X4Sensor recording budget. Prints the per-frame bus and
+// host time of recording mode for an interface, range bin count and frame
+// rate, and the highest frame rate the host keeps up with.
+//
+#include "novelda_x4sensor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#define DEFAULT_I2C_FREQUENCY 400000
+#define DEFAULT_SPI_FREQUENCY 8000000
+#define DEFAULT_WAIT_RESOLUTION_US 1000
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -i i2c|spi  host interface (default i2c)\n"
+            "  -f HZ       bus clock (default 400000 for I2C, 8000000 for SPI)\n"
+            "  -n BINS     range bins, FrameConfig_RangeBins (required)\n"
+            "  -r FPS      frame rate, ChipX4_FPS (default: only print the maximum)\n"
+            "  -w US       resolution of chipinterface_wait_us() (default 1000)\n"
+            "  -o US       driver overhead per bus transaction (default 0)\n"
+            "  -c US       host processing time per frame (default 0)\n"
+            "  -p          pipelined reads with x4sensor_start_sensor_data_read()\n",
+            name);
+}
+
+static uint8_t
+max_frame_rate(x4sensor_recording_setup_t setup)
+{
+    x4sensor_recording_budget_t budget;
+    uint8_t max_fps = 0;
+
+    for (unsigned fps = 1; fps <= UINT8_MAX; fps++) {
+        setup.frame_rate = (uint8_t)fps;
+        if (x4sensor_plan_recording(&setup, &budget) != X4SENSOR_SUCCESS)
+            break;
+        if (budget.min_report_interval > 1)
+            break;
+        max_fps = (uint8_t)fps;
+    }
+    return max_fps;
+}
+
+int
+main(int argc, char **argv)
+{
+    x4sensor_recording_setup_t setup;
+    x4sensor_recording_budget_t budget;
+    unsigned long bins = 0;
+    unsigned long fps = 0;
+    int opt;
+
+    memset(&setup, 0, sizeof(setup));
+    setup.bus = X4SENSOR_BUS_I2C;
+    setup.host.wait_resolution_us = DEFAULT_WAIT_RESOLUTION_US;
+
+    while ((opt = getopt(argc, argv, "i:f:n:r:w:o:c:ph")) != -1) {
+        switch (opt) {
+        case 'i':
+            if (strcmp(optarg, "i2c") == 0) {
+                setup.bus = X4SENSOR_BUS_I2C;
+            } else if (strcmp(optarg, "spi") == 0) {
+                setup.bus = X4SENSOR_BUS_SPI;
+            } else {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'f':
+            setup.bus_frequency_hz = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            bins = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            fps = strtoul(optarg, NULL, 0);
+            break;
+        case 'w':
+            setup.host.wait_resolution_us = strtoul(optarg, NULL, 0);
+            break;
+        case 'o':
+            setup.host.transaction_overhead_us = strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            setup.host.cpu_time_per_frame_us = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            setup.host.pipelined = true;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (bins == 0 || bins > UINT8_MAX || fps > UINT8_MAX) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (setup.bus_frequency_hz == 0)
+        setup.bus_frequency_hz = (setup.bus == X4SENSOR_BUS_I2C) ? DEFAULT_I2C_FREQUENCY : DEFAULT_SPI_FREQUENCY;
+    setup.range_bins = (uint8_t)bins;
+    setup.frame_rate = fps ? (uint8_t)fps : 1;
+
+    if (x4sensor_plan_recording(&setup, &budget) != X4SENSOR_SUCCESS) {
+        fprintf(stderr, "Invalid configuration\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%s at %u Hz, %u range bins\n", (setup.bus == X4SENSOR_BUS_I2C) ? "I2C" : "SPI",
+           setup.bus_frequency_hz, setup.range_bins);
+    printf("  transactions:   %u\n", budget.transactions);
+    printf("  bytes:          %u\n", budget.bytes);
+    printf("  bus time:       %u us\n", budget.bus_time_us);
+    printf("  command waits:  %u us\n", budget.wait_time_us);
+    printf("  overhead:       %u us\n", budget.overhead_time_us);
+    printf("  processing:     %u us%s\n", budget.cpu_time_us, setup.host.pipelined ? " (pipelined)" : "");
+    printf("  frame time:     %u us\n", budget.frame_time_us);
+    if (fps) {
+        printf("At %u fps:\n", setup.frame_rate);
+        printf("  frame period:   %u us\n", budget.frame_period_us);
+        printf("  load:           %u.%u%%\n", budget.load_permille / 10, budget.load_permille % 10);
+        if (budget.min_report_interval > 1)
+            printf("  budget exceeded, report interval of %u frames required\n", budget.min_report_interval);
+        else
+            printf("  within budget\n");
+    }
+    printf("Maximum frame rate: %u fps\n", max_frame_rate(setup));
+
+    return (budget.min_report_interval > 1) ? 2 : EXIT_SUCCESS;
+}
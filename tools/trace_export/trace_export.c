@@ -0,0 +1,243 @@
+/*
+* Copyright Novelda AS 2024.
+*/
+//
+// Host converter from event trace dumps of the demo applications (trace.h) to
+// the Chrome trace event format. Reads a capture of the UART output, picks the
+// record lines out of it and writes one JSON trace with a row per source: the
+// sensor interrupt, the bus transactions of the sensor driver, the semaphores
+// of the chip interface, the timers and events of the proximity module and the
+// notifications of the BLE service.
+//
+#include "trace.h"
+#include "proximity.h"
+#include "novelda_x4sensor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    ROW_IRQ = 1,
+    ROW_BUS,
+    ROW_SEMAPHORE,
+    ROW_TIMER,
+    ROW_EVENT,
+    ROW_BLE,
+    ROW_COUNT
+};
+
+static const char *const row_names[ROW_COUNT] = {
+    NULL, "Sensor interrupt", "Sensor bus", "Semaphores", "Timers", "Proximity events", "BLE notifications",
+};
+
+static const char *const op_names[] = {
+    "upload_firmware", "set_run_mode", "get_register", "set_register",
+    "write_config", "read_recording_data", "start_read_recording_data", "finish_read_recording_data",
+    "destroy_chipinterface", "start_lposc_measurement", "clear_interrupt", "discover_sensor",
+};
+typedef char op_names_complete[sizeof(op_names) / sizeof(op_names[0]) == X4SENSOR_TRACE_OP_COUNT ? 1 : -1];
+
+static const char *const event_names[] = {
+    [PROXIMITY_EVENT_PRESENCE] = "presence",
+    [PROXIMITY_EVENT_ZONES] = "zones",
+    [PROXIMITY_EVENT_MOTION] = "motion",
+    [PROXIMITY_EVENT_SENSOR] = "sensor",
+    [PROXIMITY_EVENT_CONFIG] = "config",
+    [PROXIMITY_EVENT_SETTINGS] = "settings",
+    [PROXIMITY_EVENT_CONNECTION] = "connection",
+    [PROXIMITY_EVENT_SCHEDULE] = "schedule",
+    [PROXIMITY_EVENT_TRACE_DUMP] = "trace dump",
+};
+
+static const char *const semaphore_names[] = {
+    [TRACE_SEM_IRQ] = "irq",
+    [TRACE_SEM_SPI] = "spi",
+};
+
+static const char *const timer_names[] = {
+    [TRACE_TIMER_CONFIG] = "config",
+    [TRACE_TIMER_SETTINGS] = "settings",
+    [TRACE_TIMER_SCHEDULE] = "schedule",
+};
+
+static const char *const characteristic_names[] = {
+    [TRACE_CHAR_DETECTION] = "detection",
+    [TRACE_CHAR_ZONES] = "zones",
+    [TRACE_CHAR_MOTION] = "motion",
+};
+
+#define NAME(table, index) \
+    ((index) < sizeof(table) / sizeof((table)[0]) && (table)[index] ? (table)[index] : "unknown")
+
+typedef struct {
+    int first;                  // no event written yet
+    int have_time;
+    uint32_t last_us;           // last device timestamp
+    uint64_t base_us;           // wraps of the device timestamp
+    int open[ROW_COUNT];        // slice begun and not ended, by row
+    uint32_t records;
+    uint32_t lost;
+} exporter_t;
+
+// Extends the 32 bit device time, which wraps after 71 minutes
+static uint64_t
+unwrap(exporter_t *exporter, uint32_t timestamp_us)
+{
+    if (exporter->have_time && timestamp_us < exporter->last_us &&
+        exporter->last_us - timestamp_us > UINT32_MAX / 2)
+        exporter->base_us += (uint64_t)UINT32_MAX + 1;
+    exporter->have_time = 1;
+    exporter->last_us = timestamp_us;
+    return exporter->base_us + timestamp_us;
+}
+
+static void
+emit(exporter_t *exporter, char phase, int row, uint64_t ts, const char *name, const char *arg_name, int arg)
+{
+    printf("%s\n  {\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":1,\"tid\":%d",
+           exporter->first ? "" : ",", name, phase, (unsigned long long)ts, row);
+    if (phase == 'i')
+        printf(",\"s\":\"t\"");
+    if (arg_name)
+        printf(",\"args\":{\"%s\":%d}", arg_name, arg);
+    printf("}");
+    exporter->first = 0;
+}
+
+static void
+begin(exporter_t *exporter, int row, uint64_t ts, const char *name, const char *arg_name, int arg)
+{
+    // slices of a row do not nest, a missing end is lost in the ring
+    if (exporter->open[row])
+        emit(exporter, 'E', row, ts, "", NULL, 0);
+    emit(exporter, 'B', row, ts, name, arg_name, arg);
+    exporter->open[row] = 1;
+}
+
+static void
+end(exporter_t *exporter, int row, uint64_t ts, const char *arg_name, int arg)
+{
+    // the begin of the first slice of a dump may have been overwritten
+    if (!exporter->open[row])
+        return;
+    emit(exporter, 'E', row, ts, "", arg_name, arg);
+    exporter->open[row] = 0;
+}
+
+static void
+export_record(exporter_t *exporter, uint32_t timestamp_us, uint32_t word)
+{
+    uint8_t event = (uint8_t)word;
+    uint8_t arg = (uint8_t)(word >> 8);
+    uint16_t value = (uint16_t)(word >> 16);
+    uint64_t ts = unwrap(exporter, timestamp_us);
+    char name[64];
+
+    exporter->records++;
+    switch (event) {
+    case TRACE_IRQ:
+        emit(exporter, 'i', ROW_IRQ, ts, "irq", NULL, 0);
+        break;
+    case TRACE_BUS_BEGIN:
+        begin(exporter, ROW_BUS, ts, NAME(op_names, arg), "value", value);
+        break;
+    case TRACE_BUS_END:
+        end(exporter, ROW_BUS, ts, "status", (int16_t)value);
+        break;
+    case TRACE_SEM_GIVE:
+        snprintf(name, sizeof(name), "give %s", NAME(semaphore_names, arg));
+        emit(exporter, 'i', ROW_SEMAPHORE, ts, name, NULL, 0);
+        break;
+    case TRACE_SEM_TAKE:
+        snprintf(name, sizeof(name), "take %s", NAME(semaphore_names, arg));
+        emit(exporter, 'i', ROW_SEMAPHORE, ts, name, "taken", value);
+        break;
+    case TRACE_TIMER:
+        emit(exporter, 'i', ROW_TIMER, ts, NAME(timer_names, arg), NULL, 0);
+        break;
+    case TRACE_EVENT_BEGIN:
+        begin(exporter, ROW_EVENT, ts, NAME(event_names, arg), NULL, 0);
+        break;
+    case TRACE_EVENT_END:
+        end(exporter, ROW_EVENT, ts, NULL, 0);
+        break;
+    case TRACE_NOTIFY:
+        emit(exporter, 'i', ROW_BLE, ts, NAME(characteristic_names, arg), "status", value);
+        break;
+    case TRACE_DUMP_END:
+        // the next dump starts with the records after this one
+        for (int row = 1; row < ROW_COUNT; row++)
+            end(exporter, row, ts, NULL, 0);
+        exporter->records--;
+        exporter->lost += value;
+        break;
+    default:
+        fprintf(stderr, "unknown trace event %u\n", event);
+        exporter->records--;
+        break;
+    }
+}
+
+// Exports a record line, returns 0 if the line is not a valid record
+static int
+export_line(exporter_t *exporter, const char *line)
+{
+    const char *p = strstr(line, TRACE_LINE_PREFIX " ");
+    unsigned long timestamp_us;
+    unsigned long word;
+    char *end;
+
+    if (p == NULL)
+        return 0;
+    p += strlen(TRACE_LINE_PREFIX);
+    timestamp_us = strtoul(p, &end, 16);
+    if (end == p)
+        return 0;
+    p = end;
+    word = strtoul(p, &end, 16);
+    if (end == p)
+        return 0;
+    export_record(exporter, (uint32_t)timestamp_us, (uint32_t)word);
+    return 1;
+}
+
+int
+main(int argc, char **argv)
+{
+    exporter_t exporter;
+    FILE *capture = stdin;
+    char line[1024];
+
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [CAPTURE] > trace.json\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc == 2) {
+        capture = fopen(argv[1], "r");
+        if (capture == NULL) {
+            perror(argv[1]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    memset(&exporter, 0, sizeof(exporter));
+    exporter.first = 1;
+    printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (int row = 1; row < ROW_COUNT; row++) {
+        printf("%s\n  {\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+               exporter.first ? "" : ",", row, row_names[row]);
+        exporter.first = 0;
+    }
+    while (fgets(line, sizeof(line), capture))
+        export_line(&exporter, line);
+    if (exporter.have_time)
+        for (int row = 1; row < ROW_COUNT; row++)
+            end(&exporter, row, exporter.base_us + exporter.last_us, NULL, 0);
+    printf("\n]}\n");
+
+    fprintf(stderr, "%u records exported, %u lost on the device\n", exporter.records, exporter.lost);
+    if (capture != stdin)
+        fclose(capture);
+    return exporter.records ? EXIT_SUCCESS : EXIT_FAILURE;
+}